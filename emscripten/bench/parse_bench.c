@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+//   parse_bench.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//   Date:     10/18/2026
+//
+//   Benchmark of input parsing on a large [TIMESERIES] section. It writes
+//   a project whose time series hold a given number of values, times how
+//   long swmm_open takes to read it and then times the conversion of the
+//   same dates, times and numbers on their own: datetime_strToDate and
+//   datetime_strToTime against the sscanf calls they used to rely on, and
+//   getDouble against strtod.
+//
+//   Build it against the engine sources (all of ../src except main.c):
+//     gcc -O1 -I../src parse_bench.c $(ls ../src/*.c | grep -v /main.c) -lm
+//
+//   Usage: a.out [nSeries] [nValues]
+//   where nSeries = number of time series (default 10) and nValues =
+//   number of values in each (default 100000).
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "headers.h"
+#include "swmm5.h"
+
+static const char* INPFILE = "parse_bench.inp";
+static const char* RPTFILE = "parse_bench.rpt";
+
+static int    writeProject(int nSeries, int nValues);
+static double getValue(int i);
+static void   getEntryTime(int i, char* date, char* time);
+static char** makeStrings(int n, int type);
+static void   freeStrings(int n, char** s);
+static double getClock(void);
+
+//=============================================================================
+
+int  main(int argc, char *argv[])
+//
+//  Input:   argc = number of command line arguments
+//           argv = array of command line arguments
+//  Output:  returns error status
+//  Purpose: times parsing of a project with large time series.
+//
+{
+    int     i, n, err;
+    int     nSeries = 10;
+    int     nValues = 100000;
+    int     y, m, d, sec;
+    char    c1, c2;
+    char**  tokens;
+    char**  dates;
+    char**  times;
+    double  x, sum1 = 0.0, sum2 = 0.0;
+    DateTime dt, sum3 = 0.0, sum4 = 0.0;
+    double  t0, tOpen, tGetDouble, tStrtod, tDateTime, tSscanf;
+
+    if ( argc > 1 ) nSeries = atoi(argv[1]);
+    if ( argc > 2 ) nValues = atoi(argv[2]);
+    if ( nSeries <= 0 || nValues <= 0 )
+    {
+        printf("\nUsage: %s [nSeries] [nValues]\n", argv[0]);
+        return 1;
+    }
+
+    // --- time the reading of the whole project
+    if ( !writeProject(nSeries, nValues) )
+    {
+        printf("\nCould not write %s\n", INPFILE);
+        return 1;
+    }
+    t0 = getClock();
+    err = swmm_open((char *)INPFILE, (char *)RPTFILE, "");
+    tOpen = getClock() - t0;
+    swmm_close();
+    if ( err )
+    {
+        printf("\nError %d in %s (see %s)\n", err, INPFILE, RPTFILE);
+        return 1;
+    }
+
+    // --- time the conversion of the time series entries on their own
+    n = nValues;
+    tokens = makeStrings(n, 0);
+    dates = makeStrings(n, 1);
+    times = makeStrings(n, 2);
+    if ( tokens == NULL || dates == NULL || times == NULL ) return 1;
+    t0 = getClock();
+    for (i = 0; i < n; i++)
+    {
+        if ( datetime_strToDate(dates[i], &dt) ) sum3 += dt;
+        if ( datetime_strToTime(times[i], &dt) ) sum3 += dt;
+    }
+    tDateTime = getClock() - t0;
+    t0 = getClock();
+    for (i = 0; i < n; i++)
+    {
+        if ( sscanf(dates[i], "%d%c%d%c%d", &m, &c1, &d, &c2, &y) == 5 )
+            sum4 += datetime_encodeDate(y, m, d);
+        sec = 0;
+        if ( sscanf(times[i], "%d:%d:%d", &y, &m, &sec) >= 2 )
+            sum4 += datetime_encodeTime(y, m, sec);
+    }
+    tSscanf = getClock() - t0;
+    t0 = getClock();
+    for (i = 0; i < n; i++)
+    {
+        if ( getDouble(tokens[i], &x) ) sum1 += x;
+    }
+    tGetDouble = getClock() - t0;
+    t0 = getClock();
+    for (i = 0; i < n; i++) sum2 += strtod(tokens[i], NULL);
+    tStrtod = getClock() - t0;
+
+    printf("\n  Time series ........ %d x %d values", nSeries, nValues);
+    printf("\n  swmm_open .......... %.3f sec", tOpen);
+    printf("\n  date & time ........ %.1f ns/value", 1.0e9 * tDateTime / n);
+    printf("\n  sscanf ............. %.1f ns/value", 1.0e9 * tSscanf / n);
+    printf("\n  getDouble .......... %.1f ns/value", 1.0e9 * tGetDouble / n);
+    printf("\n  strtod ............. %.1f ns/value", 1.0e9 * tStrtod / n);
+    if ( sum3 != sum4 ) printf("\n  WARNING: date & time and sscanf differ");
+    if ( sum1 != sum2 ) printf("\n  WARNING: getDouble and strtod differ");
+    printf("\n");
+
+    freeStrings(n, tokens);
+    freeStrings(n, dates);
+    freeStrings(n, times);
+    remove(INPFILE);
+    remove(RPTFILE);
+    return 0;
+}
+
+//=============================================================================
+
+int writeProject(int nSeries, int nValues)
+//
+//  Input:   nSeries = number of time series
+//           nValues = number of values in each time series
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: writes a project consisting of a single outfall and a set of
+//           5-minute time series.
+//
+{
+    int   i, j;
+    char  date[16], time[16];
+    FILE* f = fopen(INPFILE, "wt");
+
+    if ( f == NULL ) return FALSE;
+    fprintf(f, "[OPTIONS]\nSTART_DATE 01/01/2020\nEND_DATE 01/02/2020\n");
+    fprintf(f, "\n[OUTFALLS]\nOut1  0  FREE\n");
+    fprintf(f, "\n[TIMESERIES]\n");
+    fprintf(f, ";;Name  Date        Time   Value\n");
+    for (j = 0; j < nSeries; j++)
+    {
+        for (i = 0; i < nValues; i++)
+        {
+            getEntryTime(i, date, time);
+            fprintf(f, "TS%-4d  %s  %s  %.4f\n", j, date, time,
+                getValue(i + j));
+        }
+    }
+    fclose(f);
+    return TRUE;
+}
+
+//=============================================================================
+
+double getValue(int i)
+//
+//  Input:   i = index of a time series value
+//  Output:  returns a made up time series value
+//  Purpose: generates time series values with a varying number of digits.
+//
+{
+    return (double)((i * 7919L) % 100000) / (1 + i % 97);
+}
+
+//=============================================================================
+
+void getEntryTime(int i, char* date, char* time)
+//
+//  Input:   i = index of a time series value
+//  Output:  date = date of the value (month/day/year)
+//           time = time of day of the value (hours:minutes)
+//  Purpose: generates the date and time of 5-minute time series values.
+//
+{
+    long minutes = 5L * i;
+
+    sprintf(date, "%02ld/%02ld/%04ld", 1 + minutes / 1440 / 28 % 12,
+        1 + minutes / 1440 % 28, 2020 + minutes / 1440 / 336);
+    sprintf(time, "%02ld:%02ld", minutes / 60 % 24, minutes % 60);
+}
+
+//=============================================================================
+
+char** makeStrings(int n, int type)
+//
+//  Input:   n = number of strings
+//           type = 0 for values, 1 for dates or 2 for times
+//  Output:  returns an array of strings (NULL if out of memory)
+//  Purpose: makes the strings of a time series' values, dates or times.
+//
+{
+    int    i;
+    char   s[32], date[16], time[16];
+    char** strings = (char **) calloc(n, sizeof(char *));
+
+    if ( strings == NULL ) return NULL;
+    for (i = 0; i < n; i++)
+    {
+        getEntryTime(i, date, time);
+        if ( type == 0 ) sprintf(s, "%.4f", getValue(i));
+        else strcpy(s, type == 1 ? date : time);
+        strings[i] = (char *) malloc(strlen(s) + 1);
+        if ( strings[i] == NULL ) return NULL;
+        strcpy(strings[i], s);
+    }
+    return strings;
+}
+
+//=============================================================================
+
+void freeStrings(int n, char** s)
+//
+//  Input:   n = number of strings
+//           s = array of strings
+//  Output:  none
+//  Purpose: frees an array made by makeStrings.
+//
+{
+    int i;
+    for (i = 0; i < n; i++) free(s[i]);
+    free(s);
+}
+
+//=============================================================================
+
+double getClock(void)
+//
+//  Input:   none
+//  Output:  returns current processor time (sec)
+//  Purpose: reads the clock used for timing.
+//
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
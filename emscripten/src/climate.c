@@ -32,6 +32,11 @@
 //   Build 5.1.013:
 //   - Reads names of monthly adjustment patterns for various parameters
 //     of a subcatchment from the [ADJUSTMENTS] section of input file.
+//
+//   A climate file is parsed just once into a store of daily values
+//   indexed by month, from which each day's values are looked up directly.
+//   The store is kept between runs and re-used as long as the file's
+//   contents (identified by their hash) have not changed.
 ///-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -72,6 +77,20 @@ typedef struct
     int       front;         // index of front of moving average window
 } TMovAve;
 
+typedef struct
+{
+    unsigned int hash;       // hash of climate file's contents
+    long      size;          // size of climate file (bytes)
+    int       format;        // climate file format
+    int       unitSystem;    // unit system that values were converted to
+    int       firstMonth;    // index (12*year + month-1) of first month
+    int       nMonths;       // number of months of data
+    int       leadError;     // TRUE if file has bad lines before first month
+    char*     hasData;       // TRUE if file has records for a month
+    char*     hasError;      // TRUE if a bad line follows a month's records
+    double    (*data)[4][32];   // each month's daily climate data
+} TFileStore;
+
 
 //-----------------------------------------------------------------------------
 //  Shared variables
@@ -102,7 +121,9 @@ static int      FileDay;               // current day of month of file data
 static int      FileLastDay;           // last day of current month of file data
 static int      FileElapsedDays;       // number of days read from file
 static double   FileValue[4];          // current day's values of climate data
-static double   FileData[4][32];       // month's worth of daily climate data
+static double   (*FileData)[32];       // month's worth of daily climate data
+static double   NoFileData[4][32];     // month of missing climate data
+static TFileStore FileStore;           // parsed contents of climate file
 static char     FileLine[MAXLINE+1];   // line from climate data file
 
 static int      FileFieldPos[4];       // start of data fields for file record
@@ -119,16 +140,21 @@ static int      FileWindType;          // wind speed type
 //  climate_initState                  // called by project_init
 //  climate_setState                   // called by runoff_execute
 //  climate_getNextEvapDate            // called by runoff_getTimeStep
+//  climate_close                      // called by swmm_close
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 static int  getFileFormat(void);
-static void readFileLine(int *year, int *month);
-static void readUserFileLine(int *year, int *month);
-static void readTD3200FileLine(int *year, int *month);
-static void readDLY0204FileLine(int *year, int *month);
-static void readFileValues(void);
+static int  readFileLine(int *year, int *month);
+static int  readUserFileLine(int *year, int *month);
+static int  readTD3200FileLine(int *year, int *month);
+static int  readDLY0204FileLine(int *year, int *month);
+
+static int  isFileStored(void);
+static void storeFileValues(void);
+static void freeFileStore(void);
+static int  getFileMonth(int year, int month);
 
 static void setNextEvapDate(DateTime thedate);
 static void setEvap(DateTime theDate);
@@ -145,7 +171,7 @@ static void parseDLY0204FileLine(void);
 static void setTD3200FileValues(int param);
 
 static int  isGhcndFormat(char* line);
-static void readGhcndFileLine(int *year, int *month);
+static int  readGhcndFileLine(int *year, int *month);
 static void parseGhcndFileLine(void);
 
 //=============================================================================
@@ -523,7 +549,8 @@ void climate_openFile()
 //  Purpose: opens a climate file and reads in first set of values.
 //
 {
-    int i, m, y;
+    int i, j, k;
+    int hasError;
 
     // --- open the file
     if ( (Fclimate.file = fopen(Fclimate.name, "rt")) == NULL )
@@ -538,6 +565,11 @@ void climate_openFile()
     FileValue[TMAX] = Temp.ta;
     FileValue[EVAP] = 0.0;
     FileValue[WIND] = 0.0;
+    for ( i=0; i<MAXCLIMATEVARS; i++)
+    {
+        for (j=0; j<MAXDAYSPERMONTH; j++) NoFileData[i][j] = MISSING;
+    }
+    FileData = NoFileData;
 
     // --- find climate file's format
     FileFormat = getFileFormat();
@@ -547,37 +579,42 @@ void climate_openFile()
         return;
     }
 
-    // --- position file to begin reading climate file at either user-specified
+    // --- parse the file's contents unless they were parsed on a prior run
+    if ( !isFileStored() ) storeFileValues();
+    fclose(Fclimate.file);
+    Fclimate.file = NULL;
+    if ( ErrorCode ) return;
+
+    // --- begin reading climate data at either user-specified
     //     month/year or at start of simulation period.
-    rewind(Fclimate.file);
-    strcpy(FileLine, "");
     if ( Temp.fileStartDate == NO_DATE )
         datetime_decodeDate(StartDate, &FileYear, &FileMonth, &FileDay);
     else
         datetime_decodeDate(Temp.fileStartDate, &FileYear, &FileMonth, &FileDay);
-    while ( !feof(Fclimate.file) )
+    k = getFileMonth(FileYear, FileMonth);
+    if ( k < 0 || !FileStore.hasData[k] )
     {
-        strcpy(FileLine, "");
-        readFileLine(&y, &m);
-        if ( y == FileYear && m == FileMonth ) break;
+        report_writeErrorMsg(ERR_CLIMATE_END_OF_FILE, Fclimate.name);
+        return;
     }
-    if ( feof(Fclimate.file) )
+
+    // --- check for unreadable lines up through the starting month
+    hasError = FileStore.leadError;
+    for (j = 0; j <= k; j++) hasError |= FileStore.hasError[j];
+    if ( hasError )
     {
-        report_writeErrorMsg(ERR_CLIMATE_END_OF_FILE, Fclimate.name);
+        report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
         return;
     }
 
     // --- initialize file dates and current climate variable values
-    if ( !ErrorCode )
+    FileElapsedDays = 0;
+    FileLastDay = datetime_daysPerMonth(FileYear, FileMonth);
+    FileData = FileStore.data[k];
+    for (i=TMIN; i<=WIND; i++)
     {
-        FileElapsedDays = 0;
-        FileLastDay = datetime_daysPerMonth(FileYear, FileMonth);
-        readFileValues();
-        for (i=TMIN; i<=WIND; i++)
-        {
-            if ( FileData[i][FileDay] == MISSING ) continue;
-            FileValue[i] = FileData[i][FileDay];
-        }
+        if ( FileData[i][FileDay] == MISSING ) continue;
+        FileValue[i] = FileData[i][FileDay];
     }
 }
 
@@ -656,6 +693,18 @@ DateTime climate_getNextEvapDate()
 
 //=============================================================================
 
+void climate_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the climate file store kept for later runs of a project.
+//
+{
+    freeFileStore();
+}
+
+//=============================================================================
+
 void setNextEvapDate(DateTime theDate)
 //
 //  Input:   theDate = current simulation date
@@ -723,14 +772,14 @@ void updateFileValues(DateTime theDate)
 //
 //  Input:   theDate = current simulation date
 //  Output:  none
-//  Purpose: updates daily climate variables for new day or reads in
+//  Purpose: updates daily climate variables for new day or retrieves
 //           another month worth of values if a new month begins.
 //
 //  NOTE:    counters FileElapsedDays, FileDay, FileMonth, FileYear and
 //           FileLastDay were initialized in climate_openFile().
 //
 {
-    int i;
+    int i, k;
     int deltaDays;
 
     // --- see if a new day has begun
@@ -750,9 +799,20 @@ void updateFileValues(DateTime theDate)
                 FileMonth = 1;
                 FileYear++;
             }
-            readFileValues();
             FileDay = 1;
             FileLastDay = datetime_daysPerMonth(FileYear, FileMonth);
+
+            // --- look up the month's data in the climate file store
+            FileData = NoFileData;
+            k = getFileMonth(FileYear, FileMonth);
+            if ( k >= 0 )
+            {
+                if ( FileStore.hasError[k] )
+                {
+                    report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
+                }
+                FileData = FileStore.data[k];
+            }
         }
 
         // --- set climate variables for new day
@@ -1040,57 +1100,51 @@ int  getFileFormat()
 
 //=============================================================================
 
-void readFileLine(int *y, int *m)
+int readFileLine(int *y, int *m)
 //
 //  Input:   none
 //  Output:  y = year
 //           m = month
-//  Purpose: reads year & month from next line of climate file.
+//           returns an error code
+//  Purpose: reads year & month from current line of climate file.
 //
 {
-    // --- read next line from climate data file
-    while ( strlen(FileLine) == 0 )
-    {
-        if ( fgets(FileLine, MAXLINE, Fclimate.file) == NULL ) return;
-     	if ( FileLine[0] == '\n' ) FileLine[0] = '\0';
-    }
-
-    // --- parse year & month from line
     switch (FileFormat)
     {
-    case  USER_PREPARED: readUserFileLine(y, m);   break;
-    case  TD3200:        readTD3200FileLine(y,m);  break;
-    case  DLY0204:       readDLY0204FileLine(y,m); break;
-    case  GHCND:         readGhcndFileLine(y,m);   break; 
+    case  USER_PREPARED: return readUserFileLine(y, m);
+    case  TD3200:        return readTD3200FileLine(y,m);
+    case  DLY0204:       return readDLY0204FileLine(y,m);
+    case  GHCND:         return readGhcndFileLine(y,m);
     }
+    return 0;
 }
 
 //=============================================================================
 
-void readUserFileLine(int* y, int* m)
+int readUserFileLine(int* y, int* m)
 //
 //  Input:   none
 //  Output:  y = year
 //           m = month
+//           returns an error code
 //  Purpose: reads year & month from line of User-Prepared climate file.
 //
 {
     int n;
     char staID[80];
     n = sscanf(FileLine, "%s %d %d", staID, y, m);
-    if ( n < 3 )
-    {
-        report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
-    }
+    if ( n < 3 ) return ERR_CLIMATE_FILE_READ;
+    return 0;
 }
 
 //=============================================================================
 
-void readTD3200FileLine(int* y, int* m)
+int readTD3200FileLine(int* y, int* m)
 //
 //  Input:   none
 //  Output:  y = year
 //           m = month
+//           returns an error code
 //  Purpose: reads year & month from line of TD-3200 climate file.
 //
 {
@@ -1101,34 +1155,28 @@ void readTD3200FileLine(int* y, int* m)
 
     // --- check for minimum number of characters
     len = strlen(FileLine);
-    if ( len < 30 )
-    {
-        report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
-        return;
-    }
+    if ( len < 30 ) return ERR_CLIMATE_FILE_READ;
 
     // --- check for proper type of record
     sstrncpy(recdType, FileLine, 3);
-    if ( strcmp(recdType, "DLY") != 0 )
-    {
-        report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
-        return;
-    }
+    if ( strcmp(recdType, "DLY") != 0 ) return ERR_CLIMATE_FILE_READ;
 
     // --- get record's date
     sstrncpy(year,  &FileLine[17], 4);
     sstrncpy(month, &FileLine[21], 2);
     *y = atoi(year);
     *m = atoi(month);
+    return 0;
 }
 
 //=============================================================================
 
-void readDLY0204FileLine(int* y, int* m)
+int readDLY0204FileLine(int* y, int* m)
 //
 //  Input:   none
 //  Output:  y = year
 //           m = month
+//           returns an error code
 //  Purpose: reads year & month from line of DLY02 or DLY04 climate file.
 //
 {
@@ -1138,54 +1186,174 @@ void readDLY0204FileLine(int* y, int* m)
 
     // --- check for minimum number of characters
     len = strlen(FileLine);
-    if ( len < 16 )
-    {
-        report_writeErrorMsg(ERR_CLIMATE_FILE_READ, Fclimate.name);
-        return;
-    }
+    if ( len < 16 ) return ERR_CLIMATE_FILE_READ;
 
     // --- get record's date
     sstrncpy(year,  &FileLine[7], 4);
     sstrncpy(month, &FileLine[11], 2);
     *y = atoi(year);
     *m = atoi(month);
+    return 0;
 }
 
 //=============================================================================
 
-void readFileValues()
+int isFileStored()
 //
 //  Input:   none
-//  Output:  none
-//  Purpose: reads next month's worth of data from climate file.
+//  Output:  returns TRUE if the climate file store holds the file's contents
+//  Purpose: checks if the climate file was already parsed on a prior run.
+//
+//  The store is identified by an FNV-1a hash and the size of the file's
+//  contents together with the unit system its values were converted to.
 //
 {
-    int  i, j;
-    int  y, m;
+    unsigned int hash = 2166136261u;
+    long   size = 0;
+    size_t i, n;
+    char   buf[MAXLINE];
 
-    // --- initialize FileData array to missing values
-    for ( i=0; i<MAXCLIMATEVARS; i++)
+    // --- compute hash of the file's contents
+    rewind(Fclimate.file);
+    while ( (n = fread(buf, 1, MAXLINE, Fclimate.file)) > 0 )
     {
-        for (j=0; j<MAXDAYSPERMONTH; j++) FileData[i][j] = MISSING;
+        for (i = 0; i < n; i++)
+        {
+            hash ^= (unsigned char)buf[i];
+            hash *= 16777619u;
+        }
+        size += (long)n;
     }
+    rewind(Fclimate.file);
+
+    // --- compare it with that of the stored file
+    if ( FileStore.data != NULL &&
+         FileStore.hash == hash &&
+         FileStore.size == size &&
+         FileStore.format == FileFormat &&
+         FileStore.unitSystem == UnitSystem ) return TRUE;
+
+    // --- otherwise save the new file's hash
+    freeFileStore();
+    FileStore.hash = hash;
+    FileStore.size = size;
+    return FALSE;
+}
 
-    while ( !ErrorCode )
+//=============================================================================
+
+void storeFileValues()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: parses all of the climate file's data into the climate file store.
+//
+//  The file is read twice: first to find the range of months it covers and
+//  then to parse each line's values into the daily data of its month.
+//
+{
+    int  i, j, k, y, m;
+    int  firstMonth = 0;
+    int  lastMonth = -1;
+    int  lastK = -1;
+
+    // --- find first and last month of data in the file
+    rewind(Fclimate.file);
+    while ( fgets(FileLine, MAXLINE, Fclimate.file) != NULL )
+    {
+        if ( FileLine[0] == '\n' ) continue;
+        y = -1;
+        m = -1;
+        if ( readFileLine(&y, &m) || y < 0 || m < 1 || m > 12 ) continue;
+        k = 12*y + m - 1;
+        if ( lastMonth < 0 ) firstMonth = k;
+        firstMonth = MIN(firstMonth, k);
+        lastMonth = MAX(lastMonth, k);
+    }
+    if ( lastMonth < 0 ) lastMonth = firstMonth;
+
+    // --- allocate the store with all values missing
+    FileStore.format = FileFormat;
+    FileStore.unitSystem = UnitSystem;
+    FileStore.firstMonth = firstMonth;
+    FileStore.nMonths = lastMonth - firstMonth + 1;
+    FileStore.leadError = FALSE;
+    FileStore.hasData = (char *) calloc(FileStore.nMonths, sizeof(char));
+    FileStore.hasError = (char *) calloc(FileStore.nMonths, sizeof(char));
+    FileStore.data = calloc(FileStore.nMonths, sizeof(FileStore.data[0]));
+    if ( FileStore.hasData == NULL || FileStore.hasError == NULL ||
+         FileStore.data == NULL )
+    {
+        freeFileStore();
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return;
+    }
+    for (k = 0; k < FileStore.nMonths; k++)
     {
-        // --- return when date on line is after current file date
-        if ( feof(Fclimate.file) ) return;
-        readFileLine(&y, &m);
-        if ( y > FileYear || m > FileMonth ) return;
+        for ( i=0; i<MAXCLIMATEVARS; i++)
+        {
+            for (j=0; j<MAXDAYSPERMONTH; j++) FileStore.data[k][i][j] = MISSING;
+        }
+    }
 
-        // --- parse climate values from file line
+    // --- parse each line's values into its month of data
+    //     (an unreadable line is charged to the month read before it)
+    rewind(Fclimate.file);
+    while ( fgets(FileLine, MAXLINE, Fclimate.file) != NULL )
+    {
+        if ( FileLine[0] == '\n' ) continue;
+        y = -1;
+        m = -1;
+        if ( readFileLine(&y, &m) )
+        {
+            if ( lastK < 0 ) FileStore.leadError = TRUE;
+            else FileStore.hasError[lastK] = TRUE;
+            continue;
+        }
+        if ( y < 0 || m < 1 || m > 12 ) continue;
+        k = 12*y + m - 1 - firstMonth;
+        FileData = FileStore.data[k];
         switch (FileFormat)
         {
         case  USER_PREPARED: parseUserFileLine();   break;
         case  TD3200:        parseTD3200FileLine();  break;
         case  DLY0204:       parseDLY0204FileLine(); break;
-        case  GHCND:         parseGhcndFileLine();   break; 
+        case  GHCND:         parseGhcndFileLine();   break;
         }
-        strcpy(FileLine, "");
+        FileStore.hasData[k] = TRUE;
+        lastK = k;
     }
+    FileData = NoFileData;
+}
+
+//=============================================================================
+
+void freeFileStore()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory used by the climate file store.
+//
+{
+    FREE(FileStore.hasData);
+    FREE(FileStore.hasError);
+    FREE(FileStore.data);
+    FileStore.nMonths = 0;
+}
+
+//=============================================================================
+
+int getFileMonth(int y, int m)
+//
+//  Input:   y = year
+//           m = month
+//  Output:  returns index of month in climate file store or -1 if not found
+//  Purpose: finds where a month of climate data resides in the file store.
+//
+{
+    int k = 12*y + m - 1 - FileStore.firstMonth;
+    if ( k < 0 || k >= FileStore.nMonths ) return -1;
+    return k;
 }
 
 //=============================================================================
@@ -1436,11 +1604,12 @@ int isGhcndFormat(char* line)
 
 //=============================================================================
 
-void readGhcndFileLine(int* y, int* m)
+int readGhcndFileLine(int* y, int* m)
 //
 //  Input:   none
 //  Output:  y = year
 //           m = month
+//           returns an error code
 //  Purpose: reads year & month from line of a NCDC GHCN Daily climate file.
 //
 {
@@ -1450,6 +1619,7 @@ void readGhcndFileLine(int* y, int* m)
         *y = -99999;
         *m = -99999;
     }
+    return 0;
 }
 
 //=============================================================================
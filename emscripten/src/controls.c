@@ -102,6 +102,8 @@ struct  TPremise
     struct  TVariable rhsVar;     // right hand side variable 
     int     relation;             // relational operator (>, <, =, etc)
     double  value;                // right hand side value
+    int     lhsIndex;             // index of lhsVar in compiled variables
+    int     rhsIndex;             // index of rhsVar in compiled variables
     struct  TPremise *next;       // next premise clause of rule
 };
 
@@ -135,6 +137,21 @@ struct  TRule
    struct   TPremise* lastPremise;     // pointer to last premise of rule
    struct   TAction*  thenActions;     // linked list of actions if true
    struct   TAction*  elseActions;     // linked list of actions if false
+   //-----------------------------
+   struct   TPremise* premises;        // compiled (contiguous) premises
+   char     alwaysEval;                // TRUE if evaluated every rule step
+   char     changed;                   // TRUE if a premise variable changed
+   char     setsControl;               // TRUE if premises set ControlValue
+   int      result;                    // last result of premises (-1 if none)
+   double   controlValue;              // ControlValue after last evaluation
+   double   setPoint;                  // SetPoint after last evaluation
+};
+
+// Reference to a premise variable (used when compiling rules)
+struct  TVariableRef
+{
+   struct  TVariable v;      // premise variable
+   int*    index;            // location of variable's compiled index
 };
 
 //-----------------------------------------------------------------------------
@@ -149,6 +166,16 @@ double   SetPoint;                     // value of controller setpoint
 DateTime CurrentDate;                  // current date in whole days 
 DateTime CurrentTime;                  // current time of day (decimal)
 
+// --- compiled rules
+static int       Compiled;             // TRUE if rules have been compiled
+static char      ControlTouched;       // TRUE if ControlValue was assigned
+static struct    TPremise*  Premises;  // all rule premises in rule order
+static struct    TVariable* Variables; // distinct premise variables
+static double*   VarValues;            // value of each variable
+static int       VarCount;             // number of distinct variables
+static int*      VarRuleStart;         // start of each variable's rules
+static int*      VarRules;             // rules that read each variable
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -165,6 +192,14 @@ int    getPremiseVariable(char* tok[], int* k, struct TVariable* v);
 int    getPremiseValue(char* token, int attrib, double* value);
 int    addAction(int r, char* Tok[], int nToks);
 
+int    compileRules(void);
+int    compileVariables(int nPremises);
+int    compareVariableRefs(const void* ref1, const void* ref2);
+int    isTimeAttribute(int attribute);
+int    hasModulatedAction(struct TAction* a);
+void   updateVariables(void);
+int    evaluateRule(int r, double tStep);
+
 int    evaluatePremise(struct TPremise* p, double tStep);
 double getVariableValue(struct TVariable v);
 int    compareTimes(double lhsValue, int relation, double rhsValue,
@@ -196,6 +231,7 @@ int  controls_create(int n)
    ActionList = NULL;
    InputState = r_PRIORITY;
    RuleCount = n;
+   Compiled = FALSE;
    if ( n == 0 ) return 0;
    Rules = (struct TRule *) calloc(RuleCount, sizeof(struct TRule));
    if (Rules == NULL) return ERR_MEMORY;
@@ -207,6 +243,7 @@ int  controls_create(int n)
        Rules[r].thenActions = NULL;
        Rules[r].elseActions = NULL;
        Rules[r].priority = 0.0;    
+       Rules[r].premises = NULL;
    }
    return 0;
 }
@@ -294,7 +331,6 @@ int controls_evaluate(DateTime currentTime, DateTime elapsedTime, double tStep)
 {
     int    r;                          // control rule index
     int    result;                     // TRUE if rule premises satisfied
-    struct TPremise* p;                // pointer to rule premise clause
     struct TAction*  a;                // pointer to rule action clause
 
     // --- save date and time to shared variables
@@ -302,28 +338,40 @@ int controls_evaluate(DateTime currentTime, DateTime elapsedTime, double tStep)
     CurrentTime = currentTime - floor(currentTime);
     ElapsedTime = elapsedTime;
 
-    // --- evaluate each rule
+    // --- compile rules the first time they are evaluated
     if ( RuleCount == 0 ) return 0;
+    if ( !Compiled )
+    {
+        if ( !compileRules() )
+        {
+            report_writeErrorMsg(ERR_MEMORY, "");
+            return 0;
+        }
+        Compiled = TRUE;
+    }
+
+    // --- update premise variables, noting rules whose inputs changed
+    updateVariables();
+
+    // --- evaluate each rule
     clearActionList();
     for (r=0; r<RuleCount; r++)
     {
-        // --- evaluate rule's premises
-        result = TRUE;
-        p = Rules[r].firstPremise;
-        while (p)
+        // --- evaluate rule's premises if any of its inputs changed,
+        //     otherwise re-use the result of its last evaluation
+        if ( Rules[r].result < 0 || Rules[r].alwaysEval || Rules[r].changed )
         {
-            if ( p->type == r_OR )
-            {
-                if ( result == FALSE )
-                    result = evaluatePremise(p, tStep);
-            }
-            else
+            result = evaluateRule(r, tStep);
+        }
+        else
+        {
+            result = Rules[r].result;
+            if ( Rules[r].setsControl )
             {
-                if ( result == FALSE ) break;
-                result = evaluatePremise(p, tStep);
+                ControlValue = Rules[r].controlValue;
+                SetPoint = Rules[r].setPoint;
             }
-            p = p->next;
-        }    
+        }
 
         // --- if premises true, add THEN clauses to action list
         //     else add ELSE clauses to action list
@@ -344,6 +392,269 @@ int controls_evaluate(DateTime currentTime, DateTime elapsedTime, double tStep)
 
 //=============================================================================
 
+int evaluateRule(int r, double tStep)
+//
+//  Input:   r = control rule index
+//           tStep = simulation time step (days)
+//  Output:  returns TRUE if rule's premises are satisfied
+//  Purpose: evaluates a control rule's premises and saves the outcome.
+//
+{
+    int    result = TRUE;
+    struct TPremise* p;
+
+    ControlTouched = FALSE;
+    p = Rules[r].premises;
+    while (p)
+    {
+        if ( p->type == r_OR )
+        {
+            if ( result == FALSE )
+                result = evaluatePremise(p, tStep);
+        }
+        else
+        {
+            if ( result == FALSE ) break;
+            result = evaluatePremise(p, tStep);
+        }
+        p = p->next;
+    }
+
+    // --- save outcome for re-use while rule's inputs are unchanged
+    Rules[r].result = result;
+    Rules[r].changed = FALSE;
+    Rules[r].setsControl = ControlTouched;
+    Rules[r].controlValue = ControlValue;
+    Rules[r].setPoint = SetPoint;
+    return result;
+}
+
+//=============================================================================
+
+int compileRules()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: copies the premises of all rules into a single array, assigns
+//           each premise variable an index into a list of distinct
+//           variables, and finds which rules read each variable.
+//
+//  A rule is re-evaluated only when one of its variables changes value
+//  unless it compares times (which depend on the time step) or has
+//  modulated actions (which must be updated at every rule step).
+//
+{
+    int    r, i, n = 0;
+    struct TPremise* p;
+
+    // --- count premises
+    for (r = 0; r < RuleCount; r++)
+    {
+        p = Rules[r].firstPremise;
+        while (p)
+        {
+            n++;
+            p = p->next;
+        }
+    }
+
+    // --- copy each rule's premises into a contiguous block
+    Premises = (struct TPremise *) calloc(n+1, sizeof(struct TPremise));
+    if ( Premises == NULL ) return FALSE;
+    i = 0;
+    for (r = 0; r < RuleCount; r++)
+    {
+        Rules[r].premises = NULL;
+        Rules[r].alwaysEval = hasModulatedAction(Rules[r].thenActions) ||
+                              hasModulatedAction(Rules[r].elseActions);
+        Rules[r].changed = FALSE;
+        Rules[r].setsControl = FALSE;
+        Rules[r].result = -1;
+        p = Rules[r].firstPremise;
+        if ( p ) Rules[r].premises = &Premises[i];
+        while (p)
+        {
+            Premises[i] = *p;
+            Premises[i].lhsIndex = -1;
+            Premises[i].rhsIndex = -1;
+            Premises[i].next = NULL;
+            if ( i > 0 && p != Rules[r].firstPremise )
+                Premises[i-1].next = &Premises[i];
+            if ( isTimeAttribute(p->lhsVar.attribute) )
+                Rules[r].alwaysEval = TRUE;
+            i++;
+            p = p->next;
+        }
+    }
+
+    // --- compile the premise variables
+    return compileVariables(n);
+}
+
+//=============================================================================
+
+int compileVariables(int nPremises)
+//
+//  Input:   nPremises = number of rule premises
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: builds the list of distinct premise variables and the list of
+//           rules that read each of them.
+//
+{
+    int    r, i, j, k, n = 0;
+    struct TVariableRef* refs;
+    struct TPremise* p;
+
+    // --- list a reference to each variable used by a premise
+    refs = (struct TVariableRef *) calloc(2*nPremises+1,
+                                          sizeof(struct TVariableRef));
+    if ( refs == NULL ) return FALSE;
+    for (i = 0; i < nPremises; i++)
+    {
+        refs[n].v = Premises[i].lhsVar;
+        refs[n].index = &Premises[i].lhsIndex;
+        n++;
+        if ( Premises[i].value == MISSING )
+        {
+            refs[n].v = Premises[i].rhsVar;
+            refs[n].index = &Premises[i].rhsIndex;
+            n++;
+        }
+    }
+
+    // --- sort the references so that identical variables are adjacent
+    //     and assign each distinct variable an index
+    qsort(refs, n, sizeof(struct TVariableRef), compareVariableRefs);
+    VarCount = 0;
+    for (k = 0; k < n; k++)
+    {
+        if ( k == 0 || compareVariableRefs(&refs[k-1], &refs[k]) != 0 )
+            VarCount++;
+        *(refs[k].index) = VarCount - 1;
+    }
+
+    // --- save the distinct variables
+    Variables = (struct TVariable *) calloc(VarCount+1,
+                                            sizeof(struct TVariable));
+    VarValues = (double *) calloc(VarCount+1, sizeof(double));
+    VarRuleStart = (int *) calloc(VarCount+1, sizeof(int));
+    VarRules = (int *) calloc(n+1, sizeof(int));
+    if ( !Variables || !VarValues || !VarRuleStart || !VarRules )
+    {
+        free(refs);
+        return FALSE;
+    }
+    for (k = 0; k < n; k++) Variables[*(refs[k].index)] = refs[k].v;
+    free(refs);
+
+    // --- count the premises of all rules that read each variable
+    for (r = 0; r < RuleCount; r++)
+    {
+        for (p = Rules[r].premises; p; p = p->next)
+        {
+            VarRuleStart[p->lhsIndex+1]++;
+            if ( p->rhsIndex >= 0 ) VarRuleStart[p->rhsIndex+1]++;
+        }
+    }
+    for (j = 0; j < VarCount; j++) VarRuleStart[j+1] += VarRuleStart[j];
+
+    // --- list the rules that read each variable
+    //     (VarValues is used as a temporary fill counter)
+    for (r = 0; r < RuleCount; r++)
+    {
+        for (p = Rules[r].premises; p; p = p->next)
+        {
+            j = p->lhsIndex;
+            VarRules[VarRuleStart[j] + (int)VarValues[j]] = r;
+            VarValues[j] += 1.0;
+            j = p->rhsIndex;
+            if ( j < 0 ) continue;
+            VarRules[VarRuleStart[j] + (int)VarValues[j]] = r;
+            VarValues[j] += 1.0;
+        }
+    }
+    for (j = 0; j < VarCount; j++) VarValues[j] = MISSING;
+    return TRUE;
+}
+
+//=============================================================================
+
+int compareVariableRefs(const void* ref1, const void* ref2)
+//
+//  Input:   ref1, ref2 = pointers to two premise variable references
+//  Output:  returns -1, 0, or 1 if first variable is less than, equal to,
+//           or greater than the second
+//  Purpose: comparison function used to sort premise variables.
+//
+{
+    const struct TVariable* v1 = &((const struct TVariableRef *)ref1)->v;
+    const struct TVariable* v2 = &((const struct TVariableRef *)ref2)->v;
+    if ( v1->attribute != v2->attribute )
+        return (v1->attribute < v2->attribute) ? -1 : 1;
+    if ( v1->node != v2->node ) return (v1->node < v2->node) ? -1 : 1;
+    if ( v1->link != v2->link ) return (v1->link < v2->link) ? -1 : 1;
+    return 0;
+}
+
+//=============================================================================
+
+int isTimeAttribute(int attribute)
+//
+//  Input:   attribute = premise variable attribute code
+//  Output:  returns TRUE if attribute is compared using the time step
+//  Purpose: identifies premise attributes evaluated with compareTimes.
+//
+{
+    return ( attribute == r_TIME || attribute == r_CLOCKTIME ||
+             attribute == r_TIMEOPEN || attribute == r_TIMECLOSED );
+}
+
+//=============================================================================
+
+int hasModulatedAction(struct TAction* a)
+//
+//  Input:   a = first action in a list of rule actions
+//  Output:  returns TRUE if any action is set by a curve, time series,
+//           or PID controller
+//  Purpose: identifies actions that must be updated at every rule step.
+//
+{
+    while (a)
+    {
+        if ( a->curve >= 0 || a->tseries >= 0 || a->attribute == r_PID )
+            return TRUE;
+        a = a->next;
+    }
+    return FALSE;
+}
+
+//=============================================================================
+
+void updateVariables()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: finds the current value of each premise variable and marks
+//           the rules that read any variable whose value has changed.
+//
+{
+    int    j, k;
+    double x;
+
+    for (j = 0; j < VarCount; j++)
+    {
+        x = getVariableValue(Variables[j]);
+        if ( x == VarValues[j] ) continue;
+        VarValues[j] = x;
+        for (k = VarRuleStart[j]; k < VarRuleStart[j+1]; k++)
+        {
+            Rules[VarRules[k]].changed = TRUE;
+        }
+    }
+}
+
+//=============================================================================
+
 int  addPremise(int r, int type, char* tok[], int nToks)
 //
 //  Input:   r = control rule index
@@ -403,7 +714,7 @@ int  addPremise(int r, int type, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the premise object
-    p = (struct TPremise *) malloc(sizeof(struct TPremise));
+    p = (struct TPremise *) project_alloc(1, sizeof(struct TPremise));
     if ( !p ) return ERR_MEMORY;
     p->type      = type;
     p->lhsVar    = v1;
@@ -702,7 +1013,7 @@ int  addAction(int r, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the action object
-    a = (struct TAction *) malloc(sizeof(struct TAction));
+    a = (struct TAction *) project_alloc(1, sizeof(struct TAction));
     if ( !a ) return ERR_MEMORY;
     a->rule      = r;
     a->link      = link;
@@ -959,8 +1270,8 @@ int evaluatePremise(struct TPremise* p, double tStep)
     double lhsValue, rhsValue;
     int    result = FALSE;
 
-    lhsValue = getVariableValue(p->lhsVar);
-    if ( p->value == MISSING ) rhsValue = getVariableValue(p->rhsVar);
+    lhsValue = VarValues[p->lhsIndex];
+    if ( p->value == MISSING ) rhsValue = VarValues[p->rhsIndex];
     else                       rhsValue = p->value;
     if ( lhsValue == MISSING || rhsValue == MISSING ) return FALSE;
     switch (p->lhsVar.attribute)
@@ -972,6 +1283,7 @@ int evaluatePremise(struct TPremise* p, double tStep)
     case r_TIMECLOSED:
         result = compareTimes(lhsValue, p->relation, rhsValue, tStep/2.0);
         ControlValue = lhsValue * 24.0;  // convert time from days to hours
+        ControlTouched = TRUE;
         return result;
     default:
         return compareValues(lhsValue, p->relation, rhsValue);
@@ -1089,6 +1401,7 @@ int compareValues(double lhsValue, int relation, double rhsValue)
 {
     SetPoint = rhsValue;
     ControlValue = lhsValue;
+    ControlTouched = TRUE;
     switch (relation)
     {
       case EQ: if ( lhsValue == rhsValue ) return TRUE; break;
@@ -1148,38 +1461,21 @@ void  deleteRules(void)
 //  Output:  none
 //  Purpose: frees the memory used for all of the control rules.
 //
+//  Note: a rule's premise and action clauses are allocated from the
+//        project's memory pool and are released when the project is closed.
+//
 {
-   struct TPremise* p;
-   struct TPremise* pnext;
-   struct TAction*  a;
-   struct TAction*  anext;
-   int r;
-   for (r=0; r<RuleCount; r++)
-   {
-      p = Rules[r].firstPremise;
-      while ( p )
-      {
-         pnext = p->next;
-         free(p);
-         p = pnext;
-      }
-      a = Rules[r].thenActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-      a = Rules[r].elseActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-   }
    FREE(Rules);
    RuleCount = 0;
+
+   // --- free compiled rules
+   FREE(Premises);
+   FREE(Variables);
+   FREE(VarValues);
+   FREE(VarRuleStart);
+   FREE(VarRules);
+   VarCount = 0;
+   Compiled = FALSE;
 }
 
 //=============================================================================
@@ -286,6 +286,70 @@ void datetime_timeToStr(DateTime time, char* s)
 
 //=============================================================================
 
+static int getDigits(char** s, int* x)
+
+//  Input:   s = pointer to a position in a string
+//  Output:  x = value of the unsigned integer starting at that position;
+//           s = position following the integer;
+//           returns 1 if an integer of 1 to 9 digits was read, 0 if not
+//  Purpose: reads the digits of an unsigned integer.
+
+{
+    int n = 0;
+    *x = 0;
+    while ( **s >= '0' && **s <= '9' )
+    {
+        if ( ++n > 9 ) return 0;
+        *x = 10 * (*x) + (**s - '0');
+        (*s)++;
+    }
+    return n > 0;
+}
+
+//=============================================================================
+
+static int getDateParts(char* s, int* x1, int* x2, int* x3)
+
+//  Input:   s = date as string
+//  Output:  x1, x2, x3 = the date's three numbers in the order written;
+//           returns 1 if successful, 0 if not
+//  Purpose: splits a date written as three unsigned numbers joined by
+//           single separators (e.g. 01/31/2020), giving the same values
+//           as sscanf(s, "%d%c%d%c%d", ...). Other forms are left to
+//           sscanf.
+
+{
+    if ( !getDigits(&s, x1) || *s++ == '\0' ) return 0;
+    if ( !getDigits(&s, x2) || *s++ == '\0' ) return 0;
+    if ( !getDigits(&s, x3) ) return 0;
+    return *s == '\0';
+}
+
+//=============================================================================
+
+static int getTimeParts(char* s, int* hr, int* min, int* sec)
+
+//  Input:   s = time as string
+//  Output:  hr, min, sec = the time's hours, minutes and seconds;
+//           returns 1 if successful, 0 if not
+//  Purpose: splits a time written as hr:min or hr:min:sec with unsigned
+//           numbers, giving the same values as sscanf(s, "%d:%d:%d", ...).
+//           Other forms are left to strtod and sscanf.
+
+{
+    *sec = 0;
+    if ( !getDigits(&s, hr) || *s++ != ':' ) return 0;
+    if ( !getDigits(&s, min) ) return 0;
+    if ( *s == ':' )
+    {
+        s++;
+        if ( !getDigits(&s, sec) ) return 0;
+    }
+    return *s == '\0';
+}
+
+//=============================================================================
+
 int datetime_strToDate(char* s, DateTime* d)
 
 //  Input:   s = date as string
@@ -303,6 +367,7 @@ int datetime_strToDate(char* s, DateTime* d)
         switch (DateFormat)
         {
           case Y_M_D:
+            if ( getDateParts(s, &yr, &mon, &day) ) break;
             n = sscanf(s, "%d%c%d%c%d", &yr, &sep1, &mon, &sep2, &day);
             if ( n < 3 )
             {
@@ -313,6 +378,7 @@ int datetime_strToDate(char* s, DateTime* d)
             break;
 
           case D_M_Y:
+            if ( getDateParts(s, &day, &mon, &yr) ) break;
             n = sscanf(s, "%d%c%d%c%d", &day, &sep1, &mon, &sep2, &yr);
             if ( n < 3 )
             {
@@ -323,6 +389,7 @@ int datetime_strToDate(char* s, DateTime* d)
             break;
 
           default: // M_D_Y
+            if ( getDateParts(s, &mon, &day, &yr) ) break;
             n = sscanf(s, "%d%c%d%c%d", &mon, &sep1, &day, &sep2, &yr);
             if ( n < 3 )
             {
@@ -352,6 +419,13 @@ int datetime_strToTime(char* s, DateTime* t)
     int  n, hr, min = 0, sec = 0;
     char *endptr;
 
+    // Split a plain hr:min:sec time directly
+    if ( getTimeParts(s, &hr, &min, &sec) )
+    {
+        *t = datetime_encodeTime(hr, min, sec);
+        return 1;
+    }
+
     // Attempt to read time as decimal hours
     *t = strtod(s, &endptr);
     if ( *endptr == 0 )
@@ -82,6 +82,8 @@ static const int    DEFAULT_MAXTRIALS   = 8;       // Max. trials per time step
 typedef struct 
 {
     char    converged;                 // TRUE if iterations for a node done
+    char    active;                    // TRUE if node re-solved in iteration
+    char    changed;                   // TRUE if re-solved depth changed
     double  newSurfArea;               // current surface area (ft2)
     double  oldSurfArea;               // previous surface area (ft2)
     double  sumdqdh;                   // sum of dqdh from adjoining links
@@ -97,6 +99,17 @@ static TXnode* Xnode;                  // extended nodal information
 static double  Omega;                  // actual under-relaxation parameter
 static int     Steps;                  // number of Picard iterations
 
+// --- worklists used by the ActiveSet & SkipSteadyRegions options
+static int*    AdjStart;               // start of each node's entries in AdjLinks
+static int*    AdjLinks;               // indexes of links attached to each node
+static int*    ActiveNodes;            // nodes re-solved in current iteration
+static int*    ActiveLinks;            // links attached to an active node
+static char*   InLinkList;             // TRUE if link is in ActiveLinks
+static int     NumActiveNodes;         // number of entries in ActiveNodes
+static int     NumActiveLinks;         // number of entries in ActiveLinks
+static int     InActiveSet;            // TRUE if iteration uses the worklists
+static int     NumFrozenNodes;         // number of nodes in frozen regions
+
 //-----------------------------------------------------------------------------
 //  Function declarations
 //-----------------------------------------------------------------------------
@@ -105,6 +118,12 @@ static void   initNodeStates(void);
 static void   findBypassedLinks();
 static void   findLimitedLinks();
 
+static int    createAdjacency(void);
+static void   findActiveSet(void);
+static void   addActiveNode(int node);
+static void   addActiveLink(int link);
+static int    compareIndexes(const void* a, const void* b);
+
 static void   findLinkFlows(double dt);
 static int    isTrueConduit(int link);
 static void   findNonConduitFlow(int link, double dt);
@@ -134,6 +153,7 @@ void dynwave_init()
     double z;
 
     VariableStep = 0.0;
+    InActiveSet = FALSE;
     Xnode = (TXnode *) calloc(Nobjects[NODE], sizeof(TXnode));
     if ( Xnode == NULL )
     {
@@ -142,6 +162,14 @@ void dynwave_init()
         return;
     }
 
+    // --- create node-link adjacency lists & worklists
+    if ( (ActiveSet || SkipSteadyRegions) && !createAdjacency() )
+    {
+        report_writeErrorMsg(ERR_MEMORY,
+            " Not enough memory for dynamic wave routing.");
+        return;
+    }
+
     // --- initialize node surface areas & crown elev.
     for (i = 0; i < Nobjects[NODE]; i++ )
     {
@@ -178,6 +206,11 @@ void  dynwave_close()
 //
 {
     FREE(Xnode);
+    FREE(AdjStart);
+    FREE(AdjLinks);
+    FREE(ActiveNodes);
+    FREE(ActiveLinks);
+    FREE(InLinkList);
 }
 
 //=============================================================================
@@ -259,7 +292,10 @@ int dynwave_execute(double tStep)
             if ( converged ) break;
 
             // --- check if link calculations can be skipped in next step
-            findBypassedLinks();
+            //     (or, under the active set option, restrict the next step
+            //     to the region around the unconverged nodes)
+            if ( ActiveSet ) findActiveSet();
+            else findBypassedLinks();
         }
     }
     if ( !converged ) NonConvergeCount++;
@@ -274,13 +310,32 @@ int dynwave_execute(double tStep)
 void   initRoutingStep()
 {
     int i;
+
+    InActiveSet = FALSE;
+    NumFrozenNodes = 0;
     for (i = 0; i < Nobjects[NODE]; i++)
     {
+        // --- nodes in a frozen steady state region are treated as
+        //     converged and are not re-solved
+        if ( Node[i].frozen )
+        {
+            Xnode[i].converged = TRUE;
+            Xnode[i].active = FALSE;
+            NumFrozenNodes++;
+            continue;
+        }
         Xnode[i].converged = FALSE;
+        Xnode[i].active = TRUE;
+        Xnode[i].changed = FALSE;
         Xnode[i].dYdT = 0.0;
     }
     for (i = 0; i < Nobjects[LINK]; i++)
     {
+        if ( Link[i].frozen )
+        {
+            Link[i].bypassed = TRUE;
+            continue;
+        }
         Link[i].bypassed = FALSE;
         Link[i].surfArea1 = 0.0;
         Link[i].surfArea2 = 0.0;
@@ -288,6 +343,23 @@ void   initRoutingStep()
 
     // --- a2 preserves conduit area from solution at last time step
     for ( i = 0; i < Nlinks[CONDUIT]; i++) Conduit[i].a2 = Conduit[i].a1;
+
+    // --- restrict the worklists to the non-frozen part of the network
+    if ( NumFrozenNodes > 0 )
+    {
+        NumActiveNodes = 0;
+        NumActiveLinks = 0;
+        for (i = 0; i < Nobjects[NODE]; i++)
+        {
+            if ( Xnode[i].active ) ActiveNodes[NumActiveNodes++] = i;
+        }
+        for (i = 0; i < Nobjects[LINK]; i++)
+        {
+            InLinkList[i] = !Link[i].frozen;
+            if ( InLinkList[i] ) ActiveLinks[NumActiveLinks++] = i;
+        }
+        InActiveSet = TRUE;
+    }
 }
 
 //=============================================================================
@@ -299,10 +371,14 @@ void initNodeStates()
 //  Purpose: initializes node's surface area, inflow & outflow
 //
 {
-    int i;
+    int i, k;
+    int n = Nobjects[NODE];
 
-    for (i = 0; i < Nobjects[NODE]; i++)
+    if ( InActiveSet ) n = NumActiveNodes;
+    for (k = 0; k < n; k++)
     {
+        i = InActiveSet ? ActiveNodes[k] : k;
+
         // --- initialize nodal surface area
         if ( AllowPonding )
         {
@@ -350,6 +426,173 @@ void   findBypassedLinks()
 
 //=============================================================================
 
+void  findActiveSet()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: builds the worklists of nodes and links to be processed in the
+//           next Picard iteration.
+//
+//  The nodes whose depth changed in the last iteration (whether or not
+//  they converged), the nodes upstream and downstream of them and all
+//  links attached to any of these nodes make up the active set. Since
+//  under-relaxation keeps moving a node's depth for as long as it changes,
+//  such nodes must be re-solved just as they would be without the option.
+//  All other nodes saw no change in their depth or in the flow of their
+//  links, so re-solving them would leave their depths, inflows and
+//  outflows as they are.
+//
+{
+    int i, j, k, m, n1;
+    int count = 0;
+
+    // --- collect changed nodes at the front of ActiveNodes while
+    //     clearing the flags set by the previous iteration
+    if ( InActiveSet )
+    {
+        for (k = 0; k < NumActiveNodes; k++)
+        {
+            i = ActiveNodes[k];
+            Xnode[i].active = FALSE;
+            if ( !Xnode[i].converged || Xnode[i].changed )
+                ActiveNodes[count++] = i;
+        }
+        for (k = 0; k < NumActiveLinks; k++)
+        {
+            j = ActiveLinks[k];
+            InLinkList[j] = FALSE;
+            Link[j].bypassed = TRUE;
+        }
+    }
+    else
+    {
+        for (i = 0; i < Nobjects[NODE]; i++)
+        {
+            Xnode[i].active = FALSE;
+            if ( !Xnode[i].converged || Xnode[i].changed )
+                ActiveNodes[count++] = i;
+        }
+        for (j = 0; j < Nobjects[LINK]; j++)
+        {
+            InLinkList[j] = FALSE;
+            Link[j].bypassed = TRUE;
+        }
+    }
+
+    // --- when most nodes changed the worklists would cost more than they
+    //     save, so the next iteration re-solves the whole network
+    if ( count > Nobjects[NODE] / 2 && NumFrozenNodes == 0 )
+    {
+        for (i = 0; i < Nobjects[NODE]; i++) Xnode[i].active = TRUE;
+        findBypassedLinks();
+        InActiveSet = FALSE;
+        return;
+    }
+
+    NumActiveNodes = 0;
+    NumActiveLinks = 0;
+    for (k = 0; k < count; k++) addActiveNode(ActiveNodes[k]);
+
+    // --- the nodes upstream & downstream of a changed node are re-solved
+    //     and so are the links attached to an unconverged node (a link
+    //     whose end nodes have both converged is bypassed as usual)
+    for (k = 0; k < count; k++)
+    {
+        i = ActiveNodes[k];
+        for (m = AdjStart[i]; m < AdjStart[i+1]; m++)
+        {
+            j = AdjLinks[m];
+            if ( !Xnode[i].converged ) Link[j].bypassed = FALSE;
+            n1 = Link[j].node1;
+            if ( n1 == i ) n1 = Link[j].node2;
+            addActiveNode(n1);
+        }
+    }
+
+    // --- the inflow & outflow of every active node is re-summed
+    //     over all of its links
+    for (k = 0; k < NumActiveNodes; k++)
+    {
+        i = ActiveNodes[k];
+        for (m = AdjStart[i]; m < AdjStart[i+1]; m++) addActiveLink(AdjLinks[m]);
+    }
+
+    // --- process the worklists in index order so that results do not
+    //     depend on the order in which they were built
+    qsort(ActiveNodes, NumActiveNodes, sizeof(int), compareIndexes);
+    qsort(ActiveLinks, NumActiveLinks, sizeof(int), compareIndexes);
+    InActiveSet = TRUE;
+}
+
+//=============================================================================
+
+void addActiveNode(int i)
+{
+    if ( Xnode[i].active ) return;
+    Xnode[i].active = TRUE;
+    ActiveNodes[NumActiveNodes++] = i;
+}
+
+//=============================================================================
+
+void addActiveLink(int j)
+{
+    if ( InLinkList[j] ) return;
+    InLinkList[j] = TRUE;
+    ActiveLinks[NumActiveLinks++] = j;
+}
+
+//=============================================================================
+
+int compareIndexes(const void* a, const void* b)
+{
+    return *(const int*)a - *(const int*)b;
+}
+
+//=============================================================================
+
+int  createAdjacency()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: creates the node-link adjacency lists and worklists used
+//           by the active set option.
+//
+{
+    int i, j;
+    int nNodes = Nobjects[NODE];
+    int nLinks = Nobjects[LINK];
+
+    AdjStart = (int *) calloc(nNodes+1, sizeof(int));
+    AdjLinks = (int *) calloc(2*nLinks+1, sizeof(int));
+    ActiveNodes = (int *) calloc(nNodes+1, sizeof(int));
+    ActiveLinks = (int *) calloc(nLinks+1, sizeof(int));
+    InLinkList = (char *) calloc(nLinks+1, sizeof(char));
+    if ( !AdjStart || !AdjLinks || !ActiveNodes || !ActiveLinks ||
+         !InLinkList ) return FALSE;
+
+    // --- count links attached to each node
+    for (j = 0; j < nLinks; j++)
+    {
+        AdjStart[Link[j].node1+1]++;
+        if ( Link[j].node2 != Link[j].node1 ) AdjStart[Link[j].node2+1]++;
+    }
+    for (i = 0; i < nNodes; i++) AdjStart[i+1] += AdjStart[i];
+
+    // --- fill in link indexes (ActiveNodes serves as a fill counter)
+    for (j = 0; j < nLinks; j++)
+    {
+        i = Link[j].node1;
+        AdjLinks[AdjStart[i] + ActiveNodes[i]++] = j;
+        i = Link[j].node2;
+        if ( i == Link[j].node1 ) continue;
+        AdjLinks[AdjStart[i] + ActiveNodes[i]++] = j;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
 void  findLimitedLinks()
 //
 //  Input:   none
@@ -385,28 +628,36 @@ void  findLimitedLinks()
 
 void findLinkFlows(double dt)
 {
-    int i;
+    int i, k;
+    int n = Nobjects[LINK];
+
+    // --- under the active set option only links attached to an
+    //     active node are visited
+    if ( InActiveSet ) n = NumActiveLinks;
 
     // --- find new flow in each non-dummy conduit
 #pragma omp parallel num_threads(NumThreads)
 {
-    #pragma omp for
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    #pragma omp for private(i)
+    for ( k = 0; k < n; k++)
     {
+        i = InActiveSet ? ActiveLinks[k] : k;
         if ( isTrueConduit(i) && !Link[i].bypassed )
             dwflow_findConduitFlow(i, Steps, Omega, dt);
     }
 }
 
     // --- update inflow/outflows for nodes attached to non-dummy conduits
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    for ( k = 0; k < n; k++)
     {
+        i = InActiveSet ? ActiveLinks[k] : k;
         if ( isTrueConduit(i) ) updateNodeFlows(i);
     }
 
     // --- find new flows for all dummy conduits, pumps & regulators
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    for ( k = 0; k < n; k++)
     {
+        i = InActiveSet ? ActiveLinks[k] : k;
         if ( !isTrueConduit(i) )
         {
             if ( !Link[i].bypassed ) findNonConduitFlow(i, dt);
@@ -536,6 +787,9 @@ void updateNodeFlows(int i)
 //  Output:  none
 //  Purpose: updates cumulative inflow & outflow at link's end nodes.
 //
+//  NOTE: under the active set option a link can be attached to a node
+//        that is not being re-solved; that node's totals are left as is.
+//
 {
     int    k;
     int    barrels = 1;
@@ -556,21 +810,24 @@ void updateNodeFlows(int i)
     // --- update total inflow & outflow at upstream/downstream nodes
     if ( q >= 0.0 )
     {
-        Node[n1].outflow += q + uniformLossRate;                               //(5.1.015)
-        Node[n2].inflow  += q;                                                 //(5.1.015)
+        if ( Xnode[n1].active ) Node[n1].outflow += q + uniformLossRate;      //(5.1.015)
+        if ( Xnode[n2].active ) Node[n2].inflow  += q;                        //(5.1.015)
     }
     else
     {
-        Node[n1].inflow   -= q;                                                //(5.1.015)
-        Node[n2].outflow  -= q - uniformLossRate;                              //(5.1.015)
+        if ( Xnode[n1].active ) Node[n1].inflow   -= q;                       //(5.1.015)
+        if ( Xnode[n2].active ) Node[n2].outflow  -= q - uniformLossRate;     //(5.1.015)
     }
 
     // --- add surf. area contributions to upstream/downstream nodes
-    Xnode[Link[i].node1].newSurfArea += Link[i].surfArea1 * barrels;
-    Xnode[Link[i].node2].newSurfArea += Link[i].surfArea2 * barrels;
+    if ( Xnode[n1].active )
+        Xnode[n1].newSurfArea += Link[i].surfArea1 * barrels;
+    if ( Xnode[n2].active )
+        Xnode[n2].newSurfArea += Link[i].surfArea2 * barrels;
 
     // --- update summed value of dqdh at each end node
-    Xnode[Link[i].node1].sumdqdh += Link[i].dqdh;
+    if ( Xnode[n1].active ) Xnode[n1].sumdqdh += Link[i].dqdh;
+    if ( !Xnode[n2].active ) return;
     if ( Link[i].type == PUMP )
     {
         k = Link[i].subIndex;
@@ -586,25 +843,36 @@ void updateNodeFlows(int i)
 
 int findNodeDepths(double dt)
 {
-    int i;
+    int i, k;
+    int n;
     int converged;      // convergence flag
     double yOld;        // previous node depth (ft)
 
     // --- compute outfall depths based on flow in connecting link
-    for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
+    if ( InActiveSet )
+    {
+        for ( k = 0; k < NumActiveLinks; k++ )
+            link_setOutfallDepth(ActiveLinks[k]);
+    }
+    else for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
 
-    // --- compute new depth for all non-outfall nodes and determine if
-    //     depth change from previous iteration is below tolerance
+    // --- compute new depth for all non-outfall nodes (or just the active
+    //     ones) and determine if depth change from previous iteration is
+    //     below tolerance
     converged = TRUE;
+    n = Nobjects[NODE];
+    if ( InActiveSet ) n = NumActiveNodes;
 #pragma omp parallel num_threads(NumThreads)
 {
-    #pragma omp for private(yOld)
-    for ( i = 0; i < Nobjects[NODE]; i++ )
+    #pragma omp for private(i, yOld)
+    for ( k = 0; k < n; k++ )
     {
+        i = InActiveSet ? ActiveNodes[k] : k;
         if ( Node[i].type == OUTFALL ) continue;
         yOld = Node[i].newDepth;
         setNodeDepth(i, dt);
         Xnode[i].converged = TRUE;
+        Xnode[i].changed = (Node[i].newDepth != yOld);
         if ( fabs(yOld - Node[i].newDepth) > HeadTol )
         {
             converged = FALSE;
@@ -473,7 +473,8 @@ enum  CompatibilityType {
     IGNORE_SNOWMELT, IGNORE_GWATER, IGNORE_ROUTING,
     IGNORE_QUALITY, MAX_TRIALS, HEAD_TOL,
     SYS_FLOW_TOL, LAT_FLOW_TOL, IGNORE_RDII,
-    MIN_ROUTE_STEP, NUM_THREADS, SURCHARGE_METHOD};                              //(5.1.013)
+    MIN_ROUTE_STEP, NUM_THREADS, SURCHARGE_METHOD,                               //(5.1.013)
+    ACTIVE_SET, SKIP_STEADY_REGIONS, SKIP_DRY_PERIODS};
 
 enum  NoYesType {
       NO,
@@ -220,6 +220,7 @@ int ErrorCodes[] =
 	  505,    506,    507,    508,    509,    140};                            //(5.1.015)
 
 char  ErrString[256];
+#pragma omp threadprivate(ErrString)   // input lines may be parsed in parallel
 
 char* error_getMsg(int i)
 {
@@ -207,7 +207,8 @@ int  createStorageExfil(int k, double x[])
 //  Output:  returns an error code.
 //  Purpose: creates an exfiltration object for a storage node.
 //
-//  Note: the exfiltration object is freed in project.c.
+//  Note: the exfiltration object is allocated from the project's memory
+//        pool and is released when the project is closed.
 //
 {
     TExfil*   exfil;
@@ -216,16 +217,16 @@ int  createStorageExfil(int k, double x[])
     exfil = Storage[k].exfil;
     if ( exfil == NULL )
     {
-        exfil = (TExfil *) malloc(sizeof(TExfil));
+        exfil = (TExfil *) project_alloc(1, sizeof(TExfil));
         if ( exfil == NULL ) return error_setInpError(ERR_MEMORY, "");
         Storage[k].exfil = exfil;
 
         // --- create Green-Ampt infiltration objects for the bottom & banks
         exfil->btmExfil = NULL;
         exfil->bankExfil = NULL;
-        exfil->btmExfil = (TGrnAmpt *) malloc(sizeof(TGrnAmpt));
+        exfil->btmExfil = (TGrnAmpt *) project_alloc(1, sizeof(TGrnAmpt));
         if ( exfil->btmExfil == NULL ) return error_setInpError(ERR_MEMORY, "");
-        exfil->bankExfil = (TGrnAmpt *) malloc(sizeof(TGrnAmpt));
+        exfil->bankExfil = (TGrnAmpt *) project_alloc(1, sizeof(TGrnAmpt));
         if ( exfil->bankExfil == NULL ) return error_setInpError(ERR_MEMORY, "");
     }
 
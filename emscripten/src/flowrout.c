@@ -35,6 +35,9 @@
 #include "headers.h"
 #include <stdlib.h>
 #include <math.h>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 //-----------------------------------------------------------------------------
 //  Constants
@@ -43,6 +46,12 @@ static const double OMEGA   = 0.55;    // under-relaxation parameter
 static const int    MAXITER = 10;      // max. iterations for storage updating
 static const double STOPTOL = 0.005;   // storage updating stopping tolerance
 
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static int* FailedLink;                // first link of each subtree whose
+                                       // kin. wave routing failed (or -1)
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -60,6 +69,8 @@ static void   initNodes(void);
 static void   initLinks(int routingModel);
 static void   validateTreeLayout(void);      
 static void   validateGeneralLayout(void);
+static int    routeSubtree(int links[], int first, int last, int routingModel,
+              double tStep, int* failedLink);
 static void   updateStorageState(int i, int j, int links[], double dt);
 static double getStorageOutflow(int node, int j, int links[], double dt);
 static double getLinkInflow(int link, double dt);
@@ -95,7 +106,13 @@ void flowrout_init(int routingModel)
     }
 
     // --- validate network layout for kinematic wave routing
-    else validateTreeLayout();
+    //     and allocate room to record a routing failure in each subtree
+    else
+    {
+        validateTreeLayout();
+        FailedLink = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+        if ( FailedLink == NULL ) report_writeErrorMsg(ERR_MEMORY, "");
+    }
 
     // --- initialize node & link volumes
     initNodes();
@@ -112,6 +129,7 @@ void  flowrout_close(int routingModel)
 //
 {
     if ( routingModel == DW ) dynwave_close();
+    FREE(FailedLink);
 }
 
 //=============================================================================
@@ -133,25 +151,28 @@ double flowrout_getRoutingStep(int routingModel, double fixedStep)
 
 //=============================================================================
 
-int flowrout_execute(int links[], int routingModel, double tStep)
+int flowrout_execute(int links[], int treeStart[], int nTrees,
+                     int routingModel, double tStep)
 //
 //  Input:   links = array of link indexes in topo-sorted order
+//           treeStart = position in links where each independent
+//                       subtree begins
+//           nTrees = number of independent subtrees
 //           routingModel = type of routing method used
 //           tStep = routing time step (sec)
 //  Output:  returns number of computational steps taken
 //  Purpose: routes flow through conveyance network over current time step.
 //
 {
-    int   i, j;
-    int   n1;                          // upstream node of link
-    double qin;                        // link inflow (cfs)
-    double qout;                       // link outflow (cfs)
+    int   j, k;
     double steps;                      // computational step count
 
     // --- set overflows to drain any ponded water
+    //     (nodes & links in frozen steady state regions are left as is)
     if ( ErrorCode ) return 0;
     for (j = 0; j < Nobjects[NODE]; j++)
     {
+        if ( Node[j].frozen ) continue;
         Node[j].updated = FALSE;
         Node[j].overflow = 0.0;
         if ( Node[j].type != STORAGE
@@ -167,12 +188,68 @@ int flowrout_execute(int links[], int routingModel, double tStep)
         return dynwave_execute(tStep);
     }
 
-    // --- otherwise examine each link, moving from upstream to downstream
+    // --- otherwise route each subtree of links, moving from upstream
+    //     to downstream (subtrees share no nodes so they can be routed
+    //     in parallel)
     steps = 0.0;
-    for (i = 0; i < Nobjects[LINK]; i++)
+#pragma omp parallel for num_threads(NumThreads) schedule(dynamic) \
+    reduction(+:steps) if(nTrees > 1)
+    for (k = 0; k < nTrees; k++)
+    {
+        steps += routeSubtree(links, treeStart[k], treeStart[k+1],
+                              routingModel, tStep, &FailedLink[k]);
+    }
+    if ( Nobjects[LINK] > 0 ) steps /= Nobjects[LINK];
+
+    // --- report any link whose flow could not be routed
+    //     (done here since subtrees may have been routed in parallel)
+    for (k = 0; k < nTrees; k++)
+    {
+        if ( FailedLink[k] >= 0 )
+            report_writeErrorMsg(ERR_KINWAVE, Link[FailedLink[k]].ID);
+    }
+
+    // --- update state of each non-updated node and link
+    for ( j=0; j<Nobjects[NODE]; j++)
+    {
+        if ( !Node[j].frozen ) setNewNodeState(j, tStep);
+    }
+    for ( j=0; j<Nobjects[LINK]; j++)
+    {
+        if ( !Link[j].frozen ) setNewLinkState(j);
+    }
+    return (int)(steps+0.5);
+}
+
+//=============================================================================
+
+int routeSubtree(int links[], int first, int last, int routingModel,
+                 double tStep, int* failedLink)
+//
+//  Input:   links = array of link indexes in topo-sorted order
+//           first = position in links of subtree's first link
+//           last = position in links just past subtree's last link
+//           routingModel = type of routing method used
+//           tStep = routing time step (sec)
+//  Output:  failedLink = first link whose flow could not be routed (or -1);
+//           returns number of computational steps taken
+//  Purpose: routes flow through an independent subtree of the conveyance
+//           network under Steady or Kin. Wave routing.
+//
+{
+    int   i, j;
+    int   n1;                          // upstream node of link
+    int   n;                           // link's computational step count
+    int   steps = 0;                   // computational step count
+    double qin;                        // link inflow (cfs)
+    double qout;                       // link outflow (cfs)
+
+    *failedLink = -1;
+    for (i = first; i < last; i++)
     {
         // --- see if upstream node is a storage unit whose state needs updating
         j = links[i];
+        if ( Link[j].frozen ) continue;
         n1 = Link[j].node1;
         if ( Node[n1].type == STORAGE ) updateStorageState(n1, i, links, tStep);
 
@@ -181,20 +258,21 @@ int flowrout_execute(int links[], int routingModel, double tStep)
 
         // route flow through link
         if ( routingModel == SF )
-            steps += steadyflow_execute(j, &qin, &qout, tStep);
-        else steps += kinwave_execute(j, &qin, &qout, tStep);
+            n = steadyflow_execute(j, &qin, &qout, tStep);
+        else n = kinwave_execute(j, &qin, &qout, tStep);
+        if ( n < 0 )
+        {
+            if ( *failedLink < 0 ) *failedLink = j;
+            n = 1;
+        }
+        steps += n;
         Link[j].newFlow = qout;
 
         // adjust outflow at upstream node and inflow at downstream node
         Node[ Link[j].node1 ].outflow += qin;
         Node[ Link[j].node2 ].inflow += qout;
     }
-    if ( Nobjects[LINK] > 0 ) steps /= Nobjects[LINK];
-
-    // --- update state of each non-updated node and link
-    for ( j=0; j<Nobjects[NODE]; j++) setNewNodeState(j, tStep);
-    for ( j=0; j<Nobjects[LINK]; j++) setNewLinkState(j);
-    return (int)(steps+0.5);
+    return steps;
 }
 
 //=============================================================================
@@ -48,6 +48,7 @@ int      project_init(void);
 int      project_addObject(int type, char* id, int n);
 int      project_findObject(int type, char* id);
 char*    project_findID(int type, char* id);
+void*    project_alloc(int n, int size);
 
 double** project_createMatrix(int nrows, int ncols);
 void     project_freeMatrix(double** m);
@@ -57,6 +58,7 @@ void     project_freeMatrix(double** m);
 //-----------------------------------------------------------------------------
 int     input_countObjects(void);
 int     input_readData(void);
+void    input_saveSnapshot(void);
 
 //-----------------------------------------------------------------------------
 //   Report Writer Methods
@@ -108,12 +110,15 @@ void     climate_openFile(void);
 void     climate_initState(void);
 void     climate_setState(DateTime aDate);
 DateTime climate_getNextEvapDate(void);
+void     climate_close(void);
 
 //-----------------------------------------------------------------------------
 //   Rainfall Processing Methods
 //-----------------------------------------------------------------------------
 void    rain_open(void);
 void    rain_close(void);
+int     rain_readRecord(int gage, DateTime* date, float* value);
+long    rain_findRecord(int gage, DateTime aDate);
 
 //-----------------------------------------------------------------------------
 //   Snowmelt Processing Methods
@@ -130,8 +135,9 @@ void    snow_setState(int subcatch, int subArea, double x[]);
 
 void    snow_setMeltCoeffs(int snowIndex, double season);
 void    snow_plowSnow(int subcatch, double tStep);
+double  snow_getRainmelt(double rainfall);
 double  snow_getSnowMelt(int subcatch, double rainfall, double snowfall,
-        double tStep, double netPrecip[]);
+        double rmelt, double tStep, double netPrecip[]);
 double  snow_getSnowCover(int subcatch);
 
 //-----------------------------------------------------------------------------
@@ -174,12 +180,15 @@ void    gwater_deleteFlowExpression(int subcatch);
 void    gwater_validateAquifer(int aquifer);
 void    gwater_validate(int subcatch);
 
+int     gwater_open(void);
+void    gwater_close(void);
 void    gwater_initState(int subcatch);
 void    gwater_getState(int subcatch, double x[]);
 void    gwater_setState(int subcatch, double x[]);
 
-void    gwater_getGroundwater(int subcatch, double evap, double infil,
+void    gwater_setInflow(int subcatch, double evap, double infil,
         double tStep);
+void    gwater_getGroundwater(double tStep);
 double  gwater_getVolume(int subcatch);
 
 //-----------------------------------------------------------------------------
@@ -202,13 +211,17 @@ int     landuse_readPollutParams(int pollut, char* tok[], int ntoks);
 int     landuse_readBuildupParams(char* tok[], int ntoks);
 int     landuse_readWashoffParams(char* tok[], int ntoks);
 
+void    landuse_validate(int landuse);
 void    landuse_getInitBuildup(TLandFactor* landFactor,  double* initBuildup,
 	    double area, double curb);
 double  landuse_getBuildup(int landuse, int pollut, double area, double curb,
         double buildup, double tStep);
+void    landuse_addBuildup(int landuse, double area, double curb, int hasSnow,
+        double buildup[], double tStep);
 
-double  landuse_getWashoffLoad(int landuse, int p, double area,
-        TLandFactor landFactor[], double runoff, double vOutflow);
+void    landuse_getWashoffLoads(int landuse, double area,
+        TLandFactor landFactor[], double runoff, double vOutflow,
+        double load[]);
 double  landuse_getAvgBmpEffic(int j, int p);
 double  landuse_getCoPollutLoad(int p, double washoff[]);
 
@@ -218,9 +231,12 @@ double  landuse_getCoPollutLoad(int p, double washoff[]);
 void    flowrout_init(int routingModel);
 void    flowrout_close(int routingModel);
 double  flowrout_getRoutingStep(int routingModel, double fixedStep);
-int     flowrout_execute(int links[], int routingModel, double tStep);
+int     flowrout_execute(int links[], int treeStart[], int nTrees,
+        int routingModel, double tStep);
 
-void    toposort_sortLinks(int links[]);
+int     toposort_sortLinks(int links[], int treeStart[]);
+int     toposort_findTreeRoot(int parent[], int i);
+void    toposort_close(void);
 int     kinwave_execute(int link, double* qin, double* qout, double tStep);
 
 void    dynwave_validate(void);
@@ -230,6 +246,8 @@ double  dynwave_getRoutingStep(double fixedStep);
 int     dynwave_execute(double tStep);
 void    dwflow_findConduitFlow(int j, int steps, double omega, double dt);
 
+int     qualrout_open(void);
+void    qualrout_close(void);
 void    qualrout_init(void);
 void    qualrout_execute(double tStep);
 
@@ -316,8 +334,13 @@ double  subcatch_getFracPerv(int subcatch);
 double  subcatch_getStorage(int subcatch);
 double  subcatch_getDepth(int subcatch);
 
+int     subcatch_openRunon(void);
+void    subcatch_closeRunon(void);
 void    subcatch_getRunon(int subcatch);
 void    subcatch_addRunonFlow(int subcatch, double flow);
+void    subcatch_getNetPrecip(int subcatch, double rainfall, double snowfall,
+        double rmelt, double tStep);
+void    subcatch_getNonLidRunoff(int subcatch, double tStep);
 double  subcatch_getRunoff(int subcatch, double tStep);
 
 double  subcatch_getWtdOutflow(int subcatch, double wt);
@@ -505,6 +528,7 @@ double  table_getInverseArea(TTable* table, double a);
 
 void    table_tseriesInit(TTable *table);
 double  table_tseriesLookup(TTable* table, double t, char extend);
+int     table_writeStore(char* textFile, char* storeFile);
 
 //-----------------------------------------------------------------------------
 //   Utility Methods
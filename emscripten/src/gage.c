@@ -45,6 +45,7 @@ static int    readGageSeriesFormat(char* tok[], int ntoks, double x[]);
 static int    readGageFileFormat(char* tok[], int ntoks, double x[]);
 static int    getFirstRainfall(int gage);
 static int    getNextRainfall(int gage);
+static void   skipRainRecords(int gage, DateTime aDate);
 static double convertRainfall(int gage, double rain);
 
 
@@ -340,7 +341,9 @@ void gage_setState(int j, DateTime t)
     }
 
     // --- otherwise march through rainfall record until date t is bracketed
+    //     (jumping directly over rain file records that end before t)
     t += OneSecond;
+    if ( Gage[j].dataSource == RAIN_FILE ) skipRainRecords(j, t);
     for (;;)
     {
         // --- no rainfall if no interval start date
@@ -483,14 +486,10 @@ int getFirstRainfall(int j)
     // --- use rain interface file if applicable
     if ( Gage[j].dataSource == RAIN_FILE )
     {
-        if ( Frain.file && Gage[j].endFilePos > Gage[j].startFilePos )
+        // --- retrieve 1st date & rainfall volume from file
+        Gage[j].currentFilePos = Gage[j].startFilePos;
+        if ( rain_readRecord(j, &Gage[j].startDate, &vFirst) )
         {
-            // --- retrieve 1st date & rainfall volume from file
-            fseek(Frain.file, Gage[j].startFilePos, SEEK_SET);
-            fread(&Gage[j].startDate, sizeof(DateTime), 1, Frain.file);
-            fread(&vFirst, sizeof(float), 1, Frain.file);
-            Gage[j].currentFilePos = ftell(Frain.file);
-
             // --- convert rainfall to intensity
             Gage[j].rainfall = convertRainfall(j, (double)vFirst);
             return 1;
@@ -540,12 +539,8 @@ int getNextRainfall(int j)
     {
         if ( Gage[j].dataSource == RAIN_FILE )
         {
-            if ( Frain.file && Gage[j].currentFilePos < Gage[j].endFilePos )
+            if ( rain_readRecord(j, &Gage[j].nextDate, &vNext) )
             {
-                fseek(Frain.file, Gage[j].currentFilePos, SEEK_SET);
-                fread(&Gage[j].nextDate, sizeof(DateTime), 1, Frain.file);
-                fread(&vNext, sizeof(float), 1, Frain.file);
-                Gage[j].currentFilePos = ftell(Frain.file);
                 rNext = convertRainfall(j, (double)vNext);
             }
             else return 0;
@@ -569,6 +564,46 @@ int getNextRainfall(int j)
 
 //=============================================================================
 
+void skipRainRecords(int j, DateTime t)
+//
+//  Input:   j = rain gage index
+//           t = a calendar date/time
+//  Output:  none
+//  Purpose: moves a rain file gage's current rainfall interval directly
+//           ahead to the last one that ends by date t.
+//
+//  NOTE: this is the same interval that marching one record at a time
+//        through the file would pass through, so gage_setState continues
+//        on from it with the same results.
+//
+{
+    long     pos;
+    DateTime date;
+    float    v;
+
+    // --- the march must get past both the current and the next interval
+    if ( Gage[j].startDate == NO_DATE || Gage[j].nextDate == NO_DATE ) return;
+    if ( t < Gage[j].endDate || t < Gage[j].nextDate ) return;
+
+    // --- skipping relies on only zero-depth records converting to zero
+    if ( Gage[j].rainInterval <= 0 ||
+         Gage[j].unitsFactor * Adjust.rainFactor == 0.0 ) return;
+
+    // --- find last record with non-zero rainfall ending by t
+    pos = rain_findRecord(j, t);
+    if ( pos < 0 ) return;
+
+    // --- make it the current rainfall interval
+    Gage[j].currentFilePos = pos;
+    if ( !rain_readRecord(j, &date, &v) ) return;
+    Gage[j].startDate = date;
+    Gage[j].endDate = datetime_addSeconds(date, Gage[j].rainInterval);
+    Gage[j].rainfall = convertRainfall(j, (double)v);
+    if ( !getNextRainfall(j) ) Gage[j].nextDate = NO_DATE;
+}
+
+//=============================================================================
+
 double convertRainfall(int j, double r)
 //
 //  Input:   j = rain gage index
@@ -56,7 +56,8 @@ EXTERN TFile
                   Fhotstart1,               // Hot start input file
                   Fhotstart2,               // Hot start output file
                   Finflows,                 // Inflows routing file
-                  Foutflows;                // Outflows routing file
+                  Foutflows,                // Outflows routing file
+                  Fsnapshot;                // Compiled input snapshot file
 
 EXTERN long
                   Nperiods,                 // Number of reporting periods
@@ -90,6 +91,9 @@ EXTERN int
                   SlopeWeighting,           // Use slope weighting
                   Compatibility,            // SWMM 5/3/4 compatibility
                   SkipSteadyState,          // Skip over steady state periods
+                  ActiveSet,                // Re-solve only unconverged DW nodes
+                  SkipSteadyRegions,        // Skip steady parts of the network
+                  SkipDryPeriods,           // Cross dry periods in one runoff step
                   IgnoreRainfall,           // Ignore rainfall/runoff
                   IgnoreRDII,               // Ignore RDII
                   IgnoreSnowmelt,           // Ignore snowmelt
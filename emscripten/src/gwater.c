@@ -24,6 +24,10 @@
 //   Build 5.1.010:
 //   - Unsaturated hydraulic conductivity added to GW flow equation variables.
 //
+//   The state of each aquifer being updated is kept in its own TGWState
+//   record so that all aquifers can be integrated together, in batches of
+//   ODE solver lanes that are spread across threads.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -33,6 +37,10 @@
 #include "headers.h"
 #include "odesolve.h"
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 //-----------------------------------------------------------------------------
 //  Constants
 //-----------------------------------------------------------------------------
@@ -61,33 +69,48 @@ static char* GWVarWords[] = {"HGW", "HSW", "HCB", "HGS", "KS", "K",
                              "THETA", "PHI", "FI", "FU", "A", NULL};
 
 //-----------------------------------------------------------------------------
-//  Shared variables
+//  Data Structures
 //-----------------------------------------------------------------------------
 //  NOTE: all flux rates are in ft/sec, all depths are in ft.
-static double    Area;            // subcatchment area (ft2)
-static double    Infil;           // infiltration rate from surface
-static double    MaxEvap;         // max. evaporation rate
-static double    AvailEvap;       // available evaporation rate
-static double    UpperEvap;       // evaporation rate from upper GW zone
-static double    LowerEvap;       // evaporation rate from lower GW zone
-static double    UpperPerc;       // percolation rate from upper to lower zone
-static double    LowerLoss;       // loss rate from lower GW zone
-static double    GWFlow;          // flow rate from lower zone to conveyance node
-static double    MaxUpperPerc;    // upper limit on UpperPerc
-static double    MaxGWFlowPos;    // upper limit on GWFlow when its positve
-static double    MaxGWFlowNeg;    // upper limit on GWFlow when its negative
-static double    FracPerv;        // fraction of surface that is pervious
-static double    TotalDepth;      // total depth of GW aquifer
-static double    Theta;           // moisture content of upper zone
-static double    HydCon;          // unsaturated hydraulic conductivity (ft/s)
-static double    Hgw;             // ht. of saturated zone
-static double    Hstar;           // ht. from aquifer bottom to node invert
-static double    Hsw;             // ht. from aquifer bottom to water surface
-static double    Tstep;           // current time step (sec)
-static TAquifer  A;               // aquifer being analyzed
-static TGroundwater* GW;          // groundwater object being analyzed
-static MathExpr* LatFlowExpr;     // user-supplied lateral GW flow expression
-static MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
+typedef struct
+{
+    int           subcatch;       // subcatchment index
+    TGroundwater* gw;             // groundwater object being analyzed
+    TAquifer*     a;              // aquifer being analyzed
+    MathExpr*     latFlowExpr;    // user-supplied lateral GW flow expression
+    MathExpr*     deepFlowExpr;   // user-supplied deep GW flow expression
+    double        area;           // subcatchment area (ft2)
+    double        infil;          // infiltration rate from surface
+    double        maxEvap;        // max. evaporation rate
+    double        availEvap;      // available evaporation rate
+    double        upperEvap;      // evaporation rate from upper GW zone
+    double        lowerEvap;      // evaporation rate from lower GW zone
+    double        upperPerc;      // percolation rate from upper to lower zone
+    double        lowerLoss;      // loss rate from lower GW zone
+    double        gwFlow;         // flow rate from lower zone to conveyance node
+    double        maxUpperPerc;   // upper limit on upperPerc
+    double        maxGWFlowPos;   // upper limit on gwFlow when its positve
+    double        maxGWFlowNeg;   // upper limit on gwFlow when its negative
+    double        fracPerv;       // fraction of surface that is pervious
+    double        totalDepth;     // total depth of GW aquifer
+    double        theta;          // moisture content of upper zone
+    double        hydCon;         // unsaturated hydraulic conductivity (ft/s)
+    double        hgw;            // ht. of saturated zone
+    double        hstar;          // ht. from aquifer bottom to node invert
+    double        hsw;            // ht. from aquifer bottom to water surface
+    double        tstep;          // current time step (sec)
+    double        avgFlow;        // avg. GW flow over runoff time step
+}  TGWState;
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static int       NumStates;       // number of aquifers to be updated
+static TGWState* GWState;         // state of each aquifer to be updated
+static double*   GWx;             // upper moisture & lower depth of each one
+static TGWState* Batch;           // aquifers being integrated by a thread
+static TGWState* Cur;             // aquifer whose flow eqn. is evaluated
+#pragma omp threadprivate(Batch, Cur)
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -98,21 +121,26 @@ static MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
 //  gwater_deleteFlowExpression  (called by deleteObjects in project.c)
 //  gwater_validateAquifer       (called by swmm_open)
 //  gwater_validate              (called by subcatch_validate) 
+//  gwater_open                  (called by runoff_open)
+//  gwater_close                 (called by runoff_close)
 //  gwater_initState             (called by subcatch_initState)
 //  gwater_getVolume             (called by massbal_open & massbal_getGwaterError)
-//  gwater_getGroundwater        (called by getSubareaRunoff in subcatch.c)
+//  gwater_setInflow             (called by subcatch_getRunoff)
+//  gwater_getGroundwater        (called by runoff_execute)
 //  gwater_getState              (called by saveRunoff in hotstart.c)
 //  gwater_setState              (called by readRunoff in hotstart.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
-static void   getDxDt(double t, double* x, double* dxdt);
-static void   getFluxes(double upperVolume, double lowerDepth);
-static void   getEvapRates(double theta, double upperDepth);
-static double getUpperPerc(double theta, double upperDepth);
-static double getGWFlow(double lowerDepth);
-static void   updateMassBal(double area,  double tStep);
+static void   getDxDt(int k, double t, double* x, double* dxdt);
+static void   getFluxes(TGWState* s, double upperVolume, double lowerDepth);
+static void   getEvapRates(TGWState* s, double theta, double upperDepth);
+static double getUpperPerc(TGWState* s, double theta, double upperDepth);
+static double getGWFlow(TGWState* s, double lowerDepth);
+static void   setFlowLimits(TGWState* s, double* x, double tStep);
+static void   updateState(TGWState* s, double* x);
+static void   updateMassBal(TGWState* s, double area,  double tStep);
 
 // Used to process custom GW outflow equations
 static int    getVariableIndex(char* s);
@@ -234,7 +262,7 @@ int gwater_readGroundwaterParams(char* tok[], int ntoks)
     // --- create a groundwater flow object
     if ( !Subcatch[j].groundwater )
     {
-        gw = (TGroundwater *) malloc(sizeof(TGroundwater));
+        gw = (TGroundwater *) project_alloc(1, sizeof(TGroundwater));
         if ( !gw ) return error_setInpError(ERR_MEMORY, "");
         Subcatch[j].groundwater = gw;
     }
@@ -306,7 +334,12 @@ int gwater_readFlowExpression(char* tok[], int ntoks)
     //     (getVariableIndex is the function that converts a GW
     //      variable's name into an index number) 
     expr = mathexpr_create(exprStr, getVariableIndex);
-    if ( expr == NULL ) return error_setInpError(ERR_TREATMENT_EXPR, "");
+    if ( expr == NULL )
+    {
+        if ( mathexpr_getError() == MATHEXPR_MEMORY_ERR )
+            return error_setInpError(ERR_MEMORY, "");
+        return error_setInpError(ERR_TREATMENT_EXPR, "");
+    }
 
     // --- save expression tree with the subcatchment
     if ( k == 1 ) Subcatch[j].gwLatFlowExpr = expr;
@@ -478,9 +511,46 @@ double gwater_getVolume(int j)
 
 //=============================================================================
 
-void gwater_getGroundwater(int j, double evap, double infil, double tStep)
+int gwater_open()
+//
+//  Input:   none
+//  Output:  returns an error code
+//  Purpose: allocates the arrays that hold the state of each aquifer
+//           while groundwater is updated.
 //
-//  Purpose: computes groundwater flow from subcatchment during current time step.
+{
+    int n = Nobjects[SUBCATCH];
+
+    NumStates = 0;
+    GWState = NULL;
+    GWx = NULL;
+    if ( n == 0 ) return 0;
+    GWState = (TGWState *) calloc(n, sizeof(TGWState));
+    GWx = (double *) calloc(2*n, sizeof(double));
+    if ( !GWState || !GWx ) report_writeErrorMsg(ERR_MEMORY, "");
+    return ErrorCode;
+}
+
+//=============================================================================
+
+void gwater_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the arrays that hold the state of each aquifer.
+//
+{
+    FREE(GWState);
+    FREE(GWx);
+    NumStates = 0;
+}
+
+//=============================================================================
+
+void gwater_setInflow(int j, double evap, double infil, double tStep)
+//
+//  Purpose: saves the surface fluxes into a subcatchment's aquifer and
+//           prepares it to be updated by gwater_getGroundwater.
 //  Input:   j     = subcatchment index
 //           evap  = pervious surface evaporation volume consumed (ft3)
 //           infil = surface infiltration volume (ft3)
@@ -489,126 +559,234 @@ void gwater_getGroundwater(int j, double evap, double infil, double tStep)
 //
 {
     int    n;                          // node exchanging groundwater
-    double x[2];                       // upper moisture content & lower depth 
-    double vUpper;                     // upper vol. available for percolation
-    double nodeFlow;                   // max. possible GW flow from node
+    double *x;                         // upper moisture content & lower depth 
+    TGWState* s;                       // state of the aquifer
+    TGroundwater* gw;
+    TAquifer* a;
 
-    // --- save subcatchment's groundwater and aquifer objects to 
-    //     shared variables
-    GW = Subcatch[j].groundwater;
-    if ( GW == NULL ) return;
-    LatFlowExpr = Subcatch[j].gwLatFlowExpr;
-    DeepFlowExpr = Subcatch[j].gwDeepFlowExpr;
-    A = Aquifer[GW->aquifer];
+    // --- save subcatchment's groundwater and aquifer objects
+    gw = Subcatch[j].groundwater;
+    if ( gw == NULL || GWState == NULL ) return;
+    s = &GWState[NumStates];
+    x = &GWx[2*NumStates];
+    s->subcatch = j;
+    s->gw = gw;
+    s->latFlowExpr = Subcatch[j].gwLatFlowExpr;
+    s->deepFlowExpr = Subcatch[j].gwDeepFlowExpr;
+    a = &Aquifer[gw->aquifer];
+    s->a = a;
 
     // --- get fraction of total area that is pervious
-    FracPerv = subcatch_getFracPerv(j);
-    if ( FracPerv <= 0.0 ) return;
-    Area = Subcatch[j].area;
+    s->fracPerv = subcatch_getFracPerv(j);
+    if ( s->fracPerv <= 0.0 ) return;
+    s->area = Subcatch[j].area;
 
     // --- convert infiltration volume (ft3) to equivalent rate
     //     over entire GW (subcatchment) area
-    infil = infil / Area / tStep;
-    Infil = infil;
-    Tstep = tStep;
+    infil = infil / s->area / tStep;
+    s->infil = infil;
 
     // --- convert pervious surface evaporation already exerted (ft3)
     //     to equivalent rate over entire GW (subcatchment) area
-    evap = evap / Area / tStep;
+    evap = evap / s->area / tStep;
 
     // --- convert max. surface evap rate (ft/sec) to a rate
     //     that applies to GW evap (GW evap can only occur
     //     through the pervious land surface area)
-    MaxEvap = Evap.rate * FracPerv;
+    s->maxEvap = Evap.rate * s->fracPerv;
 
     // --- available subsurface evaporation is difference between max.
     //     rate and pervious surface evap already exerted
-    AvailEvap = MAX((MaxEvap - evap), 0.0);
+    s->availEvap = MAX((s->maxEvap - evap), 0.0);
 
-    // --- save total depth & outlet node properties to shared variables
-    TotalDepth = GW->surfElev - GW->bottomElev;
-    if ( TotalDepth <= 0.0 ) return;
-    n = GW->node;
+    // --- save total depth & outlet node properties
+    s->totalDepth = gw->surfElev - gw->bottomElev;
+    if ( s->totalDepth <= 0.0 ) return;
+    n = gw->node;
 
     // --- establish min. water table height above aquifer bottom at which
     //     GW flow can occur (override node's invert if a value was provided
     //     in the GW object)
-    if ( GW->nodeElev != MISSING ) Hstar = GW->nodeElev - GW->bottomElev;
-    else Hstar = Node[n].invertElev - GW->bottomElev;
+    if ( gw->nodeElev != MISSING ) s->hstar = gw->nodeElev - gw->bottomElev;
+    else s->hstar = Node[n].invertElev - gw->bottomElev;
     
     // --- establish surface water height (relative to aquifer bottom)
     //     for drainage system node connected to the GW aquifer
-    if ( GW->fixedDepth > 0.0 )
+    if ( gw->fixedDepth > 0.0 )
     {
-        Hsw = GW->fixedDepth + Node[n].invertElev - GW->bottomElev;
+        s->hsw = gw->fixedDepth + Node[n].invertElev - gw->bottomElev;
     }
-    else Hsw = Node[n].newDepth + Node[n].invertElev - GW->bottomElev;
+    else s->hsw = Node[n].newDepth + Node[n].invertElev - gw->bottomElev;
 
     // --- store state variables (upper zone moisture content, lower zone
     //     depth) in work vector x
-    x[THETA] = GW->theta;
-    x[LOWERDEPTH] = GW->lowerDepth;
+    x[THETA] = gw->theta;
+    x[LOWERDEPTH] = gw->lowerDepth;
+
+    // --- set limits on percolation and GW flow over the time step
+    setFlowLimits(s, x, tStep);
+
+    // --- add aquifer to those being updated
+    NumStates++;
+}
+
+//=============================================================================
+
+void setFlowLimits(TGWState* s, double* x, double tStep)
+//
+//  Input:   s     = state of an aquifer
+//           x     = upper moisture content & lower depth of the aquifer
+//           tStep = time step (sec)
+//  Output:  none
+//  Purpose: sets limits on the aquifer's percolation and GW flow rates
+//           that keep it from being over-drained within a time step.
+//
+{
+    int    n = s->gw->node;            // node exchanging groundwater
+    double vUpper;                     // upper vol. available for percolation
+    double nodeFlow;                   // max. possible GW flow from node
+    TAquifer* a = s->a;
+
+    s->tstep = tStep;
 
     // --- set limit on percolation rate from upper to lower GW zone
-    vUpper = (TotalDepth - x[LOWERDEPTH]) * (x[THETA] - A.fieldCapacity);
+    vUpper = (s->totalDepth - x[LOWERDEPTH]) * (x[THETA] - a->fieldCapacity);
     vUpper = MAX(0.0, vUpper); 
-    MaxUpperPerc = vUpper / tStep;
+    s->maxUpperPerc = vUpper / tStep;
 
     // --- set limit on GW flow out of aquifer based on volume of lower zone
-    MaxGWFlowPos = x[LOWERDEPTH]*A.porosity / tStep;
+    s->maxGWFlowPos = x[LOWERDEPTH]*a->porosity / tStep;
 
     // --- set limit on GW flow into aquifer from drainage system node
     //     based on min. of capacity of upper zone and drainage system
     //     inflow to the node
-    MaxGWFlowNeg = (TotalDepth - x[LOWERDEPTH]) * (A.porosity - x[THETA])
-                   / tStep;
-    nodeFlow = (Node[n].inflow + Node[n].newVolume/tStep) / Area;
-    MaxGWFlowNeg = -MIN(MaxGWFlowNeg, nodeFlow);
-    
-    // --- integrate eqns. for d(Theta)/dt and d(LowerDepth)/dt
-    //     NOTE: ODE solver must have been initialized previously
-    odesolve_integrate(x, 2, 0, tStep, GWTOL, tStep, getDxDt);
-    
+    s->maxGWFlowNeg = (s->totalDepth - x[LOWERDEPTH]) *
+                      (a->porosity - x[THETA]) / tStep;
+    nodeFlow = (Node[n].inflow + Node[n].newVolume/tStep) / s->area;
+    s->maxGWFlowNeg = -MIN(s->maxGWFlowNeg, nodeFlow);
+}
+
+//=============================================================================
+
+void gwater_getGroundwater(double tStep)
+//
+//  Purpose: computes groundwater flow during current time step from each
+//           subcatchment prepared by gwater_setInflow.
+//  Input:   tStep = time step (sec)
+//  Output:  none
+//
+//  Note:    aquifers are integrated in batches of up to ODE_MAXLANES at a
+//           time, with batches spread across threads; mass balance totals
+//           are then updated in subcatchment order.
+//
+//           A runoff time step longer than the dry weather step (as taken
+//           by the SKIP_DRY_PERIODS option) is split into sub-steps no
+//           longer than the dry step, so that the percolation and GW flow
+//           limits held fixed over each step follow the aquifer's recession.
+{
+    int    i, j, k, b, m;
+    int    nBatches = (NumStates + ODE_MAXLANES - 1) / ODE_MAXLANES;
+    int    nSteps = 1;
+    double dt = tStep;
+
+    if ( tStep > DryStep && DryStep > 0 )
+    {
+        nSteps = (int)ceil(tStep / DryStep);
+        dt = tStep / nSteps;
+    }
+    for (k = 0; k < NumStates; k++) GWState[k].avgFlow = 0.0;
+
+    for (i = 0; i < nSteps; i++)
+    {
+        // --- integrate eqns. for d(Theta)/dt and d(LowerDepth)/dt
+        //     NOTE: ODE solver must have been initialized previously
+#pragma omp parallel for private(j, k, m) num_threads(NumThreads) \
+    schedule(dynamic) if(nBatches > 1)
+        for (b = 0; b < nBatches; b++)
+        {
+            k = b * ODE_MAXLANES;
+            m = MIN(ODE_MAXLANES, NumStates - k);
+            if ( nSteps > 1 ) for (j = k; j < k + m; j++)
+            {
+                setFlowLimits(&GWState[j], &GWx[2*j], dt);
+            }
+            Batch = &GWState[k];
+            odesolve_integrateBatch(&GWx[2*k], m, 2, 0, dt, GWTOL, dt,
+                                    getDxDt);
+            for (; m > 0; m--, k++) updateState(&GWState[k], &GWx[2*k]);
+        }
+
+        // --- update GW mass balance
+        for (k = 0; k < NumStates; k++)
+        {
+            updateMassBal(&GWState[k], GWState[k].area, dt);
+            GWState[k].avgFlow += 0.5 * (GWState[k].gw->oldFlow +
+                                  GWState[k].gw->newFlow) / nSteps;
+        }
+    }
+
+    // --- GW inflow to the drainage system is interpolated linearly over
+    //     the whole runoff time step, so pick the flow it starts from to
+    //     deliver the same volume as the sub-steps did
+    if ( nSteps > 1 ) for (k = 0; k < NumStates; k++)
+    {
+        GWState[k].gw->oldFlow = 2.0*GWState[k].avgFlow -
+                                 GWState[k].gw->newFlow;
+    }
+    NumStates = 0;
+}
+
+//=============================================================================
+
+void updateState(TGWState* s, double* x)
+//
+//  Input:   s = state of an aquifer
+//           x = upper moisture content & lower depth after integration
+//  Output:  none
+//  Purpose: saves the new state and fluxes of an aquifer.
+//
+{
+    TGroundwater* gw = s->gw;
+    TAquifer* a = s->a;
+
     // --- keep state variables within allowable bounds
-    x[THETA] = MAX(x[THETA], A.wiltingPoint);
-    if ( x[THETA] >= A.porosity )
+    x[THETA] = MAX(x[THETA], a->wiltingPoint);
+    if ( x[THETA] >= a->porosity )
     {
-        x[THETA] = A.porosity - XTOL;
-        x[LOWERDEPTH] = TotalDepth - XTOL;
+        x[THETA] = a->porosity - XTOL;
+        x[LOWERDEPTH] = s->totalDepth - XTOL;
     }
     x[LOWERDEPTH] = MAX(x[LOWERDEPTH],  0.0);
-    if ( x[LOWERDEPTH] >= TotalDepth )
+    if ( x[LOWERDEPTH] >= s->totalDepth )
     {
-        x[LOWERDEPTH] = TotalDepth - XTOL;
+        x[LOWERDEPTH] = s->totalDepth - XTOL;
     }
 
     // --- save new values of state values
-    GW->theta = x[THETA];
-    GW->lowerDepth  = x[LOWERDEPTH];
-    getFluxes(GW->theta, GW->lowerDepth);
-    GW->oldFlow = GW->newFlow;
-    GW->newFlow = GWFlow;
-    GW->evapLoss = UpperEvap + LowerEvap;
+    gw->theta = x[THETA];
+    gw->lowerDepth  = x[LOWERDEPTH];
+    getFluxes(s, gw->theta, gw->lowerDepth);
+    gw->oldFlow = gw->newFlow;
+    gw->newFlow = s->gwFlow;
+    gw->evapLoss = s->upperEvap + s->lowerEvap;
 
     //--- find max. infiltration volume (as depth over
     //    the pervious portion of the subcatchment)
     //    that upper zone can support in next time step
-    GW->maxInfilVol = (TotalDepth - x[LOWERDEPTH]) *
-                      (A.porosity - x[THETA]) / FracPerv;
-
-    // --- update GW mass balance
-    updateMassBal(Area, tStep);
+    gw->maxInfilVol = (s->totalDepth - x[LOWERDEPTH]) *
+                      (a->porosity - x[THETA]) / s->fracPerv;
 
     // --- update GW statistics 
-    stats_updateGwaterStats(j, infil, GW->evapLoss, GWFlow, LowerLoss,
-        GW->theta, GW->lowerDepth + GW->bottomElev, tStep);
+    stats_updateGwaterStats(s->subcatch, s->infil, gw->evapLoss, s->gwFlow,
+        s->lowerLoss, gw->theta, gw->lowerDepth + gw->bottomElev, s->tstep);
 }
 
 //=============================================================================
 
-void updateMassBal(double area, double tStep)
+void updateMassBal(TGWState* s, double area, double tStep)
 //
-//  Input:   area  = subcatchment area (ft2)
+//  Input:   s     = state of an aquifer
+//           area  = subcatchment area (ft2)
 //           tStep = time step (sec)
 //  Output:  none
 //  Purpose: updates GW mass balance with volumes of water fluxes.
@@ -621,20 +799,21 @@ void updateMassBal(double area, double tStep)
     double vGwater;                    // volume of exchanged groundwater
     double ft2sec = area * tStep;
 
-    vInfil     = Infil * ft2sec;
-    vUpperEvap = UpperEvap * ft2sec;
-    vLowerEvap = LowerEvap * ft2sec;
-    vLowerPerc = LowerLoss * ft2sec;
-    vGwater    = 0.5 * (GW->oldFlow + GW->newFlow) * ft2sec;
+    vInfil     = s->infil * ft2sec;
+    vUpperEvap = s->upperEvap * ft2sec;
+    vLowerEvap = s->lowerEvap * ft2sec;
+    vLowerPerc = s->lowerLoss * ft2sec;
+    vGwater    = 0.5 * (s->gw->oldFlow + s->gw->newFlow) * ft2sec;
     massbal_updateGwaterTotals(vInfil, vUpperEvap, vLowerEvap, vLowerPerc,
                                vGwater);
 }
 
 //=============================================================================
 
-void  getFluxes(double theta, double lowerDepth)
+void  getFluxes(TGWState* s, double theta, double lowerDepth)
 //
-//  Input:   upperVolume = vol. depth of upper zone (ft)
+//  Input:   s           = state of an aquifer
+//           upperVolume = vol. depth of upper zone (ft)
 //           upperDepth  = depth of upper zone (ft)
 //  Output:  none
 //  Purpose: computes water fluxes into/out of upper/lower GW zones.
@@ -644,43 +823,46 @@ void  getFluxes(double theta, double lowerDepth)
 
     // --- find upper zone depth
     lowerDepth = MAX(lowerDepth, 0.0);
-    lowerDepth = MIN(lowerDepth, TotalDepth);
-    upperDepth = TotalDepth - lowerDepth;
+    lowerDepth = MIN(lowerDepth, s->totalDepth);
+    upperDepth = s->totalDepth - lowerDepth;
 
-    // --- save lower depth and theta to global variables
-    Hgw = lowerDepth;
-    Theta = theta;
+    // --- save lower depth and theta to the aquifer's state
+    s->hgw = lowerDepth;
+    s->theta = theta;
 
     // --- find evaporation rate from both zones
-    getEvapRates(theta, upperDepth);
+    getEvapRates(s, theta, upperDepth);
 
     // --- find percolation rate from upper to lower zone
-    UpperPerc = getUpperPerc(theta, upperDepth);
-    UpperPerc = MIN(UpperPerc, MaxUpperPerc);
+    s->upperPerc = getUpperPerc(s, theta, upperDepth);
+    s->upperPerc = MIN(s->upperPerc, s->maxUpperPerc);
 
     // --- find loss rate to deep GW
-    if ( DeepFlowExpr != NULL )
-        LowerLoss = mathexpr_eval(DeepFlowExpr, getVariableValue) /
-                    UCF(RAINFALL);
+    Cur = s;
+    if ( s->deepFlowExpr != NULL )
+        s->lowerLoss = mathexpr_eval(s->deepFlowExpr, getVariableValue) /
+                       UCF(RAINFALL);
     else
-        LowerLoss = A.lowerLossCoeff * lowerDepth / TotalDepth;
-    LowerLoss = MIN(LowerLoss, lowerDepth/Tstep);
+        s->lowerLoss = s->a->lowerLossCoeff * lowerDepth / s->totalDepth;
+    s->lowerLoss = MIN(s->lowerLoss, lowerDepth/s->tstep);
 
     // --- find GW flow rate from lower zone to drainage system node
-    GWFlow = getGWFlow(lowerDepth);
-    if ( LatFlowExpr != NULL )
+    s->gwFlow = getGWFlow(s, lowerDepth);
+    if ( s->latFlowExpr != NULL )
     {
-        GWFlow += mathexpr_eval(LatFlowExpr, getVariableValue) / UCF(GWFLOW);
+        s->gwFlow += mathexpr_eval(s->latFlowExpr, getVariableValue) /
+                     UCF(GWFLOW);
     }
-    if ( GWFlow >= 0.0 ) GWFlow = MIN(GWFlow, MaxGWFlowPos);
-    else GWFlow = MAX(GWFlow, MaxGWFlowNeg);
+    if ( s->gwFlow >= 0.0 ) s->gwFlow = MIN(s->gwFlow, s->maxGWFlowPos);
+    else s->gwFlow = MAX(s->gwFlow, s->maxGWFlowNeg);
 }
 
 //=============================================================================
 
-void  getDxDt(double t, double* x, double* dxdt)
+void  getDxDt(int k, double t, double* x, double* dxdt)
 //
-//  Input:   t    = current time (not used)
+//  Input:   k    = index of aquifer in the batch being integrated
+//           t    = current time (not used)
 //           x    = array of state variables
 //  Output:  dxdt = array of time derivatives of state variables
 //  Purpose: computes time derivatives of upper moisture content 
@@ -690,14 +872,15 @@ void  getDxDt(double t, double* x, double* dxdt)
     double qUpper;    // inflow - outflow for upper zone (ft/sec)
     double qLower;    // inflow - outflow for lower zone (ft/sec)
     double denom;
+    TGWState* s = &Batch[k];
 
-    getFluxes(x[THETA], x[LOWERDEPTH]);
-    qUpper = Infil - UpperEvap - UpperPerc;
-    qLower = UpperPerc - LowerLoss - LowerEvap - GWFlow;
+    getFluxes(s, x[THETA], x[LOWERDEPTH]);
+    qUpper = s->infil - s->upperEvap - s->upperPerc;
+    qLower = s->upperPerc - s->lowerLoss - s->lowerEvap - s->gwFlow;
 
     // --- d(upper zone moisture)/dt = (net upper zone flow) /
     //                                 (upper zone depth)
-    denom = TotalDepth - x[LOWERDEPTH];
+    denom = s->totalDepth - x[LOWERDEPTH];
     if (denom > 0.0)
         dxdt[THETA] = qUpper / denom;
     else
@@ -705,7 +888,7 @@ void  getDxDt(double t, double* x, double* dxdt)
 
     // --- d(lower zone depth)/dt = (net lower zone flow) /
     //                              (upper zone moisture deficit)
-    denom = A.porosity - x[THETA];
+    denom = s->a->porosity - x[THETA];
     if (denom > 0.0)
         dxdt[LOWERDEPTH] = qLower / denom;
     else
@@ -714,9 +897,10 @@ void  getDxDt(double t, double* x, double* dxdt)
 
 //=============================================================================
 
-void getEvapRates(double theta, double upperDepth)
+void getEvapRates(TGWState* s, double theta, double upperDepth)
 //
-//  Input:   theta      = moisture content of upper zone
+//  Input:   s          = state of an aquifer
+//           theta      = moisture content of upper zone
 //           upperDepth = depth of upper zone (ft)
 //  Output:  none
 //  Purpose: computes evapotranspiration out of upper & lower zones.
@@ -725,16 +909,17 @@ void getEvapRates(double theta, double upperDepth)
     int    p, month;
     double f;
     double lowerFrac, upperFrac;
+    TAquifer* a = s->a;
 
     // --- no GW evaporation when infiltration is occurring
-    UpperEvap = 0.0;
-    LowerEvap = 0.0;
-    if ( Infil > 0.0 ) return;
+    s->upperEvap = 0.0;
+    s->lowerEvap = 0.0;
+    if ( s->infil > 0.0 ) return;
 
     // --- get monthly-adjusted upper zone evap fraction
-    upperFrac = A.upperEvapFrac;
+    upperFrac = a->upperEvapFrac;
     f = 1.0;
-    p = A.upperEvapPat;
+    p = a->upperEvapPat;
     if ( p >= 0 )
     {
         month = datetime_monthOfYear(getDateTime(NewRunoffTime));
@@ -744,35 +929,36 @@ void getEvapRates(double theta, double upperDepth)
 
     // --- upper zone evaporation requires that soil moisture
     //     be above the wilting point
-    if ( theta > A.wiltingPoint )
+    if ( theta > a->wiltingPoint )
     {
         // --- actual evap is upper zone fraction applied to max. potential
         //     rate, limited by the available rate after any surface evap 
-        UpperEvap = upperFrac * MaxEvap;
-        UpperEvap = MIN(UpperEvap, AvailEvap);
+        s->upperEvap = upperFrac * s->maxEvap;
+        s->upperEvap = MIN(s->upperEvap, s->availEvap);
     }
 
     // --- check if lower zone evaporation is possible
-    if ( A.lowerEvapDepth > 0.0 )
+    if ( a->lowerEvapDepth > 0.0 )
     {
         // --- find the fraction of the lower evaporation depth that
         //     extends into the saturated lower zone
-        lowerFrac = (A.lowerEvapDepth - upperDepth) / A.lowerEvapDepth;
+        lowerFrac = (a->lowerEvapDepth - upperDepth) / a->lowerEvapDepth;
         lowerFrac = MAX(0.0, lowerFrac);
         lowerFrac = MIN(lowerFrac, 1.0);
 
         // --- make the lower zone evap rate proportional to this fraction
         //     and the evap not used in the upper zone
-        LowerEvap = lowerFrac * (1.0 - upperFrac) * MaxEvap;
-        LowerEvap = MIN(LowerEvap, (AvailEvap - UpperEvap));
+        s->lowerEvap = lowerFrac * (1.0 - upperFrac) * s->maxEvap;
+        s->lowerEvap = MIN(s->lowerEvap, (s->availEvap - s->upperEvap));
     }
 }
 
 //=============================================================================
 
-double getUpperPerc(double theta, double upperDepth)
+double getUpperPerc(TGWState* s, double theta, double upperDepth)
 //
-//  Input:   theta      = moisture content of upper zone
+//  Input:   s          = state of an aquifer
+//           theta      = moisture content of upper zone
 //           upperDepth = depth of upper zone (ft)
 //  Output:  returns percolation rate (ft/sec)
 //  Purpose: finds percolation rate from upper to lower zone.
@@ -781,55 +967,61 @@ double getUpperPerc(double theta, double upperDepth)
     double delta;                       // unfilled water content of upper zone
     double dhdz;                        // avg. change in head with depth
     double hydcon;                      // unsaturated hydraulic conductivity
-
-    // --- no perc. from upper zone if no depth or moisture content too low    
-    if ( upperDepth <= 0.0 || theta <= A.fieldCapacity ) return 0.0;
+    TAquifer* a = s->a;
 
     // --- compute hyd. conductivity as function of moisture content
-    delta = theta - A.porosity;
-    hydcon = A.conductivity * exp(delta * A.conductSlope);
+    //     (saved for use in GW flow equations)
+    delta = theta - a->porosity;
+    hydcon = a->conductivity * exp(delta * a->conductSlope);
+    s->hydCon = hydcon;
+
+    // --- no perc. from upper zone if no depth or moisture content too low    
+    if ( upperDepth <= 0.0 || theta <= a->fieldCapacity ) return 0.0;
 
     // --- compute integral of dh/dz term
-    delta = theta - A.fieldCapacity;
-    dhdz = 1.0 + A.tensionSlope * 2.0 * delta / upperDepth;
+    delta = theta - a->fieldCapacity;
+    dhdz = 1.0 + a->tensionSlope * 2.0 * delta / upperDepth;
 
     // --- compute upper zone percolation rate
-    HydCon = hydcon;
     return hydcon * dhdz;
 }
 
 //=============================================================================
 
-double getGWFlow(double lowerDepth)
+double getGWFlow(TGWState* s, double lowerDepth)
 //
-//  Input:   lowerDepth = depth of lower zone (ft)
+//  Input:   s          = state of an aquifer
+//           lowerDepth = depth of lower zone (ft)
 //  Output:  returns groundwater flow rate (ft/sec)
 //  Purpose: finds groundwater outflow from lower saturated zone.
 //
 {
     double q, t1, t2, t3;
+    double hstar = s->hstar;
+    double hsw = s->hsw;
+    TGroundwater* gw = s->gw;
 
     // --- water table must be above Hstar for flow to occur
-    if ( lowerDepth <= Hstar ) return 0.0;
+    if ( lowerDepth <= hstar ) return 0.0;
 
     // --- compute groundwater component of flow
-    if ( GW->b1 == 0.0 ) t1 = GW->a1;
-    else t1 = GW->a1 * pow( (lowerDepth - Hstar)*UCF(LENGTH), GW->b1);
+    if ( gw->b1 == 0.0 ) t1 = gw->a1;
+    else t1 = gw->a1 * pow( (lowerDepth - hstar)*UCF(LENGTH), gw->b1);
 
     // --- compute surface water component of flow
-    if ( GW->b2 == 0.0 ) t2 = GW->a2;
-    else if (Hsw > Hstar)
+    if ( gw->b2 == 0.0 ) t2 = gw->a2;
+    else if (hsw > hstar)
     {
-        t2 = GW->a2 * pow( (Hsw - Hstar)*UCF(LENGTH), GW->b2);
+        t2 = gw->a2 * pow( (hsw - hstar)*UCF(LENGTH), gw->b2);
     }
     else t2 = 0.0;
 
     // --- compute groundwater/surface water interaction term
-    t3 = GW->a3 * lowerDepth * Hsw * UCF(LENGTH) * UCF(LENGTH);
+    t3 = gw->a3 * lowerDepth * hsw * UCF(LENGTH) * UCF(LENGTH);
 
     // --- compute total groundwater flow
     q = (t1 - t2 + t3) / UCF(GWFLOW); 
-    if ( q < 0.0 && GW->a3 != 0.0 ) q = 0.0;
+    if ( q < 0.0 && gw->a3 != 0.0 ) q = 0.0;
     return q;
 }
 
@@ -855,22 +1047,23 @@ double getVariableValue(int varIndex)
 //
 //  Input:   varIndex = index of a GW variable
 //  Output:  returns current value of GW variable
-//  Purpose: finds current value of a GW variable.
+//  Purpose: finds current value of a GW variable for the aquifer whose
+//           flow equation is being evaluated.
 //
 {
     switch (varIndex)
     {
-    case gwvHGW:  return Hgw * UCF(LENGTH);
-    case gwvHSW:  return Hsw * UCF(LENGTH);
-    case gwvHCB:  return Hstar * UCF(LENGTH);
-    case gwvHGS:  return TotalDepth * UCF(LENGTH);
-    case gwvKS:   return A.conductivity * UCF(RAINFALL);
-    case gwvK:    return HydCon * UCF(RAINFALL);
-    case gwvTHETA:return Theta;
-    case gwvPHI:  return A.porosity;
-    case gwvFI:   return Infil * UCF(RAINFALL); 
-    case gwvFU:   return UpperPerc * UCF(RAINFALL);
-    case gwvA:    return Area * UCF(LANDAREA);
+    case gwvHGW:  return Cur->hgw * UCF(LENGTH);
+    case gwvHSW:  return Cur->hsw * UCF(LENGTH);
+    case gwvHCB:  return Cur->hstar * UCF(LENGTH);
+    case gwvHGS:  return Cur->totalDepth * UCF(LENGTH);
+    case gwvKS:   return Cur->a->conductivity * UCF(RAINFALL);
+    case gwvK:    return Cur->hydCon * UCF(RAINFALL);
+    case gwvTHETA:return Cur->theta;
+    case gwvPHI:  return Cur->a->porosity;
+    case gwvFI:   return Cur->infil * UCF(RAINFALL); 
+    case gwvFU:   return Cur->upperPerc * UCF(RAINFALL);
+    case gwvA:    return Cur->area * UCF(LANDAREA);
     default:      return 0.0;
     }
 }
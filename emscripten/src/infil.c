@@ -37,6 +37,10 @@
 //
 //   Build 5.1.015:
 //   - Support added for multiple infiltration methods within a project.
+//
+//   Note: infiltration for all of the subcatchments producing pervious
+//   area runoff can be computed in a single batch (infil_getInfilBatch),
+//   which gives the same results as calling infil_getInfil for each.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -57,6 +61,7 @@ TInfil *Infil;
 
 static double Fumax;   // saturated water volume in upper soil zone (ft)
 static double InfilFactor;                                                     //(5.1.013)
+#pragma omp threadprivate(Fumax, InfilFactor)
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in infil.h)
@@ -67,7 +72,8 @@ static double InfilFactor;                                                     /
 //  infil_initState  (called by subcatch_initState)
 //  infil_getState   (called by writeRunoffFile in hotstart.c)
 //  infil_setState   (called by readRunoffFile in hotstart.c)
-//  infil_getInfil   (called by getSubareaRunoff in subcatch.c)
+//  infil_getInfil   (called by findNativeInfil in lid.c)
+//  infil_getInfilBatch (called by runoff_execute)
 
 //  Called locally and by storage node methods in node.c
 //  grnampt_setParams
@@ -329,6 +335,33 @@ double infil_getInfil(int j, double tstep, double rainfall,
 
 //=============================================================================
 
+void infil_getInfilBatch(int n, int subcatch[], double tstep,
+                         double rainfall[], double runon[], double depth[],
+                         double infil[])
+//
+//  Input:   n = number of subcatchments in the batch
+//           subcatch = index of each subcatchment in the batch
+//           tstep = runoff time step (sec)
+//           rainfall = rainfall rate on each subcatchment (ft/sec)
+//           runon = runon rate from other sub-areas or subcatchments (ft/sec)
+//           depth = depth of surface water on each subcatchment (ft)
+//  Output:  infil = infiltration rate on each subcatchment (ft/sec)
+//  Purpose: computes infiltration rates for a batch of subcatchments,
+//           giving the same results as calling infil_getInfil for each.
+//
+{
+    int j, k;
+
+    for (k = 0; k < n; k++)
+    {
+        j = subcatch[k];
+        infil_setInfilFactor(j);
+        infil[k] = infil_getInfil(j, tstep, rainfall[k], runon[k], depth[k]);
+    }
+}
+
+//=============================================================================
+
 int horton_setParams(THorton *infil, double p[])
 //
 //  Input:   infil = ptr. to Horton infiltration object
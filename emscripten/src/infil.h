@@ -107,6 +107,8 @@ void    infil_setState(int j, double x[]);
 void    infil_setInfilFactor(int j);
 double  infil_getInfil(int area, double tstep, double rainfall, double runon,
         double depth);
+void    infil_getInfilBatch(int n, int subcatch[], double tstep,
+        double rainfall[], double runon[], double depth[], double infil[]);
 
 void    grnampt_getParams(int j, double p[]);
 int     grnampt_setParams(TGrnAmpt *infil, double p[]);
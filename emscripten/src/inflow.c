@@ -205,7 +205,7 @@ int inflow_setExtInflow(int j, int param, int type, int tseries, int basePat,
         // --- if it doesn't exist, then create it
         if ( inflow == NULL )
         {
-            inflow = (TExtInflow *) malloc(sizeof(TExtInflow));
+            inflow = (TExtInflow *) project_alloc(1, sizeof(TExtInflow));
             if ( inflow == NULL ) 
             {
                 return error_setInpError(ERR_MEMORY, "");
@@ -235,16 +235,11 @@ void inflow_deleteExtInflows(int j)
 //  Output:  none
 //  Purpose: deletes all time series inflow data for a node.
 //
+//  NOTE: inflow objects are allocated from the project's memory pool
+//        so they are released all at once when the project is closed.
+//
 {
-    TExtInflow* inflow1;
-    TExtInflow* inflow2;
-    inflow1 = Node[j].extInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
+    Node[j].extInflow = NULL;
 }
 
 //=============================================================================
@@ -339,7 +334,7 @@ int inflow_readDwfInflow(char* tok[], int ntoks)
     // --- if it doesn't exist, then create it
     if ( inflow == NULL )
     {
-        inflow = (TDwfInflow *) malloc(sizeof(TDwfInflow));
+        inflow = (TDwfInflow *) project_alloc(1, sizeof(TDwfInflow));
         if ( inflow == NULL ) return error_setInpError(ERR_MEMORY, "");
         inflow->next = Node[j].dwfInflow;
         Node[j].dwfInflow = inflow;
@@ -361,15 +356,7 @@ void inflow_deleteDwfInflows(int j)
 //  Purpose: deletes all dry weather inflow data for a node.
 //
 {
-    TDwfInflow* inflow1;
-    TDwfInflow* inflow2;
-    inflow1 = Node[j].dwfInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
+    Node[j].dwfInflow = NULL;
 }
 
 //=============================================================================
@@ -26,6 +26,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include "headers.h"
 #include "lid.h"
 
@@ -33,6 +38,31 @@
 //  Constants
 //-----------------------------------------------------------------------------
 static const int MAXERRS = 100;        // Max. input errors reported
+static const int INPCHUNK = 65536;     // Size of input file read increment
+#if defined(_OPENMP)
+static const int MINBATCH = 256;       // Min. lines in a parallel parse batch
+#endif
+static const int SNAPSHOT_VERSION = 1; // Version of input snapshot file format
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    long  offset;                      // start of line in input text
+    long  firstTok;                    // index of line's first token
+    int   ntoks;                       // number of tokens on line
+    int   number;                      // line number in input file
+}  TInpLine;
+
+typedef struct
+{
+    long  line;                        // index of input line
+    int   index;                       // index of object line refers to
+    int   subIndex;                    // sub-type index of object
+    int   err;                         // error code from parsing line
+    char* errText;                     // error string from parsing line
+}  TBatchLine;
 
 //-----------------------------------------------------------------------------
 //  Shared variables
@@ -44,24 +74,72 @@ static int  Mnodes[MAX_NODE_TYPES];    // Working number of node objects
 static int  Mlinks[MAX_LINK_TYPES];    // Working number of link objects
 static int  Mevents;                   // Working number of event periods
 
+static char*     InpText;              // null-separated lines of input file
+static char*     InpTokText;           // tokenized copy of InpText
+static char**    InpToks;              // tokens of all input lines
+static TInpLine* InpLines;             // index of input lines
+static long      InpLineCount;         // number of input lines
+static long      InpTextSize;          // number of characters in InpText
+
+static int          UseSnapshot;       // TRUE if input read from a snapshot
+static int          SaveSnapshot;      // TRUE if a snapshot should be saved
+static long         InpSize;           // size of input file text
+static unsigned int InpHash;           // hash code of input file text
+static char*        SnapTables;        // table data read from a snapshot
+static long         SnapTablesSize;    // number of bytes in SnapTables
+
+static TBatchLine* Batch;              // lines of a parallel parse batch
+static long        BatchSize;          // number of lines in Batch
+static int         BatchSect;          // input section of batched lines
+static int         BatchThreads;       // number of threads used to parse Batch
+
+static const double Pow10[] = {1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,
+                               1.0e6,  1.0e7,  1.0e8,  1.0e9,  1.0e10, 1.0e11,
+                               1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17,
+                               1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22};
+
+//-----------------------------------------------------------------------------
+//  Imported variables
+//-----------------------------------------------------------------------------
+extern char ErrString[256];            // defined in ERROR.C
+#pragma omp threadprivate(ErrString)
+
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 //  input_countObjects  (called by swmm_open in swmm5.c)
 //  input_readData      (called by swmm_open in swmm5.c)
+//  input_saveSnapshot  (called by swmm_open in swmm5.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
-static int  addObject(int objType, char* id);
+static int  indexInput(void);
+static int  readInputText(char** text, long* size);
+static int  tokenizeInput(void);
+static void setLineTokens(long i);
+static void freeInput(void);
+static unsigned int getTextHash(char* text, long size);
+static int  readSnapshot(void);
+static int  checkSnapshotTables(void);
+static int  restoreSnapshotTables(void);
+static int  restoreSnapshotTable(TTable* table, int type, char** p);
+static void writeSnapshot(void);
+static int  writeSnapshotTable(TTable* table, FILE* f);
+static int  isBatchSection(int sect);
+static void addToBatch(int sect, long line);
+static int  parseBatch(int errsum);
+static void parseBatchLine(TBatchLine* b);
+static int  addObject(int objType, char* tok[], int ntoks);
 static int  getTokens(char *s);
 static int  parseLine(int sect, char* line);
-static int  readOption(char* line);
+static int  readOption(char* tok[], int ntoks);
 static int  readTitle(char* line);
 static int  readControl(char* tok[], int ntoks);
 static int  readNode(int type);
 static int  readLink(int type);
 static int  readEvent(char* tok[], int ntoks);
+static int  parseDouble(char* s, double* y);
 
 //=============================================================================
 
@@ -72,9 +150,9 @@ int input_countObjects()
 //  Purpose: reads input file to determine number of system objects.
 //
 {
-    char  line[MAXLINE+1];             // line from input data file     
-    char  wLine[MAXLINE+1];            // working copy of input line   
-    char  *tok;                        // first string token of line          
+    char  *line;                       // line from input data file
+    char  **tok;                       // string tokens of line
+    int   ntoks;                       // number of tokens on line
     int   sect = -1, newsect;          // input data sections          
     int   errcode = 0;                 // error code
     int   errsum = 0;                  // number of errors found                   
@@ -88,21 +166,24 @@ int input_countObjects()
     for (i = 0; i < MAX_NODE_TYPES; i++) Nnodes[i] = 0;
     for (i = 0; i < MAX_LINK_TYPES; i++) Nlinks[i] = 0;
 
+    // --- read input file into memory and index its lines & tokens
+    if ( indexInput() ) return ErrorCode;
+
     // --- make pass through data file counting number of each object
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    for ( lineCount = 0; lineCount < InpLineCount; lineCount++ )
     {
         // --- skip blank lines & those beginning with a comment
-        lineCount++;
-        strcpy(wLine, line);           // make working copy of line
-        tok = strtok(wLine, SEPSTR);   // get first text token on line
-        if ( tok == NULL ) continue;
-        if ( *tok == ';' ) continue;
+        line = InpText + InpLines[lineCount].offset;
+        tok = InpToks + InpLines[lineCount].firstTok;
+        ntoks = InpLines[lineCount].ntoks;
+        if ( ntoks == 0 ) continue;
+        if ( *tok[0] == ';' ) continue;
 
         // --- check if line begins with a new section heading
-        if ( *tok == '[' )
+        if ( *tok[0] == '[' )
         {
             // --- look for heading in list of section keywords
-            newsect = findmatch(tok, SectWords);
+            newsect = findmatch(tok[0], SectWords);
             if ( newsect >= 0 )
             {
                 sect = newsect;
@@ -116,14 +197,15 @@ int input_countObjects()
         }
 
         // --- if in OPTIONS section then read the option setting
-        //     otherwise add object and its ID name (tok) to project
-        if ( sect == s_OPTION ) errcode = readOption(line);
-        else if ( sect >= 0 )   errcode = addObject(sect, tok);
+        //     otherwise add object and its ID name (tok[0]) to project
+        if ( sect == s_OPTION ) errcode = readOption(tok, ntoks);
+        else if ( sect >= 0 )   errcode = addObject(sect, tok, ntoks);
 
         // --- report any error found
         if ( errcode )
         {
-            report_writeInputErrorMsg(errcode, sect, line, lineCount);
+            report_writeInputErrorMsg(errcode, sect, line,
+                                      InpLines[lineCount].number);
             errsum++;
             if (errsum >= MAXERRS ) break;
         }
@@ -131,6 +213,7 @@ int input_countObjects()
 
     // --- set global error code if input errors were found
     if ( errsum > 0 ) ErrorCode = ERR_INPUT;
+    if ( ErrorCode ) freeInput();
     return ErrorCode;
 }
 
@@ -143,19 +226,23 @@ int input_readData()
 //  Purpose: reads input file to determine input parameters for each object.
 //
 {
-    char  line[MAXLINE+1];        // line from input data file
-    char  wLine[MAXLINE+1];       // working copy of input line
+    char* line;                   // line from input data file
     char* comment;                // ptr. to start of comment in input line
     int   sect, newsect;          // data sections
     int   inperr, errsum;         // error code & total error count
     int   lineLength;             // number of characters in input line
+    int   tooLong;                // TRUE if line exceeds max. length
     int   i;
     long  lineCount = 0;
 
     // --- initialize working item count arrays
     //     (final counts in Mobjects, Mnodes & Mlinks should
     //      match those in Nobjects, Nnodes and Nlinks).
-    if ( ErrorCode ) return ErrorCode;
+    if ( ErrorCode )
+    {
+        freeInput();
+        return ErrorCode;
+    }
     error_setInpError(0, "");
     for (i = 0; i < MAX_OBJ_TYPES; i++)  Mobjects[i] = 0;
     for (i = 0; i < MAX_NODE_TYPES; i++) Mnodes[i] = 0;
@@ -168,34 +255,72 @@ int input_readData()
         Tseries[i].lastDate = StartDate + StartTime;
     }
 
-    // --- read each line from input file
+    // --- curve & time series data come directly from a snapshot
+    if ( UseSnapshot && restoreSnapshotTables() )
+    {
+        freeInput();
+        return ErrorCode;
+    }
+
+    // --- lines from sections whose objects have all been registered
+    //     and don't depend on each other are batched together and parsed
+    //     in parallel when more than one thread is requested
+    Batch = NULL;
+    BatchSize = 0;
+    BatchThreads = 1;
+#if defined(_OPENMP)
+    BatchThreads = ( NumThreads > 0 ) ? NumThreads : omp_get_max_threads();
+#endif
+    if ( BatchThreads > 1 )
+    {
+        Batch = (TBatchLine *) malloc(InpLineCount * sizeof(TBatchLine));
+    }
+
+    // --- read each line from the input file index built by
+    //     input_countObjects
     sect = 0;
     errsum = 0;
-    rewind(Finp.file);
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    for ( lineCount = 0; lineCount < InpLineCount; lineCount++ )
     {
-        // --- make copy of line and scan for tokens
-        lineCount++;
-        strcpy(wLine, line);
-        Ntokens = getTokens(wLine);
+        // --- retrieve line and its tokens
+        line = InpText + InpLines[lineCount].offset;
+        setLineTokens(lineCount);
 
         // --- skip blank lines and comments
         if ( Ntokens == 0 ) continue;
         if ( *Tok[0] == ';' ) continue;
 
+        // --- skip table data already restored from a snapshot
+        if ( UseSnapshot && *Tok[0] != '[' &&
+             (sect == s_CURVE || sect == s_TIMESERIES) ) continue;
+
         // --- check if max. line length exceeded
+        tooLong = FALSE;
         lineLength = strlen(line);
         if ( lineLength >= MAXLINE )
         {
             // --- don't count comment if present
             comment = strchr(line, ';');
             if ( comment ) lineLength = comment - line;    // Pointer math here
-            if ( lineLength >= MAXLINE )
-            {
-                inperr = ERR_LINE_LENGTH;
-                report_writeInputErrorMsg(inperr, sect, line, lineCount);
-                errsum++;
-            }
+            tooLong = ( lineLength >= MAXLINE );
+        }
+
+        // --- add line to current parse batch if possible
+        if ( *Tok[0] != '[' && !tooLong && isBatchSection(sect) )
+        {
+            addToBatch(sect, lineCount);
+            continue;
+        }
+
+        // --- otherwise parse any batched lines before this one
+        errsum = parseBatch(errsum);
+        if (errsum > MAXERRS) break;
+        if ( tooLong )
+        {
+            inperr = ERR_LINE_LENGTH;
+            report_writeInputErrorMsg(inperr, sect, line,
+                                      InpLines[lineCount].number);
+            errsum++;
         }
 
         // --- check if at start of a new input section
@@ -217,7 +342,8 @@ int input_readData()
             else
             {
                 inperr = error_setInpError(ERR_KEYWORD, Tok[0]);
-                report_writeInputErrorMsg(inperr, sect, line, lineCount);
+                report_writeInputErrorMsg(inperr, sect, line,
+                                          InpLines[lineCount].number);
                 errsum++;
                 break;
             }
@@ -231,13 +357,24 @@ int input_readData()
             {
                 errsum++;
                 if ( errsum > MAXERRS ) report_writeLine(FMT19);
-                else report_writeInputErrorMsg(inperr, sect, line, lineCount);
+                else report_writeInputErrorMsg(inperr, sect, line,
+                                               InpLines[lineCount].number);
             }
         }
 
         // --- stop if reach end of file or max. error count
         if (errsum > MAXERRS) break;
-    }   /* End of while */
+    }   /* End of for */
+
+    // --- parse any lines remaining in the last batch
+    errsum = parseBatch(errsum);
+
+    // --- free the input file index
+    //     (its lines are kept if a snapshot will be saved from them)
+    FREE(Batch);
+    FREE(InpTokText);
+    FREE(InpToks);
+    if ( errsum > 0 || !SaveSnapshot ) freeInput();
 
     // --- check for errors
     if (errsum > 0)  ErrorCode = ERR_INPUT;
@@ -246,15 +383,940 @@ int input_readData()
 
 //=============================================================================
 
-int  addObject(int objType, char* id)
+void input_saveSnapshot()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: saves a compiled snapshot of a validated project's input data
+//           if one was requested and is not already current.
+//
+{
+    if ( SaveSnapshot && InpLines != NULL && !ErrorCode ) writeSnapshot();
+    SaveSnapshot = FALSE;
+    freeInput();
+}
+
+//=============================================================================
+
+int indexInput()
+//
+//  Input:   none
+//  Output:  returns error code
+//  Purpose: reads the input file into memory, splits it into lines and
+//           tokenizes each line once for use by both input_countObjects
+//           and input_readData.
+//
+//  Notes:   Lines are split exactly as fgets() with a buffer of MAXLINE
+//           characters would split them, so that line numbers and the
+//           handling of overly long lines are the same as reading the
+//           file line by line.
+//
+{
+    char* text = NULL;                 // raw contents of input file
+    long  size = 0;                    // number of characters in text
+    long  i, j, k, n;
+
+    freeInput();
+    UseSnapshot = FALSE;
+    SaveSnapshot = FALSE;
+
+    // --- read entire input file into a single buffer
+    if ( readInputText(&text, &size) || text == NULL ) return ErrorCode;
+
+    // --- use a snapshot of the input in place of its text if the
+    //     snapshot was made from the same text
+    if ( Fsnapshot.mode == USE_FILE )
+    {
+        InpSize = size;
+        InpHash = getTextHash(text, size);
+        if ( readSnapshot() )
+        {
+            free(text);
+            UseSnapshot = TRUE;
+            return 0;
+        }
+        SaveSnapshot = TRUE;
+    }
+
+    // --- count the lines of text as fgets() would return them
+    n = 0;
+    i = 0;
+    while ( i < size )
+    {
+        for ( j = 0; j < MAXLINE-1 && i < size; j++ )
+        {
+            if ( text[i++] == '\n' ) break;
+        }
+        n++;
+    }
+
+    // --- allocate space for the null-separated lines of text
+    InpText = (char *) malloc((size + n + 1) * sizeof(char));
+    InpLines = (TInpLine *) malloc((n + 1) * sizeof(TInpLine));
+    if ( InpText == NULL || InpLines == NULL )
+    {
+        free(text);
+        freeInput();
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
+    // --- copy each line of text into InpText
+    i = 0;
+    k = 0;
+    for ( n = 0; i < size; n++ )
+    {
+        InpLines[n].offset = k;
+        InpLines[n].number = n + 1;
+        for ( j = 0; j < MAXLINE-1 && i < size; j++ )
+        {
+            InpText[k++] = text[i];
+            if ( text[i++] == '\n' ) break;
+        }
+        InpText[k++] = '\0';
+    }
+    InpLineCount = n;
+    InpTextSize = k;
+    free(text);
+
+    // --- tokenize each line
+    if ( !tokenizeInput() )
+    {
+        freeInput();
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+    return 0;
+}
+
+//=============================================================================
+
+int tokenizeInput()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: tokenizes a copy of each indexed line of input text.
+//
+{
+    long   i, j;
+    long   maxToks, nToks;
+    char** toks;
+
+    // --- make a working copy of the lines to hold their tokens
+    FREE(InpTokText);
+    FREE(InpToks);
+    InpTokText = (char *) malloc((InpTextSize + 1) * sizeof(char));
+    maxToks = InpLineCount * 4 + 16;
+    InpToks = (char **) malloc(maxToks * sizeof(char *));
+    if ( InpTokText == NULL || InpToks == NULL ) return FALSE;
+    memcpy(InpTokText, InpText, InpTextSize * sizeof(char));
+
+    // --- tokenize each line, saving its tokens in InpToks
+    nToks = 0;
+    for ( i = 0; i < InpLineCount; i++ )
+    {
+        Ntokens = getTokens(InpTokText + InpLines[i].offset);
+        if ( nToks + Ntokens > maxToks )
+        {
+            maxToks = 2 * maxToks + MAXTOKS;
+            toks = (char **) realloc(InpToks, maxToks * sizeof(char *));
+            if ( toks == NULL ) return FALSE;
+            InpToks = toks;
+        }
+        InpLines[i].firstTok = nToks;
+        InpLines[i].ntoks = Ntokens;
+        for ( j = 0; j < Ntokens; j++ ) InpToks[nToks++] = Tok[j];
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+int readInputText(char** text, long* size)
+//
+//  Input:   none
+//  Output:  text = contents of the input file
+//           size = number of characters in text
+//           returns error code
+//  Purpose: reads the entire contents of the input file into memory.
+//
+{
+    long  capacity = INPCHUNK;
+    long  n;
+    char* buf;
+    char* newBuf;
+
+    *text = NULL;
+    *size = 0;
+
+    // --- start with a buffer sized to the file when its size is known
+    if ( fseek(Finp.file, 0, SEEK_END) == 0 )
+    {
+        n = ftell(Finp.file);
+        if ( n > 0 ) capacity = n + 1;
+    }
+    rewind(Finp.file);
+
+    // --- read file in blocks, enlarging the buffer as needed
+    //     (file is opened in text mode so the number of characters
+    //     read may differ from its size on disk)
+    buf = (char *) malloc((capacity + 1) * sizeof(char));
+    while ( buf )
+    {
+        n = (long)fread(buf + *size, sizeof(char), capacity - *size,
+                        Finp.file);
+        *size += n;
+        if ( *size < capacity ) break;
+        capacity += MAX(capacity, INPCHUNK);
+        newBuf = (char *) realloc(buf, (capacity + 1) * sizeof(char));
+        if ( newBuf == NULL ) free(buf);
+        buf = newBuf;
+    }
+    if ( buf == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+    if ( ferror(Finp.file) )
+    {
+        free(buf);
+        *size = 0;
+        report_writeErrorMsg(ERR_INP_FILE, "");
+        return ErrorCode;
+    }
+    buf[*size] = '\0';
+    *text = buf;
+    return 0;
+}
+
+//=============================================================================
+
+void setLineTokens(long i)
+//
+//  Input:   i = index of an input line
+//  Output:  none
+//  Purpose: loads the tokens of an indexed input line into Tok[].
+//
+{
+    int   n;
+    char** toks = InpToks + InpLines[i].firstTok;
+
+    Ntokens = InpLines[i].ntoks;
+    for (n = 0; n < Ntokens; n++) Tok[n] = toks[n];
+    for (n = Ntokens; n < MAXTOKS; n++) Tok[n] = NULL;
+}
+
+//=============================================================================
+
+void freeInput()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees memory used to hold the indexed contents of the input file.
+//
+{
+    FREE(InpText);
+    FREE(InpTokText);
+    FREE(InpToks);
+    FREE(InpLines);
+    FREE(SnapTables);
+    InpLineCount = 0;
+    InpTextSize = 0;
+    SnapTablesSize = 0;
+}
+
+//=============================================================================
+
+unsigned int getTextHash(char* text, long size)
+//
+//  Input:   text = a block of text
+//           size = number of characters in text
+//  Output:  returns a hash code for the text
+//  Purpose: computes the 32-bit FNV-1a hash code of a block of text.
+//
+{
+    long i;
+    unsigned int h = 2166136261u;
+    for (i = 0; i < size; i++)
+    {
+        h ^= (unsigned char)text[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+//=============================================================================
+
+int readSnapshot()
+//
+//  Input:   none
+//  Output:  returns TRUE if a current snapshot was read, FALSE if not
+//  Purpose: reads the indexed lines of the input file along with its
+//           curve and time series data from a snapshot file.
+//
+//  Notes:   A snapshot file contains:
+//           - a file stamp, the snapshot format and SWMM version numbers,
+//             and the size and hash code of the input text it was made from
+//           - the number of lines, tokens, text characters and token
+//             characters it contains
+//           - the null-terminated text of each line (only title lines
+//             keep their text)
+//           - the null-terminated tokens of each line
+//           - the input file line number and token count of each line
+//           - the data of each time series and curve, in that order.
+//
+{
+    char   stamp[] = "SWMM5-SNAPSHOT";
+    char   fileStamp[sizeof(stamp)];
+    int    version[2];
+    int    counts[4];
+    int*   lineInfo = NULL;
+    double size;
+    unsigned int hash;
+    long   i, j, k, n, pos, nToks;
+    int    ok;
+    FILE*  f;
+
+    // --- check that the snapshot was made from the current input text
+    f = fopen(Fsnapshot.name, "rb");
+    if ( f == NULL ) return FALSE;
+    ok = fread(fileStamp, sizeof(char), sizeof(stamp), f) == sizeof(stamp) &&
+         memcmp(fileStamp, stamp, sizeof(stamp)) == 0 &&
+         fread(version, sizeof(int), 2, f) == 2 &&
+         version[0] == SNAPSHOT_VERSION && version[1] == VERSION &&
+         fread(&size, sizeof(double), 1, f) == 1 && size == (double)InpSize &&
+         fread(&hash, sizeof(unsigned int), 1, f) == 1 && hash == InpHash &&
+         fread(counts, sizeof(int), 4, f) == 4 &&
+         counts[0] >= 0 && counts[1] >= 0 &&
+         counts[2] >= counts[0] && counts[3] >= counts[1];
+
+    // --- read the text, tokens and line number & token count of each line
+    if ( ok )
+    {
+        n = counts[0];
+        InpText = (char *) malloc((counts[2] + 1) * sizeof(char));
+        InpTokText = (char *) malloc((counts[3] + 1) * sizeof(char));
+        InpLines = (TInpLine *) malloc((n + 1) * sizeof(TInpLine));
+        InpToks = (char **) malloc((counts[1] + 1) * sizeof(char *));
+        lineInfo = (int *) malloc((2 * n + 1) * sizeof(int));
+        ok = InpText && InpTokText && InpLines && InpToks && lineInfo &&
+             (long)fread(InpText, sizeof(char), counts[2], f) == counts[2] &&
+             (long)fread(InpTokText, sizeof(char), counts[3], f) == counts[3] &&
+             (long)fread(lineInfo, sizeof(int), 2 * n, f) == 2 * n;
+    }
+
+    // --- locate the text and tokens of each line
+    if ( ok )
+    {
+        InpText[counts[2]] = '\0';
+        InpTokText[counts[3]] = '\0';
+        pos = 0;
+        k = 0;
+        nToks = 0;
+        for (i = 0; i < n && ok; i++)
+        {
+            InpLines[i].offset = pos;
+            InpLines[i].number = lineInfo[2*i];
+            InpLines[i].ntoks = lineInfo[2*i+1];
+            InpLines[i].firstTok = nToks;
+            pos += strlen(InpText + pos) + 1;
+            ok = pos <= counts[2] &&
+                 InpLines[i].ntoks >= 0 && InpLines[i].ntoks <= MAXTOKS &&
+                 nToks + InpLines[i].ntoks <= counts[1];
+            for (j = 0; j < InpLines[i].ntoks && ok; j++)
+            {
+                InpToks[nToks++] = InpTokText + k;
+                k += strlen(InpTokText + k) + 1;
+                ok = k <= counts[3];
+            }
+        }
+        ok = ok && pos == counts[2] && k == counts[3] && nToks == counts[1];
+        InpLineCount = n;
+        InpTextSize = counts[2];
+    }
+
+    // --- read the remaining table data into memory
+    if ( ok )
+    {
+        pos = ftell(f);
+        ok = fseek(f, 0, SEEK_END) == 0;
+        SnapTablesSize = ftell(f) - pos;
+        ok = ok && fseek(f, pos, SEEK_SET) == 0 && SnapTablesSize >= 0;
+    }
+    if ( ok )
+    {
+        SnapTables = (char *) malloc((SnapTablesSize + 1) * sizeof(char));
+        ok = SnapTables &&
+             (long)fread(SnapTables, sizeof(char), SnapTablesSize, f) ==
+             SnapTablesSize &&
+             checkSnapshotTables();
+    }
+    fclose(f);
+    FREE(lineInfo);
+    if ( !ok ) freeInput();
+    return ok;
+}
+
+//=============================================================================
+
+int checkSnapshotTables()
+//
+//  Input:   none
+//  Output:  returns TRUE if table data read from a snapshot is complete
+//  Purpose: checks that the table data read from a snapshot file contains
+//           the number of bytes its records call for.
+//
+{
+    char*  p = SnapTables;
+    char*  end = SnapTables + SnapTablesSize;
+    int    counts[2];
+    int    i, n;
+    size_t fixedSize = 3 * sizeof(int) + (MAXFNAME + 1) * sizeof(char);
+
+    if ( end - p < (long)(2 * sizeof(int)) ) return FALSE;
+    memcpy(counts, p, 2 * sizeof(int));
+    p += 2 * sizeof(int);
+    if ( counts[0] < 0 || counts[1] < 0 ) return FALSE;
+    for (i = 0; i < counts[0] + counts[1]; i++)
+    {
+        // --- ID string
+        if ( end - p < (long)sizeof(int) ) return FALSE;
+        memcpy(&n, p, sizeof(int));
+        p += sizeof(int);
+        if ( n < 0 || n > MAXLINE || end - p < n ) return FALSE;
+        p += n;
+
+        // --- curve type, file mode, file name & number of entries
+        if ( end - p < (long)fixedSize ) return FALSE;
+        memcpy(&n, p + fixedSize - sizeof(int), sizeof(int));
+        p += fixedSize;
+
+        // --- x,y entries
+        if ( n < 0 || (end - p) / (long)(2 * sizeof(double)) < n ) return FALSE;
+        p += 2 * n * sizeof(double);
+    }
+    return p == end;
+}
+
+//=============================================================================
+
+int restoreSnapshotTables()
+//
+//  Input:   none
+//  Output:  returns error code
+//  Purpose: assigns the time series and curve data read from a snapshot
+//           file to the project's tables.
+//
+{
+    char* p = SnapTables;
+    int   counts[2];
+    int   j, result = TRUE;
+
+    memcpy(counts, p, 2 * sizeof(int));
+    p += 2 * sizeof(int);
+    if ( counts[0] != Nobjects[TSERIES] || counts[1] != Nobjects[CURVE] )
+    {
+        report_writeErrorMsg(ERR_INPUT, "");
+        return ErrorCode;
+    }
+    for (j = 0; j < Nobjects[TSERIES] && result; j++)
+    {
+        result = restoreSnapshotTable(&Tseries[j], TSERIES, &p);
+    }
+    for (j = 0; j < Nobjects[CURVE] && result; j++)
+    {
+        result = restoreSnapshotTable(&Curve[j], CURVE, &p);
+    }
+    FREE(SnapTables);
+    SnapTablesSize = 0;
+    if ( !result ) report_writeErrorMsg(ERR_MEMORY, "");
+    return ErrorCode;
+}
+
+//=============================================================================
+
+int restoreSnapshotTable(TTable* table, int type, char** p)
+//
+//  Input:   table = pointer to a time series or curve
+//           type = TSERIES or CURVE
+//           p = current position in snapshot table data
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: assigns a table's ID, type, data file and x,y entries from
+//           its record in the snapshot table data.
+//
+{
+    char   id[MAXLINE+1];
+    int    n, k;
+    double xy[2];
+
+    memcpy(&n, *p, sizeof(int));
+    *p += sizeof(int);
+    memcpy(id, *p, n * sizeof(char));
+    id[n] = '\0';
+    *p += n;
+    if ( n > 0 ) table->ID = project_findID(type, id);
+
+    memcpy(&table->curveType, *p, sizeof(int));
+    *p += sizeof(int);
+    memcpy(&k, *p, sizeof(int));
+    *p += sizeof(int);
+    table->file.mode = (char)k;
+    memcpy(table->file.name, *p, (MAXFNAME + 1) * sizeof(char));
+    *p += MAXFNAME + 1;
+
+    memcpy(&n, *p, sizeof(int));
+    *p += sizeof(int);
+    for (k = 0; k < n; k++)
+    {
+        memcpy(xy, *p, 2 * sizeof(double));
+        *p += 2 * sizeof(double);
+        if ( !table_addEntry(table, xy[0], xy[1]) ) return FALSE;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void writeSnapshot()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the indexed lines of the input file along with its
+//           curve and time series data to a snapshot file.
+//
+//  Notes:   Lines from sections that are only used for map display are
+//           left out, as are all but the first line of each time series
+//           and curve since their data are saved in binary form. Failure
+//           to write the snapshot is not treated as an error.
+//
+{
+    char   stamp[] = "SWMM5-SNAPSHOT";
+    int    version[2];
+    int    counts[4];
+    int    tableCounts[2];
+    int    info[2];
+    double size = (double)InpSize;
+    char*  keep;                       // 0 = line left out, 1 = tokens kept,
+                                       // 2 = tokens & text kept
+    char*  seen[2];                    // TRUE if table's first line was kept
+    char*  line;
+    char** toks;
+    long   i;
+    int    j, m, sect, ok;
+    FILE*  f;
+
+    // --- re-tokenize the input lines (their original tokens may have
+    //     been altered while being parsed)
+    keep = (char *) calloc(InpLineCount + 1, sizeof(char));
+    seen[0] = (char *) calloc(Nobjects[TSERIES] + 1, sizeof(char));
+    seen[1] = (char *) calloc(Nobjects[CURVE] + 1, sizeof(char));
+    ok = keep && seen[0] && seen[1] && tokenizeInput();
+
+    // --- select the lines to keep
+    for (j = 0; j < 4; j++) counts[j] = 0;
+    sect = -1;
+    for (i = 0; i < InpLineCount && ok; i++)
+    {
+        line = InpText + InpLines[i].offset;
+        toks = InpToks + InpLines[i].firstTok;
+        if ( InpLines[i].ntoks == 0 || *toks[0] == ';' ) continue;
+        if ( *toks[0] == '[' )
+        {
+            sect = findmatch(toks[0], SectWords);
+            keep[i] = 1;
+        }
+        else switch (sect)
+        {
+          case s_COORDINATE:
+          case s_VERTICES:
+          case s_POLYGON:
+          case s_LABEL:
+          case s_SYMBOL:
+          case s_BACKDROP:
+          case s_TAG:
+          case s_PROFILE:
+          case s_MAP:
+            break;
+
+          case s_TIMESERIES:
+          case s_CURVE:
+            m = ( sect == s_TIMESERIES ) ? 0 : 1;
+            j = project_findObject(m == 0 ? TSERIES : CURVE, toks[0]);
+            if ( j >= 0 && !seen[m][j] )
+            {
+                seen[m][j] = TRUE;
+                keep[i] = 1;
+            }
+            break;
+
+          case s_TITLE:
+            keep[i] = 2;
+            break;
+
+          default: keep[i] = 1;
+        }
+        if ( keep[i] == 0 ) continue;
+        counts[0]++;
+        counts[1] += InpLines[i].ntoks;
+        counts[2] += ( keep[i] == 2 ) ? strlen(line) + 1 : 1;
+        for (j = 0; j < InpLines[i].ntoks; j++)
+        {
+            counts[3] += strlen(toks[j]) + 1;
+        }
+    }
+
+    // --- write the snapshot header
+    f = NULL;
+    if ( ok ) f = fopen(Fsnapshot.name, "wb");
+    if ( f )
+    {
+        version[0] = SNAPSHOT_VERSION;
+        version[1] = VERSION;
+        fwrite(stamp, sizeof(char), sizeof(stamp), f);
+        fwrite(version, sizeof(int), 2, f);
+        fwrite(&size, sizeof(double), 1, f);
+        fwrite(&InpHash, sizeof(unsigned int), 1, f);
+        fwrite(counts, sizeof(int), 4, f);
+
+        // --- write the text, tokens and line number & token count
+        //     of each kept line
+        for (i = 0; i < InpLineCount; i++)
+        {
+            line = InpText + InpLines[i].offset;
+            if ( keep[i] == 2 ) fwrite(line, sizeof(char), strlen(line) + 1, f);
+            else if ( keep[i] == 1 ) fputc('\0', f);
+        }
+        for (i = 0; i < InpLineCount; i++)
+        {
+            if ( keep[i] == 0 ) continue;
+            toks = InpToks + InpLines[i].firstTok;
+            for (j = 0; j < InpLines[i].ntoks; j++)
+            {
+                fwrite(toks[j], sizeof(char), strlen(toks[j]) + 1, f);
+            }
+        }
+        for (i = 0; i < InpLineCount; i++)
+        {
+            if ( keep[i] == 0 ) continue;
+            info[0] = InpLines[i].number;
+            info[1] = InpLines[i].ntoks;
+            fwrite(info, sizeof(int), 2, f);
+        }
+
+        // --- write the time series & curve data
+        tableCounts[0] = Nobjects[TSERIES];
+        tableCounts[1] = Nobjects[CURVE];
+        fwrite(tableCounts, sizeof(int), 2, f);
+        for (j = 0; j < Nobjects[TSERIES]; j++)
+        {
+            writeSnapshotTable(&Tseries[j], f);
+        }
+        for (j = 0; j < Nobjects[CURVE]; j++)
+        {
+            writeSnapshotTable(&Curve[j], f);
+        }
+
+        // --- discard an incomplete snapshot file
+        ok = !ferror(f);
+        fclose(f);
+        if ( !ok ) remove(Fsnapshot.name);
+    }
+    FREE(keep);
+    FREE(seen[0]);
+    FREE(seen[1]);
+}
+
+//=============================================================================
+
+int writeSnapshotTable(TTable* table, FILE* f)
+//
+//  Input:   table = pointer to a time series or curve
+//           f = snapshot file
+//  Output:  returns number of x,y entries written
+//  Purpose: writes a table's ID, type, data file and x,y entries to a
+//           snapshot file.
+//
+{
+    int    n;
+    int    k;
+    double xy[2];
+    TTableEntry* entry;
+
+    // --- ID, curve type, data file mode & name
+    n = ( table->ID ) ? strlen(table->ID) : 0;
+    fwrite(&n, sizeof(int), 1, f);
+    if ( n > 0 ) fwrite(table->ID, sizeof(char), n, f);
+    fwrite(&table->curveType, sizeof(int), 1, f);
+    k = table->file.mode;
+    fwrite(&k, sizeof(int), 1, f);
+    fwrite(table->file.name, sizeof(char), MAXFNAME + 1, f);
+
+    // --- x,y entries
+    n = 0;
+    for (entry = table->firstEntry; entry; entry = entry->next) n++;
+    fwrite(&n, sizeof(int), 1, f);
+    for (entry = table->firstEntry; entry; entry = entry->next)
+    {
+        xy[0] = entry->x;
+        xy[1] = entry->y;
+        fwrite(xy, sizeof(double), 2, f);
+    }
+    return n;
+}
+
+//=============================================================================
+
+int isBatchSection(int sect)
+//
+//  Input:   sect = input data section
+//  Output:  returns TRUE if section's lines can be parsed in parallel
+//  Purpose: determines if lines from an input section can be batched.
+//
+//  Notes:   Each line of these sections either defines a new object or
+//           updates only the object named in its first token, so lines
+//           referring to different objects can be parsed concurrently.
+//
+{
+    if ( Batch == NULL ) return FALSE;
+    switch (sect)
+    {
+      case s_SUBCATCH:
+      case s_SUBAREA:
+      case s_JUNCTION:
+      case s_STORAGE:
+      case s_DIVIDER:
+      case s_CONDUIT:
+      case s_PUMP:
+      case s_ORIFICE:
+      case s_WEIR:
+      case s_OUTLET:
+      case s_XSECTION:
+      case s_LOSSES:
+      case s_TIMESERIES:
+        return TRUE;
+      default: return FALSE;
+    }
+}
+
+//=============================================================================
+
+void addToBatch(int sect, long line)
+//
+//  Input:   sect = input data section
+//           line = index of input line
+//  Output:  none
+//  Purpose: adds an input line to the current parse batch, assigning it
+//           the object indexes it would receive when parsed in sequence.
+//
+{
+    TBatchLine* b = &Batch[BatchSize];
+
+    BatchSect = sect;
+    BatchSize++;
+    b->line = line;
+    b->index = -1;
+    b->subIndex = -1;
+    b->err = 0;
+    b->errText = NULL;
+    switch (sect)
+    {
+      case s_SUBCATCH:
+        b->index = Mobjects[SUBCATCH]++;
+        break;
+
+      case s_JUNCTION:
+        b->index = Mobjects[NODE]++;
+        b->subIndex = Mnodes[JUNCTION]++;
+        break;
+
+      case s_STORAGE:
+        b->index = Mobjects[NODE]++;
+        b->subIndex = Mnodes[STORAGE]++;
+        break;
+
+      case s_DIVIDER:
+        b->index = Mobjects[NODE]++;
+        b->subIndex = Mnodes[DIVIDER]++;
+        break;
+
+      case s_CONDUIT:
+        b->index = Mobjects[LINK]++;
+        b->subIndex = Mlinks[CONDUIT]++;
+        break;
+
+      case s_PUMP:
+        b->index = Mobjects[LINK]++;
+        b->subIndex = Mlinks[PUMP]++;
+        break;
+
+      case s_ORIFICE:
+        b->index = Mobjects[LINK]++;
+        b->subIndex = Mlinks[ORIFICE]++;
+        break;
+
+      case s_WEIR:
+        b->index = Mobjects[LINK]++;
+        b->subIndex = Mlinks[WEIR]++;
+        break;
+
+      case s_OUTLET:
+        b->index = Mobjects[LINK]++;
+        b->subIndex = Mlinks[OUTLET]++;
+        break;
+    }
+}
+
+//=============================================================================
+
+int parseBatch(int errsum)
+//
+//  Input:   errsum = number of input errors found so far
+//  Output:  returns updated number of input errors
+//  Purpose: parses the lines of the current batch in parallel and reports
+//           any errors found in order of line number.
+//
+{
+    int    keyType = -1;               // type of object named on each line
+    long   i;
+    char*  line;
+
+    if ( BatchSize == 0 ) return errsum;
+    if ( BatchSect == s_SUBAREA ) keyType = SUBCATCH;
+    else if ( BatchSect == s_XSECTION || BatchSect == s_LOSSES ) keyType = LINK;
+    else if ( BatchSect == s_TIMESERIES ) keyType = TSERIES;
+
+    // --- lines referring to the same object are parsed by the same
+    //     thread in their original order
+#pragma omp parallel num_threads(BatchThreads) if(BatchSize >= MINBATCH)
+{
+    long  j, key;
+    int   t = 0, nt = 1;
+#if defined(_OPENMP)
+    t = omp_get_thread_num();
+    nt = omp_get_num_threads();
+#endif
+
+    // --- find index of the object named on each line
+    if ( keyType >= 0 )
+    {
+#pragma omp for schedule(static)
+        for (j = 0; j < BatchSize; j++)
+        {
+            Batch[j].index = project_findObject(keyType,
+                InpToks[InpLines[Batch[j].line].firstTok]);
+        }
+    }
+
+    // --- parse the lines assigned to this thread
+    for (j = 0; j < BatchSize; j++)
+    {
+        key = ( Batch[j].index >= 0 ) ? Batch[j].index : j;
+        if ( key % nt == t ) parseBatchLine(&Batch[j]);
+    }
+}
+
+    // --- report errors in order of line number
+    for (i = 0; i < BatchSize; i++)
+    {
+        if ( Batch[i].err == 0 || errsum > MAXERRS ) continue;
+        errsum++;
+        if ( errsum > MAXERRS ) report_writeLine(FMT19);
+        else
+        {
+            line = InpText + InpLines[Batch[i].line].offset;
+            error_setInpError(Batch[i].err, Batch[i].errText);
+            report_writeInputErrorMsg(Batch[i].err, BatchSect, line,
+                                      InpLines[Batch[i].line].number);
+        }
+    }
+    for (i = 0; i < BatchSize; i++) FREE(Batch[i].errText);
+    BatchSize = 0;
+    return errsum;
+}
+
+//=============================================================================
+
+void parseBatchLine(TBatchLine* b)
+//
+//  Input:   b = a batched input line
+//  Output:  none
+//  Purpose: parses a line of input data from a parse batch.
+//
+{
+    char*  tok[MAXTOKS];
+    char** toks = InpToks + InpLines[b->line].firstTok;
+    int    ntoks = InpLines[b->line].ntoks;
+    int    n, err = 0;
+
+    // --- make local copy of line's tokens (Tok[] is shared)
+    for (n = 0; n < ntoks; n++) tok[n] = toks[n];
+    for (n = ntoks; n < MAXTOKS; n++) tok[n] = NULL;
+
+    switch (BatchSect)
+    {
+      case s_SUBCATCH:
+        err = subcatch_readParams(b->index, tok, ntoks);
+        break;
+      case s_SUBAREA:
+        err = subcatch_readSubareaParams(tok, ntoks);
+        break;
+      case s_JUNCTION:
+        err = node_readParams(b->index, JUNCTION, b->subIndex, tok, ntoks);
+        break;
+      case s_STORAGE:
+        err = node_readParams(b->index, STORAGE, b->subIndex, tok, ntoks);
+        break;
+      case s_DIVIDER:
+        err = node_readParams(b->index, DIVIDER, b->subIndex, tok, ntoks);
+        break;
+      case s_CONDUIT:
+        err = link_readParams(b->index, CONDUIT, b->subIndex, tok, ntoks);
+        break;
+      case s_PUMP:
+        err = link_readParams(b->index, PUMP, b->subIndex, tok, ntoks);
+        break;
+      case s_ORIFICE:
+        err = link_readParams(b->index, ORIFICE, b->subIndex, tok, ntoks);
+        break;
+      case s_WEIR:
+        err = link_readParams(b->index, WEIR, b->subIndex, tok, ntoks);
+        break;
+      case s_OUTLET:
+        err = link_readParams(b->index, OUTLET, b->subIndex, tok, ntoks);
+        break;
+      case s_XSECTION:
+        err = link_readXsectParams(tok, ntoks);
+        break;
+      case s_LOSSES:
+        err = link_readLossParams(tok, ntoks);
+        break;
+      case s_TIMESERIES:
+        err = table_readTimeseries(tok, ntoks);
+        break;
+    }
+
+    // --- save a copy of the thread's error string
+    if ( err > 0 )
+    {
+        b->err = err;
+        b->errText = (char *) malloc((strlen(ErrString) + 1) * sizeof(char));
+        if ( b->errText ) strcpy(b->errText, ErrString);
+    }
+}
+
+//=============================================================================
+
+int  addObject(int objType, char* tok[], int ntoks)
 //
 //  Input:   objType = object type index
-//           id = object's ID string
+//           tok[] = array of string tokens (object's ID string first)
+//           ntoks = number of tokens
 //  Output:  returns an error code
 //  Purpose: adds a new object to the project.
 //
 {
     int errcode = 0;
+    char* id = tok[0];
     switch( objType )
     {
       case s_RAINGAGE:
@@ -389,8 +1451,8 @@ int  addObject(int objType, char* id)
             Nobjects[CURVE]++;
 
             // --- check for a conduit shape curve
-            id = strtok(NULL, SEPSTR);
-            if ( findmatch(id, CurveTypeWords) == SHAPE_CURVE )
+            if ( ntoks > 1 &&
+                 findmatch(tok[1], CurveTypeWords) == SHAPE_CURVE )
                 Nobjects[SHAPE]++;
         }
         break;
@@ -413,7 +1475,7 @@ int  addObject(int objType, char* id)
         // --- for TRANSECTS, ID name appears as second entry on X1 line
         if ( match(id, "X1") )
         {
-            id = strtok(NULL, SEPSTR);
+            id = ( ntoks > 1 ) ? tok[1] : NULL;
             if ( id ) 
             {
                 if ( !project_addObject(TRANSECT, id, Nobjects[TRANSECT]) )
@@ -644,16 +1706,16 @@ int readControl(char* tok[], int ntoks)
 
 //=============================================================================
 
-int readOption(char* line)
+int readOption(char* tok[], int ntoks)
 //
-//  Input:   line = line of input data
+//  Input:   tok[] = array of string tokens
+//           ntoks = number of tokens
 //  Output:  returns error code
 //  Purpose: reads an input line containing a project option.
 //
 {
-    Ntokens = getTokens(line);
-    if ( Ntokens < 2 ) return 0;
-    return project_readOption(Tok[0], Tok[1]);
+    if ( ntoks < 2 ) return 0;
+    return project_readOption(tok[0], tok[1]);
 }
 
 //=============================================================================
@@ -822,10 +1884,10 @@ int  getFloat(char *s, float *y)
 //  Purpose: converts a string to a single precision floating point number.
 //
 {
-    char *endptr;
-    *y = (float) strtod(s, &endptr);
-    if (*endptr > 0) return(0);
-    return(1);
+    double x;
+    int    result = getDouble(s, &x);
+    *y = (float)x;
+    return result;
 }
 
 //=============================================================================
@@ -839,6 +1901,7 @@ int  getDouble(char *s, double *y)
 //
 {
     char *endptr;
+    if ( parseDouble(s, y) ) return(1);
     *y = strtod(s, &endptr);
     if (*endptr > 0) return(0);
     return(1);
@@ -846,6 +1909,82 @@ int  getDouble(char *s, double *y)
 
 //=============================================================================
 
+int  parseDouble(char *s, double *y)
+//
+//  Input:   s = a character string
+//  Output:  y = converted value of s,
+//           returns 1 if conversion done, 0 if strtod must be used instead
+//  Purpose: quickly converts a plain decimal number to a double.
+//
+//  Notes:   Only strings of the form [+|-]digits[.digits][(e|E)[+|-]digits]
+//           with at most 15 significant digits and a net power of ten
+//           between -22 and 22 are converted. Such a number equals an
+//           exact integer multiplied or divided by an exact power of ten,
+//           so a single rounded operation gives the same correctly rounded
+//           result as strtod, independent of the locale.
+//
+{
+    double m = 0.0;                    // significant digits as an integer
+    int    digits = 0;                 // number of significant digits
+    int    found = 0;                  // TRUE if any digit found
+    int    scale = 0;                  // power of 10 from decimal point
+    int    expon = 0;                  // exponent value
+    int    negative = 0;               // TRUE if number is negative
+    int    negExpon = 0;               // TRUE if exponent is negative
+    int    n;
+
+    // --- sign
+    if ( *s == '-' || *s == '+' ) negative = (*s++ == '-');
+
+    // --- integer part
+    for ( ; *s >= '0' && *s <= '9'; s++ )
+    {
+        found = 1;
+        if ( m == 0.0 && *s == '0' ) continue;
+        if ( ++digits > 15 ) return 0;
+        m = 10.0 * m + (*s - '0');
+    }
+
+    // --- fractional part
+    if ( *s == '.' ) for ( s++; *s >= '0' && *s <= '9'; s++ )
+    {
+        found = 1;
+        scale--;
+        if ( m == 0.0 && *s == '0' ) continue;
+        if ( ++digits > 15 ) return 0;
+        m = 10.0 * m + (*s - '0');
+    }
+    if ( !found ) return 0;
+
+    // --- exponent
+    if ( *s == 'e' || *s == 'E' )
+    {
+        s++;
+        if ( *s == '-' || *s == '+' ) negExpon = (*s++ == '-');
+        for ( n = 0; *s >= '0' && *s <= '9'; s++, n++ )
+        {
+            if ( n >= 4 ) return 0;
+            expon = 10 * expon + (*s - '0');
+        }
+        if ( n == 0 ) return 0;
+        if ( negExpon ) expon = -expon;
+    }
+    if ( *s != '\0' ) return 0;
+
+    // --- combine digits with power of 10
+    if ( m > 0.0 )
+    {
+        expon += scale;
+        if ( expon < -22 || expon > 22 ) return 0;
+        if ( expon >= 0 ) m *= Pow10[expon];
+        else m /= Pow10[-expon];
+    }
+    *y = negative ? -m : m;
+    return 1;
+}
+
+//=============================================================================
+
 int  getTokens(char *s)
 //
 //  Input:   s = a character string
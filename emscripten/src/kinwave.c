@@ -32,14 +32,17 @@ static const double WT      = 0.6;     // time weighting
 static const double EPSIL   = 0.001;   // convergence criterion
 
 //-----------------------------------------------------------------------------
-//  Shared variables
+//  Data Structures
 //-----------------------------------------------------------------------------
-static double   Beta1;
-static double   C1;
-static double   C2;
-static double   Afull;
-static double   Qfull;
-static TXsect*  pXsect;
+typedef struct
+{
+    double  beta1;            // normalized section factor coefficient
+    double  c1;               // coefficient of continuity eqn.
+    double  c2;               // constant term of continuity eqn.
+    double  aFull;            // full flow area (ft2)
+    double  qFull;            // full flow rate (cfs)
+    TXsect* xsect;            // pointer to conduit's cross section
+} TKinWave;
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -49,7 +52,8 @@ static TXsect*  pXsect;
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
-static int   solveContinuity(double qin, double ain, double* aout);
+static int   solveContinuity(TKinWave* kw, double qin, double ain,
+             double* aout);
 static void  evalContinuity(double a, double* f, double* df, void* p);
 
 //=============================================================================
@@ -60,7 +64,8 @@ int kinwave_execute(int j, double* qinflow, double* qoutflow, double tStep)
 //           qinflow = inflow at current time (cfs)
 //           tStep = time step (sec)
 //  Output:  qoutflow = outflow at current time (cfs),
-//           returns number of iterations used
+//           returns number of iterations used or -1 if the continuity
+//           equation could not be solved
 //  Purpose: finds outflow over time step tStep given flow entering a
 //           conduit using Kinematic Wave flow routing.
 //
@@ -79,6 +84,7 @@ int kinwave_execute(int j, double* qinflow, double* qoutflow, double tStep)
     double ain, aout;
     double qin, qout;
     double a1, a2, q1, q2, q3;
+    TKinWave kw;                       // conduit's routing parameters
 
     // --- no routing for non-conduit link
     (*qoutflow) = (*qinflow); 
@@ -87,32 +93,32 @@ int kinwave_execute(int j, double* qinflow, double* qoutflow, double tStep)
     // --- no routing for dummy xsection
     if ( Link[j].xsect.type == DUMMY ) return result;
 
-    // --- assign module-level variables
-    pXsect = &Link[j].xsect;
-    Qfull = Link[j].qFull;
-    Afull = Link[j].xsect.aFull;
+    // --- assign conduit's routing parameters
+    kw.xsect = &Link[j].xsect;
+    kw.qFull = Link[j].qFull;
+    kw.aFull = Link[j].xsect.aFull;
     k = Link[j].subIndex;
-    Beta1 = Conduit[k].beta / Qfull;
+    kw.beta1 = Conduit[k].beta / kw.qFull;
  
     // --- normalize previous flows
-    q1 = Conduit[k].q1 / Qfull;
-    q2 = Conduit[k].q2 / Qfull;
+    q1 = Conduit[k].q1 / kw.qFull;
+    q2 = Conduit[k].q2 / kw.qFull;
 
     // --- normalize inflow
-    qin = (*qinflow) / Conduit[k].barrels / Qfull;
+    qin = (*qinflow) / Conduit[k].barrels / kw.qFull;
 
     // --- compute evaporation and infiltration loss rate
-	q3 = link_getLossRate(j, qin*Qfull) / Qfull;                               //(5.1.014)
+	q3 = link_getLossRate(j, qin*kw.qFull) / kw.qFull;                         //(5.1.014)
 
     // --- normalize previous areas
-    a1 = Conduit[k].a1 / Afull;
-    a2 = Conduit[k].a2 / Afull;
+    a1 = Conduit[k].a1 / kw.aFull;
+    a2 = Conduit[k].a2 / kw.aFull;
 
     // --- use full area when inlet flow >= full flow
     if ( qin >= 1.0 ) ain = 1.0;
 
     // --- get normalized inlet area corresponding to inlet flow
-    else ain = xsect_getAofS(pXsect, qin/Beta1) / Afull;
+    else ain = xsect_getAofS(kw.xsect, qin/kw.beta1) / kw.aFull;
 
     // --- check for no flow
     if ( qin <= TINY && q2 <= TINY )
@@ -125,41 +131,37 @@ int kinwave_execute(int j, double* qinflow, double* qoutflow, double tStep)
     else
     {
         // --- compute constant factors
-        dxdt = link_getLength(j) / tStep * Afull / Qfull;
+        dxdt = link_getLength(j) / tStep * kw.aFull / kw.qFull;
         dq   = q2 - q1;
-        C1   = dxdt * WT / WX;
-        C2   = (1.0 - WT) * (ain - a1);
-        C2   = C2 - WT * a2;
-        C2   = C2 * dxdt / WX;
-        C2   = C2 + (1.0 - WX) / WX * dq - qin;
-        C2   = C2 + q3 / WX;
+        kw.c1 = dxdt * WT / WX;
+        kw.c2 = (1.0 - WT) * (ain - a1);
+        kw.c2 = kw.c2 - WT * a2;
+        kw.c2 = kw.c2 * dxdt / WX;
+        kw.c2 = kw.c2 + (1.0 - WX) / WX * dq - qin;
+        kw.c2 = kw.c2 + q3 / WX;
 
         // --- starting guess for aout is value from previous time step
         aout = a2;
 
         // --- solve continuity equation for aout
-        result = solveContinuity(qin, ain, &aout);
+        result = solveContinuity(&kw, qin, ain, &aout);
 
-        // --- report error if continuity eqn. not solved
-        if ( result == -1 )
-        {
-            report_writeErrorMsg(ERR_KINWAVE, Link[j].ID);
-            return 1;
-        }
+        // --- continuity eqn. not solved (error is reported by caller)
+        if ( result == -1 ) return -1;
         if ( result <= 0 ) result = 1;
 
         // --- compute normalized outlet flow from outlet area
-        qout = Beta1 * xsect_getSofA(pXsect, aout*Afull);
+        qout = kw.beta1 * xsect_getSofA(kw.xsect, aout*kw.aFull);
         if ( qin > 1.0 ) qin = 1.0;
     }
 
     // --- save new flows and areas
-    Conduit[k].q1 = qin * Qfull;
-    Conduit[k].a1 = ain * Afull;
-    Conduit[k].q2 = qout * Qfull;
-    Conduit[k].a2 = aout * Afull;
+    Conduit[k].q1 = qin * kw.qFull;
+    Conduit[k].a1 = ain * kw.aFull;
+    Conduit[k].q2 = qout * kw.qFull;
+    Conduit[k].a2 = aout * kw.aFull;
     Conduit[k].fullState =
-        link_getFullState(Conduit[k].a1, Conduit[k].a2, Afull);
+        link_getFullState(Conduit[k].a1, Conduit[k].a2, kw.aFull);
     (*qinflow)  = Conduit[k].q1 * Conduit[k].barrels;
     (*qoutflow) = Conduit[k].q2 * Conduit[k].barrels;
     return result;
@@ -167,9 +169,10 @@ int kinwave_execute(int j, double* qinflow, double* qoutflow, double tStep)
 
 //=============================================================================
 
-int solveContinuity(double qin, double ain, double* aout)
+int solveContinuity(TKinWave* kw, double qin, double ain, double* aout)
 //
-//  Input:   qin = upstream normalized flow
+//  Input:   kw = conduit's kinematic wave routing parameters
+//           qin = upstream normalized flow
 //           ain = upstream normalized area
 //           aout = downstream normalized area
 //  Output:  new value for aout; returns an error code
@@ -181,9 +184,9 @@ int solveContinuity(double qin, double ain, double* aout)
 //           -2   flow always above max. flow
 //           -3   flow always below zero
 //
-//     Note: pXsect (pointer to conduit's cross-section), and constants Beta1,
-//           C1, and C2 are module-level shared variables assigned values
-//           in kinwave_execute().
+//     Note: the conduit's cross-section and the constants Beta1, C1, and C2
+//           are passed in kw rather than held in shared variables so that
+//           independent parts of the network can be routed concurrently.
 //
 {
     int    n;                          // # evaluations or error code
@@ -195,13 +198,13 @@ int solveContinuity(double qin, double ain, double* aout)
 
     // --- set upper bound to area at full flow
     aHi = 1.0;
-    fHi = 1.0 + C1 + C2;
+    fHi = 1.0 + kw->c1 + kw->c2;
 
     // --- try setting lower bound to area where section factor is maximum
-    aLo = xsect_getAmax(pXsect) / Afull;
+    aLo = xsect_getAmax(kw->xsect) / kw->aFull;
     if ( aLo < aHi )
     {
-        fLo = ( Beta1 * pXsect->sMax ) + (C1 * aLo) + C2;
+        fLo = ( kw->beta1 * kw->xsect->sMax ) + (kw->c1 * aLo) + kw->c2;
     }
     else fLo = fHi;
 
@@ -211,7 +214,7 @@ int solveContinuity(double qin, double ain, double* aout)
         aHi = aLo;
         fHi = fLo;
         aLo = 0.0;
-        fLo = C2;
+        fLo = kw->c2;
     }
 
     // --- proceed with search for root if fLo and fHi have different signs
@@ -232,7 +235,7 @@ int solveContinuity(double qin, double ain, double* aout)
         // --- call the Newton root finder method passing it the 
         //     evalContinuity function to evaluate the function
         //     and its derivatives
-        n = findroot_Newton(aLo, aHi, aout, tol, evalContinuity, NULL);
+        n = findroot_Newton(aLo, aHi, aout, tol, evalContinuity, kw);
 
         // --- check if root finder succeeded
         if ( n <= 0 ) n = -1;
@@ -261,14 +264,18 @@ int solveContinuity(double qin, double ain, double* aout)
 void evalContinuity(double a, double* f, double* df, void* p)
 //
 //  Input:   a = outlet normalized area
+//           p = pointer to a TKinWave object
 //  Output:  f = value of continuity eqn.
 //           df = derivative of continuity eqn.
 //  Purpose: computes value of continuity equation (f) and its derivative (df)
 //           w.r.t. normalized area for link with normalized outlet area 'a'.
 //
 {
-    *f  = (Beta1 * xsect_getSofA(pXsect, a*Afull)) + (C1 * a) + C2;
-    *df = (Beta1 * Afull * xsect_getdSdA(pXsect, a*Afull)) + C1;
+    TKinWave* kw = (TKinWave *)p;
+    *f  = (kw->beta1 * xsect_getSofA(kw->xsect, a*kw->aFull)) +
+          (kw->c1 * a) + kw->c2;
+    *df = (kw->beta1 * kw->aFull * xsect_getdSdA(kw->xsect, a*kw->aFull)) +
+          kw->c1;
 }
 
 //=============================================================================
@@ -15,9 +15,14 @@
 //   - landuse_getRunoffLoad() re-named to landuse_getWashoffLoad() and
 //     modified to work with landuse_getWashoffQual().
 //
+//   Pollutants of each land use are grouped by buildup and washoff
+//   function type so that buildup and washoff are computed by kernels
+//   that each evaluate a single type of function over a group.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 #include "headers.h"
@@ -30,24 +35,43 @@
 //  landuse_readBuildupParams (called by parseLine in input.c)
 //  landuse_readWashoffParams (called by parseLine in input.c)
 
+//  landuse_validate          (called by project_validate)
 //  landuse_getInitBuildup    (called by subcatch_initState)
-//  landuse_getBuildup        (called by surfqual_getBuildup)
-//  landuse_getWashoffLoad    (called by surfqual_getWashoff)
+//  landuse_addBuildup        (called by surfqual_getBuildup)
+//  landuse_getWashoffLoads   (called by surfqual_getWashoff)
 //  landuse_getCoPollutLoad   (called by surfqual_getwashoff));
 //  landuse_getAvgBMPEffic    (called by updatePondedQual in surfqual.c)
 
 //-----------------------------------------------------------------------------
 // Function declarations
 //-----------------------------------------------------------------------------
-static double landuse_getBuildupDays(int landuse, int pollut, double buildup);
-static double landuse_getBuildupMass(int landuse, int pollut, double days);
-static double landuse_getRunoffLoad(int landuse, int pollut, double area,
-              TLandFactor landFactor[], double runoff, double tStep);
-static double landuse_getWashoffQual(int landuse, int pollut, double buildup,
-              double runoff, double area);
+static double getBuildupDays(int landuse, int pollut, double buildup);
+static double getBuildupMass(int landuse, int pollut, double days);
 static double landuse_getExternalBuildup(int i, int p, double buildup,
               double tStep);
 
+static void   groupPolluts(int* order, int* group, int nGroups,
+              int funcType[]);
+static double getPerUnit(TBuildup* buildupFunc, double area, double curb);
+static void   setBuildup(int p, double* buildup, double newBuildup);
+static void   getPowerBuildup(int i, int k1, int k2, double area,
+              double curb, int hasSnow, double buildup[], double tStep);
+static void   getExponBuildup(int i, int k1, int k2, double area,
+              double curb, int hasSnow, double buildup[], double tStep);
+static void   getSaturBuildup(int i, int k1, int k2, double area,
+              double curb, int hasSnow, double buildup[], double tStep);
+static void   getExtBuildup(int i, int k1, int k2, double area,
+              double curb, int hasSnow, double buildup[], double tStep);
+static double getPowerDays(TBuildup* f, double buildup);
+static double getPowerMass(TBuildup* f, double days);
+static double getExponDays(TBuildup* f, double buildup);
+static double getExponMass(TBuildup* f, double days);
+static double getSaturDays(TBuildup* f, double buildup);
+static double getSaturMass(TBuildup* f, double days);
+static double removeWashoff(int i, int p, double washoffQual,
+              double landuseArea, TLandFactor landFactor[], double area,
+              double vOutflow);
+
 //=============================================================================
 
 int  landuse_readParams(int j, char* tok[], int ntoks)
@@ -354,6 +378,65 @@ int  landuse_readWashoffParams(char* tok[], int ntoks)
 
 //=============================================================================
 
+void  landuse_validate(int i)
+//
+//  Input:   i = land use index
+//  Output:  none
+//  Purpose: groups the land use's pollutants by buildup function type and
+//           by washoff function type.
+//
+{
+    int  p;
+    int  nPolluts = Nobjects[POLLUT];
+    int* funcType;
+
+    funcType = (int *) calloc(nPolluts+1, sizeof(int));
+    if ( funcType == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return;
+    }
+    for (p = 0; p < nPolluts; p++)
+        funcType[p] = Landuse[i].buildupFunc[p].funcType;
+    groupPolluts(Landuse[i].buildupOrder, Landuse[i].buildupGroup,
+                 EXTERNAL_BUILDUP+1, funcType);
+    for (p = 0; p < nPolluts; p++)
+        funcType[p] = Landuse[i].washoffFunc[p].funcType;
+    groupPolluts(Landuse[i].washoffOrder, Landuse[i].washoffGroup,
+                 EMC_WASHOFF+1, funcType);
+    free(funcType);
+}
+
+//=============================================================================
+
+void groupPolluts(int* order, int* group, int nGroups, int funcType[])
+//
+//  Input:   order = array of pollutant indexes
+//           group = array of nGroups+1 group starting positions
+//           nGroups = number of function types
+//           funcType = function type of each pollutant
+//  Output:  fills order[] with pollutants sorted by function type and
+//           group[] with the position in order[] where each type starts
+//  Purpose: groups pollutants by function type using a counting sort
+//           that preserves pollutant order within each group.
+//
+{
+    int p, g;
+
+    for (g = 0; g <= nGroups; g++) group[g] = 0;
+    for (p = 0; p < Nobjects[POLLUT]; p++) group[funcType[p]+1]++;
+    for (g = 0; g < nGroups; g++) group[g+1] += group[g];
+    for (p = 0; p < Nobjects[POLLUT]; p++)
+    {
+        g = funcType[p];
+        order[group[g]++] = p;
+    }
+    for (g = nGroups; g > 0; g--) group[g] = group[g-1];
+    group[0] = 0;
+}
+
+//=============================================================================
+
 void  landuse_getInitBuildup(TLandFactor* landFactor,  double* initBuildup,
 		double area, double curb)
 //
@@ -448,16 +531,199 @@ double  landuse_getBuildup(int i, int p, double area, double curb, double buildu
     }
 
     // --- determine equivalent days of current buildup
-    days = landuse_getBuildupDays(i, p, buildup/perUnit);
+    days = getBuildupDays(i, p, buildup/perUnit);
 
     // --- compute buildup after adding on time increment
     days += tStep / SECperDAY;
-    return landuse_getBuildupMass(i, p, days) * perUnit;
+    return getBuildupMass(i, p, days) * perUnit;
 }
 
 //=============================================================================
 
-double landuse_getBuildupDays(int i, int p, double buildup)
+void  landuse_addBuildup(int i, double area, double curb, int hasSnow,
+                         double buildup[], double tStep)
+//
+//  Input:   i = land use index
+//           area = land use area (ac or ha)
+//           curb = land use curb length (users units)
+//           hasSnow = TRUE if subcatchment has snow cover
+//           buildup = buildup of each pollutant on the land use (lbs or kg)
+//           tStep = time increment for buildup (sec)
+//  Output:  updates buildup[]
+//  Purpose: adds pollutant buildup over a time increment to a land use,
+//           evaluating one group of same-type buildup functions at a time.
+//
+{
+    int* group = Landuse[i].buildupGroup;
+
+    if ( tStep == 0.0 ) return;
+    getPowerBuildup(i, group[POWER_BUILDUP], group[POWER_BUILDUP+1],
+                    area, curb, hasSnow, buildup, tStep);
+    getExponBuildup(i, group[EXPON_BUILDUP], group[EXPON_BUILDUP+1],
+                    area, curb, hasSnow, buildup, tStep);
+    getSaturBuildup(i, group[SATUR_BUILDUP], group[SATUR_BUILDUP+1],
+                    area, curb, hasSnow, buildup, tStep);
+    getExtBuildup(i, group[EXTERNAL_BUILDUP], group[EXTERNAL_BUILDUP+1],
+                  area, curb, hasSnow, buildup, tStep);
+}
+
+//=============================================================================
+
+double getPerUnit(TBuildup* buildupFunc, double area, double curb)
+//
+//  Input:   buildupFunc = a buildup function
+//           area = land use area (ac or ha)
+//           curb = land use curb length (users units)
+//  Output:  returns the quantity that buildup is normalized to
+//  Purpose: finds the area or curb length a buildup function applies to.
+//
+{
+    if ( buildupFunc->normalizer == PER_AREA ) return area;
+    if ( buildupFunc->normalizer == PER_CURB ) return curb;
+    return 1.0;
+}
+
+//=============================================================================
+
+void setBuildup(int p, double* buildup, double newBuildup)
+//
+//  Input:   p = pollutant index
+//           buildup = current pollutant buildup (lbs or kg)
+//           newBuildup = buildup at end of time step (lbs or kg)
+//  Output:  updates buildup
+//  Purpose: saves a new pollutant buildup and adds the increase to the
+//           mass balance totals.
+//
+{
+    newBuildup = MAX(newBuildup, *buildup);
+    massbal_updateLoadingTotals(BUILDUP_LOAD, p, (newBuildup - *buildup));
+    *buildup = newBuildup;
+}
+
+//=============================================================================
+
+void getPowerBuildup(int i, int k1, int k2, double area, double curb,
+                     int hasSnow, double buildup[], double tStep)
+//
+//  Input:   i = land use index
+//           k1, k2 = range of positions in the land use's buildupOrder array
+//           area = land use area (ac or ha)
+//           curb = land use curb length (users units)
+//           hasSnow = TRUE if subcatchment has snow cover
+//           buildup = buildup of each pollutant on the land use (lbs or kg)
+//           tStep = time increment for buildup (sec)
+//  Output:  updates buildup[]
+//  Purpose: adds buildup to a group of pollutants with power function
+//           buildup (B = c1 * t^c2 up to a max. of c0).
+//
+{
+    int    k, p;
+    double days, perUnit;
+    TBuildup* f;
+
+    for (k = k1; k < k2; k++)
+    {
+        p = Landuse[i].buildupOrder[k];
+        if ( Pollut[p].snowOnly && !hasSnow ) continue;
+        f = &Landuse[i].buildupFunc[p];
+        perUnit = getPerUnit(f, area, curb);
+        if ( perUnit == 0.0 ) continue;
+
+        // --- buildup after adding time increment to equivalent days
+        //     of current buildup
+        days = getPowerDays(f, buildup[p] / perUnit) + tStep / SECperDAY;
+        setBuildup(p, &buildup[p], getPowerMass(f, days) * perUnit);
+    }
+}
+
+//=============================================================================
+
+void getExponBuildup(int i, int k1, int k2, double area, double curb,
+                     int hasSnow, double buildup[], double tStep)
+//
+//  Input:   (same as getPowerBuildup)
+//  Output:  updates buildup[]
+//  Purpose: adds buildup to a group of pollutants with exponential function
+//           buildup (B = c0 * (1 - exp(-c1 * t))).
+//
+{
+    int    k, p;
+    double days, perUnit;
+    TBuildup* f;
+
+    for (k = k1; k < k2; k++)
+    {
+        p = Landuse[i].buildupOrder[k];
+        if ( Pollut[p].snowOnly && !hasSnow ) continue;
+        f = &Landuse[i].buildupFunc[p];
+        perUnit = getPerUnit(f, area, curb);
+        if ( perUnit == 0.0 ) continue;
+
+        // --- buildup after adding time increment to equivalent days
+        //     of current buildup
+        days = getExponDays(f, buildup[p] / perUnit) + tStep / SECperDAY;
+        setBuildup(p, &buildup[p], getExponMass(f, days) * perUnit);
+    }
+}
+
+//=============================================================================
+
+void getSaturBuildup(int i, int k1, int k2, double area, double curb,
+                     int hasSnow, double buildup[], double tStep)
+//
+//  Input:   (same as getPowerBuildup)
+//  Output:  updates buildup[]
+//  Purpose: adds buildup to a group of pollutants with saturation function
+//           buildup (B = c0 * t / (c2 + t)).
+//
+{
+    int    k, p;
+    double days, perUnit;
+    TBuildup* f;
+
+    for (k = k1; k < k2; k++)
+    {
+        p = Landuse[i].buildupOrder[k];
+        if ( Pollut[p].snowOnly && !hasSnow ) continue;
+        f = &Landuse[i].buildupFunc[p];
+        perUnit = getPerUnit(f, area, curb);
+        if ( perUnit == 0.0 ) continue;
+
+        // --- buildup after adding time increment to equivalent days
+        //     of current buildup
+        days = getSaturDays(f, buildup[p] / perUnit) + tStep / SECperDAY;
+        setBuildup(p, &buildup[p], getSaturMass(f, days) * perUnit);
+    }
+}
+
+//=============================================================================
+
+void getExtBuildup(int i, int k1, int k2, double area, double curb,
+                   int hasSnow, double buildup[], double tStep)
+//
+//  Input:   (same as getPowerBuildup)
+//  Output:  updates buildup[]
+//  Purpose: adds buildup to a group of pollutants whose buildup is supplied
+//           by an external loading time series.
+//
+{
+    int    k, p;
+    double perUnit;
+
+    for (k = k1; k < k2; k++)
+    {
+        p = Landuse[i].buildupOrder[k];
+        if ( Pollut[p].snowOnly && !hasSnow ) continue;
+        perUnit = getPerUnit(&Landuse[i].buildupFunc[p], area, curb);
+        if ( perUnit == 0.0 ) continue;
+        setBuildup(p, &buildup[p], landuse_getExternalBuildup(i, p,
+                   buildup[p]/perUnit, tStep) * perUnit);
+    }
+}
+
+//=============================================================================
+
+double getBuildupDays(int i, int p, double buildup)
 //
 //  Input:   i = land use index
 //           p = pollutant index
@@ -466,34 +732,20 @@ double landuse_getBuildupDays(int i, int p, double buildup)
 //  Purpose: finds the number of days corresponding to a pollutant buildup.
 //
 {
-    double c0 = Landuse[i].buildupFunc[p].coeff[0];
-    double c1 = Landuse[i].buildupFunc[p].coeff[1];
-    double c2 = Landuse[i].buildupFunc[p].coeff[2];
+    TBuildup* f = &Landuse[i].buildupFunc[p];
 
-    if ( buildup == 0.0 ) return 0.0;
-    if ( buildup >= c0 ) return Landuse[i].buildupFunc[p].maxDays;   
-    switch (Landuse[i].buildupFunc[p].funcType)
+    switch (f->funcType)
     {
-      case POWER_BUILDUP:
-        if ( c1*c2 == 0.0 ) return 0.0;
-        else return pow( (buildup/c1), (1.0/c2) );
-
-      case EXPON_BUILDUP:
-        if ( c0*c1 == 0.0 ) return 0.0;
-        else return -log(1. - buildup/c0) / c1;
-
-      case SATUR_BUILDUP:
-        if ( c0 == 0.0 ) return 0.0;
-        else return buildup*c2 / (c0 - buildup);
-
-      default:
-        return 0.0;
+      case POWER_BUILDUP: return getPowerDays(f, buildup);
+      case EXPON_BUILDUP: return getExponDays(f, buildup);
+      case SATUR_BUILDUP: return getSaturDays(f, buildup);
+      default:            return 0.0;
     }
 }
 
 //=============================================================================
 
-double landuse_getBuildupMass(int i, int p, double days)
+double getBuildupMass(int i, int p, double days)
 //
 //  Input:   i = land use index
 //           p = pollutant index
@@ -502,35 +754,121 @@ double landuse_getBuildupMass(int i, int p, double days)
 //  Purpose: finds amount of buildup of pollutant on a land use.
 //
 {
-    double b;
-    double c0 = Landuse[i].buildupFunc[p].coeff[0];
-    double c1 = Landuse[i].buildupFunc[p].coeff[1];
-    double c2 = Landuse[i].buildupFunc[p].coeff[2];
+    TBuildup* f = &Landuse[i].buildupFunc[p];
 
-    if ( days == 0.0 ) return 0.0;
-    if ( days >= Landuse[i].buildupFunc[p].maxDays ) return c0;
-    switch (Landuse[i].buildupFunc[p].funcType)
+    switch (f->funcType)
     {
-      case POWER_BUILDUP:
-        b = c1 * pow(days, c2);
-        if ( b > c0 ) b = c0;
-        break;
+      case POWER_BUILDUP: return getPowerMass(f, days);
+      case EXPON_BUILDUP: return getExponMass(f, days);
+      case SATUR_BUILDUP: return getSaturMass(f, days);
+      default:            return 0.0;
+    }
+}
 
-      case EXPON_BUILDUP:
-        b = c0*(1.0 - exp(-days*c1));
-        break;
+//=============================================================================
 
-      case SATUR_BUILDUP:
-        b = days*c0/(c2 + days);
-        break;
+double getPowerDays(TBuildup* f, double buildup)
+//
+//  Input:   f = power function buildup (B = c1 * t^c2 up to a max. of c0)
+//           buildup = amount of pollutant buildup
+//  Output:  returns number of days it takes for buildup to reach a given level
+//  Purpose: finds the number of days corresponding to a power function
+//           buildup.
+//
+{
+    if ( buildup == 0.0 ) return 0.0;
+    if ( buildup >= f->coeff[0] ) return f->maxDays;
+    if ( f->coeff[1]*f->coeff[2] == 0.0 ) return 0.0;
+    return pow( (buildup/f->coeff[1]), (1.0/f->coeff[2]) );
+}
 
-      default: b = 0.0;
-    }
+//=============================================================================
+
+double getPowerMass(TBuildup* f, double days)
+//
+//  Input:   f = power function buildup (B = c1 * t^c2 up to a max. of c0)
+//           days = time over which buildup has occurred (days)
+//  Output:  returns mass of pollutant buildup (per area or curb length)
+//  Purpose: finds amount of power function buildup after a number of days.
+//
+{
+    double b;
+
+    if ( days == 0.0 ) return 0.0;
+    if ( days >= f->maxDays ) return f->coeff[0];
+    b = f->coeff[1] * pow(days, f->coeff[2]);
+    if ( b > f->coeff[0] ) b = f->coeff[0];
     return b;
 }
 
 //=============================================================================
 
+double getExponDays(TBuildup* f, double buildup)
+//
+//  Input:   f = exponential function buildup (B = c0 * (1 - exp(-c1 * t)))
+//           buildup = amount of pollutant buildup
+//  Output:  returns number of days it takes for buildup to reach a given level
+//  Purpose: finds the number of days corresponding to an exponential
+//           function buildup.
+//
+{
+    if ( buildup == 0.0 ) return 0.0;
+    if ( buildup >= f->coeff[0] ) return f->maxDays;
+    if ( f->coeff[0]*f->coeff[1] == 0.0 ) return 0.0;
+    return -log(1. - buildup/f->coeff[0]) / f->coeff[1];
+}
+
+//=============================================================================
+
+double getExponMass(TBuildup* f, double days)
+//
+//  Input:   f = exponential function buildup (B = c0 * (1 - exp(-c1 * t)))
+//           days = time over which buildup has occurred (days)
+//  Output:  returns mass of pollutant buildup (per area or curb length)
+//  Purpose: finds amount of exponential function buildup after a number
+//           of days.
+//
+{
+    if ( days == 0.0 ) return 0.0;
+    if ( days >= f->maxDays ) return f->coeff[0];
+    return f->coeff[0]*(1.0 - exp(-days*f->coeff[1]));
+}
+
+//=============================================================================
+
+double getSaturDays(TBuildup* f, double buildup)
+//
+//  Input:   f = saturation function buildup (B = c0 * t / (c2 + t))
+//           buildup = amount of pollutant buildup
+//  Output:  returns number of days it takes for buildup to reach a given level
+//  Purpose: finds the number of days corresponding to a saturation
+//           function buildup.
+//
+{
+    if ( buildup == 0.0 ) return 0.0;
+    if ( buildup >= f->coeff[0] ) return f->maxDays;
+    if ( f->coeff[0] == 0.0 ) return 0.0;
+    return buildup*f->coeff[2] / (f->coeff[0] - buildup);
+}
+
+//=============================================================================
+
+double getSaturMass(TBuildup* f, double days)
+//
+//  Input:   f = saturation function buildup (B = c0 * t / (c2 + t))
+//           days = time over which buildup has occurred (days)
+//  Output:  returns mass of pollutant buildup (per area or curb length)
+//  Purpose: finds amount of saturation function buildup after a number
+//           of days.
+//
+{
+    if ( days == 0.0 ) return 0.0;
+    if ( days >= f->maxDays ) return f->coeff[0];
+    return days*f->coeff[0]/(f->coeff[2] + days);
+}
+
+//=============================================================================
+
 double landuse_getAvgBmpEffic(int j, int p)
 //
 //  Input:   j = subcatchment index
@@ -552,32 +890,115 @@ double landuse_getAvgBmpEffic(int j, int p)
 
 //=============================================================================
 
-double landuse_getWashoffLoad(int i, int p, double area,
-    TLandFactor landFactor[], double runoff, double vOutflow)
+void  landuse_getWashoffLoads(int i, double area, TLandFactor landFactor[],
+                              double runoff, double vOutflow, double load[])
 //
 //  Input:   i = land use index
-//           p = pollut. index
 //           area = sucatchment area (ft2)
 //           landFactor[] = array of land use data for subcatchment
 //           runoff = runoff flow generated by subcatchment (ft/sec)
 //           vOutflow = runoff volume leaving the subcatchment (ft3)
+//           load[] = pollutant washoff loads (mass)
+//  Output:  adds the land use's washoff load of each pollutant to load[]
+//  Purpose: computes pollutant loads generated by a land use over a time
+//           step, evaluating one group of same-type washoff functions at
+//           a time.
+//
+//  Notes:   "coeff" for each washoff function was previously adjusted to
+//           result in units of mass/sec
+//
+{
+    int     k, p;
+    int*    group = Landuse[i].washoffGroup;
+    int*    order = Landuse[i].washoffOrder;
+    double  landuseArea;     // area of current land use (ft2)
+    double  buildup;         // current pollutant buildup (lb or kg)
+    double  cWashoff;        // pollutant concentration in washoff (mass/ft3)
+    double  coeff, expon;    // washoff function parameters
+
+    // --- no washoff if there is no runoff
+    if ( runoff == 0.0 ) return;
+    landuseArea = landFactor[i].fraction * area;
+
+    // --- Exponential Washoff function
+    //     (evaluated with runoff in in/hr (or mm/hr) and buildup
+    //     converted from lbs (or kg) to concen. mass units)
+    for (k = group[EXPON_WASHOFF]; k < group[EXPON_WASHOFF+1]; k++)
+    {
+        p = order[k];
+        buildup = landFactor[i].buildup[p];
+        cWashoff = 0.0;
+        if ( Landuse[i].buildupFunc[p].funcType == NO_BUILDUP ||
+             buildup != 0.0 )
+        {
+            coeff = Landuse[i].washoffFunc[p].coeff;
+            expon = Landuse[i].washoffFunc[p].expon;
+            cWashoff = coeff * pow(runoff * UCF(RAINFALL), expon) *
+                       buildup / Pollut[p].mcf;
+            cWashoff /= runoff * landuseArea;
+        }
+        load[p] += removeWashoff(i, p, cWashoff, landuseArea, landFactor,
+                                 area, vOutflow);
+    }
+
+    // --- Rating Curve Washoff function
+    for (k = group[RATING_WASHOFF]; k < group[RATING_WASHOFF+1]; k++)
+    {
+        p = order[k];
+        buildup = landFactor[i].buildup[p];
+        cWashoff = 0.0;
+        if ( Landuse[i].buildupFunc[p].funcType == NO_BUILDUP ||
+             buildup != 0.0 )
+        {
+            coeff = Landuse[i].washoffFunc[p].coeff;
+            expon = Landuse[i].washoffFunc[p].expon;
+            cWashoff = coeff * pow(runoff * landuseArea, expon-1.0);
+        }
+        load[p] += removeWashoff(i, p, cWashoff, landuseArea, landFactor,
+                                 area, vOutflow);
+    }
+
+    // --- Event Mean Concentration Washoff
+    //     (coeff includes LperFT3 factor)
+    for (k = group[EMC_WASHOFF]; k < group[EMC_WASHOFF+1]; k++)
+    {
+        p = order[k];
+        buildup = landFactor[i].buildup[p];
+        cWashoff = 0.0;
+        if ( Landuse[i].buildupFunc[p].funcType == NO_BUILDUP ||
+             buildup != 0.0 )
+        {
+            cWashoff = Landuse[i].washoffFunc[p].coeff;
+        }
+        load[p] += removeWashoff(i, p, cWashoff, landuseArea, landFactor,
+                                 area, vOutflow);
+    }
+}
+
+//=============================================================================
+
+double removeWashoff(int i, int p, double washoffQual, double landuseArea,
+                     TLandFactor landFactor[], double area, double vOutflow)
+//
+//  Input:   i = land use index
+//           p = pollut. index
+//           washoffQual = pollutant concentration in washoff (mass/ft3)
+//           landuseArea = area of land use (ft2)
+//           landFactor[] = array of land use data for subcatchment
+//           area = sucatchment area (ft2)
+//           vOutflow = runoff volume leaving the subcatchment (ft3)
 //  Output:  returns pollutant runoff load (mass)
-//  Purpose: computes pollutant load generated by a land use over a time step.
+//  Purpose: removes the washoff load of a pollutant from a land use's
+//           buildup and applies any BMP removal to it.
 //
 {
-    double landuseArea;      // area of current land use (ft2)
     double buildup;          // current pollutant buildup (lb or kg)
-    double washoffQual;      // pollutant concentration in washoff (mass/ft3)
     double washoffLoad;      // pollutant washoff load over time step (lb or kg)
     double bmpRemoval;       // pollutant load removed by BMP treatment (lb or kg)
 
-    // --- compute concen. of pollutant in washoff (mass/ft3)
-    buildup = landFactor[i].buildup[p];
-    landuseArea = landFactor[i].fraction * area;
-    washoffQual = landuse_getWashoffQual(i, p, buildup, runoff, landuseArea);
-
     // --- compute washoff load exported (lbs or kg) from landuse
     //     (Pollut[].mcf converts from mg (or ug) mass units to lbs (or kg)
+    buildup = landFactor[i].buildup[p];
     washoffLoad = washoffQual * vOutflow * landuseArea / area * Pollut[p].mcf;
 
     // --- if buildup modelled, reduce it by amount of washoff
@@ -596,7 +1017,7 @@ double landuse_getWashoffLoad(int i, int p, double area,
         massbal_updateLoadingTotals(BUILDUP_LOAD, p, washoffLoad);
         landFactor[i].buildup[p] = 0.0;
     }
-	
+
     // --- apply any BMP removal to washoff
     bmpRemoval = Landuse[i].washoffFunc[p].bmpEffic * washoffLoad;
     if ( bmpRemoval > 0.0 )
@@ -611,59 +1032,6 @@ double landuse_getWashoffLoad(int i, int p, double area,
 
 //=============================================================================
 
-double landuse_getWashoffQual(int i, int p, double buildup, double runoff,
-                              double area)
-//
-//  Input:   i = land use index
-//           p = pollutant index
-//           buildup = current buildup over land use (lbs or kg)
-//           runoff = current runoff on subcatchment (ft/sec)
-//           area = area devoted to land use (ft2)
-//  Output:  returns pollutant concentration in washoff (mass/ft3)
-//  Purpose: finds concentration of pollutant washed off a land use.
-//
-//  Notes:   "coeff" for each washoff function was previously adjusted to
-//           result in units of mass/sec
-//
-{
-    double cWashoff = 0.0;
-    double coeff = Landuse[i].washoffFunc[p].coeff;
-    double expon = Landuse[i].washoffFunc[p].expon;
-    int    func  = Landuse[i].washoffFunc[p].funcType;
-
-    // --- if no washoff function or no runoff, return 0
-    if ( func == NO_WASHOFF || runoff == 0.0 ) return 0.0;
-    
-    // --- if buildup function exists but no current buildup, return 0
-    if ( Landuse[i].buildupFunc[p].funcType != NO_BUILDUP && buildup == 0.0 )
-        return 0.0;
-
-    // --- Exponential Washoff function
-    if ( func == EXPON_WASHOFF )
-    {
-        // --- evaluate washoff eqn. with runoff in in/hr (or mm/hr)
-        //     and buildup converted from lbs (or kg) to concen. mass units
-        cWashoff = coeff * pow(runoff * UCF(RAINFALL), expon) *
-                  buildup / Pollut[p].mcf;
-        cWashoff /= runoff * area;
-    }
-
-    // --- Rating Curve Washoff function
-    else if ( func == RATING_WASHOFF )
-    {
-        cWashoff = coeff * pow(runoff * area, expon-1.0);
-    }
-
-    // --- Event Mean Concentration Washoff
-    else if ( func == EMC_WASHOFF )
-    {
-        cWashoff = coeff;     // coeff includes LperFT3 factor
-    }
-    return cWashoff;
-}
-
-//=============================================================================
-
 double landuse_getCoPollutLoad(int p, double washoff[])
 //
 //  Input:   p = pollutant index
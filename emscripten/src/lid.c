@@ -33,11 +33,13 @@
 //   TLidGroup list data structure. The LidGroups array contains a TLidGroup
 //   list for each subcatchment in the project.
 //
-//   During a runoff time step, each subcatchment calls the lid_getRunoff()
-//   function to compute flux rates and a water balance through each layer
-//   of each LID unit in the subcatchment. The resulting outflows (runoff,
-//   drain flow, evaporation and infiltration) are added to those computed
-//   for the non-LID portion of the subcatchment.
+//   During a runoff time step, the lid_evalUnits() function computes flux
+//   rates and a water balance through each layer of every LID unit in the
+//   project, with units of the same type evaluated together. Each
+//   subcatchment then calls the lid_getRunoff() function to add the
+//   resulting outflows (runoff, drain flow, evaporation and infiltration)
+//   of its LID units to those computed for the non-LID portion of the
+//   subcatchment.
 //
 //   An option exists for the detailed time series of flux rates and storage
 //   levels for a specific LID unit to be written to a text file named by the
@@ -146,6 +148,11 @@ struct LidGroup
     double         flowToPerv;    // total flow sent to pervious area (cfs)
     double         oldDrainFlow;  // total drain flow in previous period (cfs)
     double         newDrainFlow;  // total drain flow in current period (cfs)
+    double         qImperv;       // imperv. area runoff treated by LIDs (cfs)
+    double         qPerv;         // perv. area runoff treated by LIDs (cfs)
+    double         evapRate;      // evaporation rate (ft/s)
+    double         nativeInfil;   // native soil infil. rate (ft/s)
+    double         maxInfil;      // native soil infil. rate limit (ft/s)
     TLidList*      lidList;       // list of LID units in the group
 };
 typedef struct LidGroup* TLidGroup;
@@ -159,9 +166,13 @@ static int        LidCount;            // number of LID processes
 static TLidGroup* LidGroups;           // array of LID process groups
 static int        GroupCount;          // number of LID groups (subcatchments)
 
-static double     EvapRate;            // evaporation rate (ft/s)
-static double     NativeInfil;         // native soil infil. rate (ft/s)
-static double     MaxNativeInfil;      // native soil infil. rate limit (ft/s)
+// LID units of all groups, ordered by type of LID process
+static int        UnitCount;           // number of LID units
+static TLidUnit** UnitList;            // ptr. to each LID unit
+static int*       UnitGroup;           // group (subcatchment) of each LID unit
+#ifdef _OPENMP
+static const int  MIN_BATCH_SIZE = 64; // min. no. of LID units done in parallel
+#endif
 
 //-----------------------------------------------------------------------------
 //  Imported Variables (from SUBCATCH.C)
@@ -169,7 +180,6 @@ static double     MaxNativeInfil;      // native soil infil. rate limit (ft/s)
 // Volumes (ft3) for a subcatchment over a time step 
 extern double     Vevap;               // evaporation
 extern double     Vpevap;              // pervious area evaporation
-extern double     Vinfil;              // non-LID infiltration
 extern double     VlidInfil;           // infiltration from LID units
 extern double     VlidIn;              // impervious area flow to LID units
 extern double     VlidOut;             // surface outflow from LID units
@@ -194,13 +204,19 @@ extern char       HasWetLids;          // TRUE if any LIDs are wet
 //  lid_getReturnQual        called by subcatch_getRunon
 
 //  lid_getPervArea          called by subcatch_getFracPerv
-//  lid_getFlowToPerv        called by subcatch_getRunon
+//  lid_getFlowToPerv        called by getSubareaRunon in subcatch.c
 //  lid_getSurfaceDepth      called by subcatch_getDepth
 //  lid_getDepthOnPavement   called by sweptSurfacesDry in subcatch.c
 //  lid_getStoredVolume      called by subcatch_getStorage
 //  lid_getRunon             called by subcatch_getRunon
+//  lid_openBatch            called by runoff_open
+//  lid_closeBatch           called by runoff_close
+//  lid_evalUnits            called by runoff_execute
 //  lid_getRunoff            called by subcatch_getRunoff
 
+//  lid_getUnitCount         called by subcatch_openRunon
+//  lid_getUnits             called by subcatch_openRunon
+//  lid_getDrainSubcatch     called by subcatch_openRunon
 //  lid_addDrainRunon        called by subcatch_getRunon
 //  lid_addDrainLoads        called by surfqual_getWashoff
 //  lid_addDrainInflow       called by addLidDrainInflows in routing.c
@@ -235,9 +251,11 @@ static double getPervAreaRunoff(int j);                                        /
 static double getSurfaceDepth(int subcatch);
 static void   findNativeInfil(int j, double tStep);
 
+static int    isGroupActive(int j);
+static void   setGroupInflows(int j, double tStep);
 static void   evalLidUnit(int j, TLidUnit* lidUnit, double lidArea,
-              double lidInflow, double tStep, double *qRunoff,
-              double *qDrain, double *qReturn);
+              double tStep, double *qRunoff, double *qDrain,
+              double *qReturn);
 
 //=============================================================================
 
@@ -254,6 +272,9 @@ void lid_create(int lidCount, int subcatchCount)
     LidProcs = NULL;
     LidGroups = NULL;
     LidCount = lidCount;
+    UnitCount = 0;
+    UnitList = NULL;
+    UnitGroup = NULL;
 
     //... create LID groups
     GroupCount = subcatchCount;
@@ -332,11 +353,13 @@ void freeLidGroup(int j)
 //  Input:   j = group (or subcatchment) index
 //  Output:  none
 //
+//  Note: the group, its list and its LID units are allocated from the
+//        project's memory pool, so only their report files are freed here.
+//
 {
     TLidGroup  lidGroup = LidGroups[j];
     TLidList*  lidList;
     TLidUnit*  lidUnit;
-    TLidList*  nextLidUnit;
 
     if ( lidGroup == NULL ) return;
     lidList = lidGroup->lidList;
@@ -345,15 +368,13 @@ void freeLidGroup(int j)
         lidUnit = lidList->lidUnit;
         if ( lidUnit->rptFile )
         {
+            lidproc_flushRptFile(lidUnit->rptFile);
             if ( lidUnit->rptFile->file ) fclose(lidUnit->rptFile->file);
+            FREE(lidUnit->rptFile->buffer);
             free(lidUnit->rptFile);
         }
-        nextLidUnit = lidList->nextLidUnit;
-        free(lidUnit);
-        free(lidList);
-        lidList = nextLidUnit;
+        lidList = lidList->nextLidUnit;
     }
-    free(lidGroup);
     LidGroups[j] = NULL;
 }
 
@@ -526,24 +547,20 @@ int addLidUnit(int j, int k, int n, double x[], char* fname,
     lidGroup = LidGroups[j];
     if ( !lidGroup )
     {
-        lidGroup = (struct LidGroup *) malloc(sizeof(struct LidGroup));
+        lidGroup = (struct LidGroup *) project_alloc(1, sizeof(struct LidGroup));
         if ( !lidGroup ) return error_setInpError(ERR_MEMORY, "");
         lidGroup->lidList = NULL;
         LidGroups[j] = lidGroup;
     }
 
     //... create a new LID unit to add to the group
-    lidUnit = (TLidUnit *) malloc(sizeof(TLidUnit));
+    lidUnit = (TLidUnit *) project_alloc(1, sizeof(TLidUnit));
     if ( !lidUnit ) return error_setInpError(ERR_MEMORY, "");
     lidUnit->rptFile = NULL;
 
     //... add the LID unit to the group
-    lidList = (TLidList *) malloc(sizeof(TLidList));
-    if ( !lidList )
-    {
-        free(lidUnit);
-        return error_setInpError(ERR_MEMORY, "");
-    }
+    lidList = (TLidList *) project_alloc(1, sizeof(TLidList));
+    if ( !lidList ) return error_setInpError(ERR_MEMORY, "");
     lidList->lidUnit = lidUnit;
     lidList->nextLidUnit = lidGroup->lidList;
     lidGroup->lidList = lidList;
@@ -578,8 +595,10 @@ int createLidRptFile(TLidUnit* lidUnit, char* fname)
     rptFile = (TLidRptFile *) malloc(sizeof(TLidRptFile));
     if ( rptFile == NULL ) return 0;
     lidUnit->rptFile = rptFile;
+    rptFile->bufLen = 0;
+    rptFile->buffer = (char *) malloc(RPT_BUFSIZE);
     rptFile->file = fopen(fname, "wt");
-    if ( rptFile->file == NULL ) return 0;
+    if ( rptFile->file == NULL || rptFile->buffer == NULL ) return 0;
     return 1;
 }
 
@@ -1502,52 +1521,94 @@ void  lid_addDrainLoads(int j, double c[], double tStep)
 
 //=============================================================================
 
-void lid_addDrainRunon(int j)
+int lid_getUnitCount(int j)
+//
+//  Purpose: counts the LID units placed in a given subcatchment.
+//  Input:   j = subcatchment index
+//  Output:  returns number of LID units in the subcatchment
+//
+{
+    int n = 0;
+    TLidList* lidList;
+
+    if ( LidGroups[j] == NULL ) return 0;
+    for (lidList = LidGroups[j]->lidList; lidList;
+         lidList = lidList->nextLidUnit) n++;
+    return n;
+}
+
+//=============================================================================
+
+int lid_getUnits(int j, TLidUnit* units[])
+//
+//  Purpose: lists the LID units placed in a given subcatchment.
+//  Input:   j = subcatchment index
+//           units = array with room for lid_getUnitCount(j) entries
+//  Output:  returns number of LID units in the subcatchment and fills
+//           units with pointers to them in the order they were placed
+//
+{
+    int n = 0;
+    TLidList* lidList;
+
+    if ( LidGroups[j] == NULL ) return 0;
+    for (lidList = LidGroups[j]->lidList; lidList;
+         lidList = lidList->nextLidUnit) units[n++] = lidList->lidUnit;
+    return n;
+}
+
+//=============================================================================
+
+int lid_getDrainSubcatch(int j, TLidUnit* lidUnit)
 //
-//  Purpose: adds drain flows from LIDs in a given subcatchment to the
-//           subcatchments that were designated to receive them 
-//  Input:   j = index of subcatchment contributing underdrain flows
+//  Purpose: finds the subcatchment that receives drain flow from an LID unit.
+//  Input:   j = index of subcatchment containing the LID unit
+//           lidUnit = ptr. to the LID unit
+//  Output:  returns index of subcatchment receiving the unit's drain flow
+//           (-1 if the drain flow does not go to another subcatchment)
+//
+{
+    if ( lidUnit->drainSubcatch == j ) return -1;
+    return lidUnit->drainSubcatch;
+}
+
+//=============================================================================
+
+void lid_addDrainRunon(int j, TLidUnit* lidUnit)
+//
+//  Purpose: adds drain flow from an LID unit in a given subcatchment to the
+//           subcatchment that was designated to receive it 
+//  Input:   j = index of subcatchment contributing underdrain flow
+//           lidUnit = ptr. to the LID unit
 //  Output:  none.
 //
+//  Only the receiving subcatchment is modified, so different receivers
+//  can be updated concurrently (see subcatch_getRunon).
+//
 {
     int i;                   // index of an LID unit's LID process             //(5.1.013)
     int k;                   // index of subcatchment receiving LID drain flow
     int p;                   // pollutant index
     double q;                // drain flow rate (cfs)
     double w;                // mass of polllutant from drain flow             //(5.1.013)
-    TLidUnit*  lidUnit;
-    TLidList*  lidList; 
-    TLidGroup  lidGroup; 
 
-    //... check if LID group exists
-    lidGroup = LidGroups[j];
-    if ( lidGroup != NULL )
+    //... see if LID's drain discharges to another subcatchment
+    i = lidUnit->lidIndex;                                                     //(5.1.013)
+    k = lidUnit->drainSubcatch;
+    if ( k >= 0 && k != j )
     {
-        //... examine each LID in the group
-        lidList = lidGroup->lidList;
-        while ( lidList )
+        //... distribute drain flow across subcatchment's areas
+        q = lidUnit->oldDrainFlow;
+        subcatch_addRunonFlow(k, q);
+
+        //... add pollutant loads from drain to subcatchment
+        //    (newQual[] contains loading rate (mass/sec) at this
+        //    point which is converted later on to a concentration)
+        for (p = 0; p < Nobjects[POLLUT]; p++)
         {
-            //... see if LID's drain discharges to another subcatchment
-            lidUnit = lidList->lidUnit;
-            i = lidUnit->lidIndex;                                             //(5.1.013)
-            k = lidUnit->drainSubcatch;
-            if ( k >= 0 && k != j )
-            {
-                //... distribute drain flow across subcatchment's areas
-                q = lidUnit->oldDrainFlow;
-                subcatch_addRunonFlow(k, q);
-
-                //... add pollutant loads from drain to subcatchment
-                //    (newQual[] contains loading rate (mass/sec) at this
-                //    point which is converted later on to a concentration)
-                for (p = 0; p < Nobjects[POLLUT]; p++)
-                {
-                    w = q * Subcatch[j].oldQual[p] * LperFT3;                  //(5.1.013)
-                    w = w * (1.0 - LidProcs[i].drainRmvl[p]);                  //
-                    Subcatch[k].newQual[p] += w;                               //
-                }
-            }
-            lidList = lidList->nextLidUnit;
+            w = q * Subcatch[j].oldQual[p] * LperFT3;                          //(5.1.013)
+            w = w * (1.0 - LidProcs[i].drainRmvl[p]);                          //
+            Subcatch[k].newQual[p] += w;                                       //
         }
     }
 }
@@ -1614,6 +1675,206 @@ void  lid_addDrainInflow(int j, double f)
 
 //=============================================================================
 
+int lid_openBatch()
+//
+//  Purpose: lists the LID units of all subcatchments so they can be
+//           evaluated together in a single batch.
+//  Input:   none
+//  Output:  returns an error code
+//
+//  Units are ordered by the type of their LID process so that units which
+//  share the same flux rate functions are evaluated one after another.
+//
+{
+    int        j, k, n;
+    int        count[ROOF_DISCON+3];
+    TLidList*  lidList;
+
+    //... count the LID units of each type
+    UnitCount = 0;
+    for (k = 0; k < ROOF_DISCON+3; k++) count[k] = 0;
+    for (j = 0; j < GroupCount; j++)
+    {
+        if ( LidGroups[j] == NULL ) continue;
+        lidList = LidGroups[j]->lidList;
+        while ( lidList )
+        {
+            k = LidProcs[lidList->lidUnit->lidIndex].lidType + 1;
+            count[k+1]++;
+            UnitCount++;
+            lidList = lidList->nextLidUnit;
+        }
+    }
+    if ( UnitCount == 0 ) return 0;
+
+    //... allocate the unit arrays
+    UnitList = (TLidUnit **) calloc(UnitCount, sizeof(TLidUnit *));
+    UnitGroup = (int *) calloc(UnitCount, sizeof(int));
+    if ( UnitList == NULL || UnitGroup == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        UnitCount = 0;
+        return ErrorCode;
+    }
+
+    //... place each unit in the position assigned to its type
+    for (k = 1; k < ROOF_DISCON+3; k++) count[k] += count[k-1];
+    for (j = 0; j < GroupCount; j++)
+    {
+        if ( LidGroups[j] == NULL ) continue;
+        lidList = LidGroups[j]->lidList;
+        while ( lidList )
+        {
+            k = LidProcs[lidList->lidUnit->lidIndex].lidType + 1;
+            n = count[k]++;
+            UnitList[n] = lidList->lidUnit;
+            UnitGroup[n] = j;
+            lidList = lidList->nextLidUnit;
+        }
+    }
+    return 0;
+}
+
+//=============================================================================
+
+void lid_closeBatch()
+//
+//  Purpose: frees the list of LID units made by lid_openBatch after
+//           writing out any buffered report file results.
+//  Input:   none
+//  Output:  none
+//
+{
+    int k;
+
+    for (k = 0; k < UnitCount; k++)
+    {
+        if ( UnitList[k]->rptFile ) lidproc_flushRptFile(UnitList[k]->rptFile);
+    }
+    FREE(UnitList);
+    FREE(UnitGroup);
+    UnitCount = 0;
+}
+
+//=============================================================================
+
+void lid_evalUnits(double tStep)
+//
+//  Purpose: computes the outflows from all LID units over a time step.
+//  Input:   tStep = time step (sec)
+//  Output:  none
+//
+//  Must be called after the runoff from the non-LID portion of every
+//  subcatchment has been found (see subcatch_getNonLidRunoff) and before
+//  lid_getRunoff tallies up the results of each subcatchment's LID units.
+//  Each unit only changes its own state, so units are evaluated in parallel.
+//
+{
+    int        j, k;
+    double     lidArea;           // area of an LID unit
+    double     lidInflow;         // inflow to an LID unit (ft/s)
+    double     lidEvap;           // evaporation rate from LID unit (ft/s)
+    double     lidInfil;          // infiltration rate from LID unit (ft/s)
+    double     lidDrain;          // drain flow rate from LID unit (ft/s)
+    TLidGroup  theLidGroup;
+    TLidUnit*  lidUnit;
+
+    if ( UnitCount == 0 ) return;
+#pragma omp parallel private(j, k, lidArea, lidInflow, lidEvap, lidInfil, \
+    lidDrain, theLidGroup, lidUnit) num_threads(NumThreads) \
+    if(NumThreads > 1 && UnitCount >= MIN_BATCH_SIZE)
+    {
+        //... find the inflow conditions shared by each group's LID units
+#pragma omp for schedule(static)
+        for (j = 0; j < GroupCount; j++)
+        {
+            if ( isGroupActive(j) ) setGroupInflows(j, tStep);
+        }
+
+        //... evaluate each LID unit placed in an active group
+#pragma omp for schedule(static)
+        for (k = 0; k < UnitCount; k++)
+        {
+            //... find area of the LID unit
+            j = UnitGroup[k];
+            lidUnit = UnitList[k];
+            lidArea = lidUnit->area * lidUnit->number;
+            if ( lidArea <= 0.0 || !isGroupActive(j) ) continue;
+            theLidGroup = LidGroups[j];
+
+            //... find runoff from non-LID area treated by LID area (ft/sec)
+            lidInflow = (theLidGroup->qImperv * lidUnit->fromImperv +
+                         theLidGroup->qPerv * lidUnit->fromPerv) / lidArea;
+
+            //... add rainfall onto LID inflow (ft/s)
+            lidInflow = lidInflow + Subcatch[j].rainfall;
+
+            // ... add upstream runon only if LID occupies full subcatchment
+            if ( Subcatch[j].area == Subcatch[j].lidArea )
+            {
+                lidInflow += Subcatch[j].runon;
+            }
+
+            //... find the unit's flux rates (its soil layer's infiltration
+            //    uses the subcatchment's conductivity adjustment)
+            infil_setInfilFactor(j);
+            lidproc_getOutflow(lidUnit, &LidProcs[lidUnit->lidIndex], lidInflow,
+                               theLidGroup->evapRate, theLidGroup->nativeInfil,
+                               theLidGroup->maxInfil, tStep,
+                               &lidEvap, &lidInfil, &lidDrain);
+        }
+    }
+}
+
+//=============================================================================
+
+int isGroupActive(int j)
+//
+//  Purpose: determines if a subcatchment's LID units are evaluated
+//           over the current time step.
+//  Input:   j = subcatchment index
+//  Output:  returns TRUE if the subcatchment has LID units to evaluate
+//
+{
+    if ( LidGroups[j] == NULL || LidGroups[j]->lidList == NULL ) return FALSE;
+    return ( Subcatch[j].area != 0.0 && Subcatch[j].lidArea > 0.0 );
+}
+
+//=============================================================================
+
+void setGroupInflows(int j, double tStep)
+//
+//  Purpose: finds the evaporation, native soil infiltration and non-LID
+//           area runoff shared by all of a subcatchment's LID units.
+//  Input:   j     = subcatchment index
+//           tStep = time step (sec)
+//  Output:  none
+//
+{
+    TLidGroup theLidGroup = LidGroups[j];
+
+    //... determine if evaporation can occur
+    theLidGroup->evapRate = Evap.rate;
+    if ( Evap.dryOnly && Subcatch[j].rainfall > 0.0 )
+        theLidGroup->evapRate = 0.0;
+
+    //... find subcatchment's infiltration rate into native soil
+    infil_setInfilFactor(j);
+    findNativeInfil(j, tStep);
+
+    //... get impervious and pervious area runoff from non-LID
+    //    portion of subcatchment (cfs)
+    theLidGroup->qImperv = 0.0;
+    theLidGroup->qPerv = 0.0;
+    if ( Subcatch[j].area > Subcatch[j].lidArea )
+    {
+        theLidGroup->qImperv = getImpervAreaRunoff(j);
+        theLidGroup->qPerv = getPervAreaRunoff(j);
+    }
+}
+
+//=============================================================================
+
 void lid_getRunoff(int j, double tStep)
 //
 //  Purpose: computes runoff and drain flows from the LIDs in a subcatchment.
@@ -1622,13 +1883,14 @@ void lid_getRunoff(int j, double tStep)
 //  Output:  updates following global quantities after LID treatment applied:
 //           Vevap, Vpevap, VlidInfil, VlidIn, VlidOut, VlidDrain.
 //
+//  The flux rates through each LID unit must have already been found by
+//  lid_evalUnits.
+//
 {
     TLidGroup  theLidGroup;       // group of LIDs placed in the subcatchment
     TLidList*  lidList;           // list of LID units in the group
     TLidUnit*  lidUnit;           // a member of the list of LID units
     double lidArea;               // area of an LID unit
-    double qImperv = 0.0;         // runoff from impervious areas (cfs)
-    double qPerv = 0.0;           // runoff from pervious areas (cfs)          //(5.1.013)
     double lidInflow = 0.0;       // inflow to an LID unit (ft/s) 
     double qRunoff = 0.0;         // surface runoff from all LID units (cfs)
     double qDrain = 0.0;          // drain flow from all LID units (cfs)
@@ -1640,51 +1902,26 @@ void lid_getRunoff(int j, double tStep)
     lidList = theLidGroup->lidList;
     if ( !lidList ) return;
 
-    //... determine if evaporation can occur
-    EvapRate = Evap.rate;
-    if ( Evap.dryOnly && Subcatch[j].rainfall > 0.0 ) EvapRate = 0.0;
-
-    //... find subcatchment's infiltration rate into native soil
-    findNativeInfil(j, tStep);
-
-    //... get impervious and pervious area runoff from non-LID
-    //    portion of subcatchment (cfs)
-    if ( Subcatch[j].area > Subcatch[j].lidArea )
-    {    
-        qImperv = getImpervAreaRunoff(j);
-        qPerv = getPervAreaRunoff(j);                                          //(5.1.013)
-    }
-
-    //... evaluate performance of each LID unit placed in the subcatchment
+    //... tally up the performance of each LID unit placed in the subcatchment
     while ( lidList )
     {
         //... find area of the LID unit
         lidUnit = lidList->lidUnit;
         lidArea = lidUnit->area * lidUnit->number;
 
-        //... if LID unit has area, evaluate its performance
+        //... if LID unit has area, add in its performance
         if ( lidArea > 0.0 )
         {
             //... find runoff from non-LID area treated by LID area (ft/sec)
-            lidInflow = (qImperv * lidUnit->fromImperv +                       //(5.1.013)
-                         qPerv * lidUnit->fromPerv) / lidArea;                 //
+            lidInflow = (theLidGroup->qImperv * lidUnit->fromImperv +
+                         theLidGroup->qPerv * lidUnit->fromPerv) / lidArea;
 
             //... update total runoff volume treated
             VlidIn += lidInflow * lidArea * tStep;
 
-            //... add rainfall onto LID inflow (ft/s)
-            lidInflow = lidInflow + Subcatch[j].rainfall;
-
-            // ... add upstream runon only if LID occupies full subcatchment
-            if ( Subcatch[j].area == Subcatch[j].lidArea )
-            {
-                lidInflow += Subcatch[j].runon;
-            }
-
-            //... evaluate the LID unit's performance, updating the LID group's
-            //    total surface runoff, drain flow, and flow returned to
-            //    pervious area 
-            evalLidUnit(j, lidUnit, lidArea, lidInflow, tStep,
+            //... update the LID group's total surface runoff, drain flow,
+            //    and flow returned to pervious area 
+            evalLidUnit(j, lidUnit, lidArea, tStep,
                         &qRunoff, &qDrain, &qReturn);
         }
         lidList = lidList->nextLidUnit;
@@ -1708,22 +1945,25 @@ void findNativeInfil(int j, double tStep)
 //           its native soil.
 //  Input:   j = subcatchment index
 //           tStep    = time step (sec)
-//  Output:  sets values for module-level variables NativeInfil
+//  Output:  sets values for the nativeInfil and maxInfil members
+//           of the subcatchment's LID group
 //
 {
     double nonLidArea;
+    TLidGroup theLidGroup = LidGroups[j];
 
     //... subcatchment has non-LID pervious area
     nonLidArea = Subcatch[j].area - Subcatch[j].lidArea;
     if ( nonLidArea > 0.0 && Subcatch[j].fracImperv < 1.0 )
     {
-        NativeInfil = Vinfil / nonLidArea / tStep;
+        theLidGroup->nativeInfil =
+            Subcatch[j].surfBalance.infil / nonLidArea / tStep;
     }
 
     //... otherwise find infil. rate for the subcatchment's rainfall + runon
     else
     {
-        NativeInfil = infil_getInfil(j, tStep,
+        theLidGroup->nativeInfil = infil_getInfil(j, tStep,
                                      Subcatch[j].rainfall,
                                      Subcatch[j].runon,
                                      getSurfaceDepth(j));                      //(5.1.015)
@@ -1732,9 +1972,10 @@ void findNativeInfil(int j, double tStep)
     //... see if there is any groundwater-imposed limit on infil.
     if ( !IgnoreGwater && Subcatch[j].groundwater )
     {
-        MaxNativeInfil = Subcatch[j].groundwater->maxInfilVol / tStep;
+        theLidGroup->maxInfil =
+            Subcatch[j].groundwater->maxInfilVol / tStep;
     }
-    else MaxNativeInfil = BIG;
+    else theLidGroup->maxInfil = BIG;
 }
 
 //=============================================================================
@@ -1797,37 +2038,32 @@ double getPervAreaRunoff(int j)
 
 //=============================================================================
 
-void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double lidInflow,
-    double tStep, double *qRunoff, double *qDrain, double *qReturn)
+void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double tStep,
+    double *qRunoff, double *qDrain, double *qReturn)
 //
-//  Purpose: evaluates performance of a specific LID unit over current time step.
+//  Purpose: adds the performance of a specific LID unit over current time
+//           step to its LID group's totals.
 //  Input:   j         = subcatchment index
 //           lidUnit   = ptr. to LID unit being evaluated
 //           lidArea   = area of LID unit
-//           lidInflow = inflow to LID unit (ft/s)
 //           tStep     = time step (sec)
 //  Output:  qRunoff   = sum of surface runoff from all LIDs (cfs)
 //           qDrain    = sum of drain flows from all LIDs (cfs)
 //           qReturn   = sum of LID flows returned to pervious area (cfs)
 //
 {
-    TLidProc* lidProc;       // LID process associated with lidUnit
     double lidRunoff,        // surface runoff from LID unit (cfs)
            lidEvap,          // evaporation rate from LID unit (ft/s)
            lidInfil,         // infiltration rate from LID unit (ft/s)
            lidDrain;         // drain flow rate from LID unit (ft/s & cfs)
 
-    //... identify the LID process of the LID unit being analyzed
-    lidProc = &LidProcs[lidUnit->lidIndex];
-
-    //... initialize evap and infil losses
-    lidEvap = 0.0;
-    lidInfil = 0.0;
+    //... retrieve the unit's evap and infil losses
+    lidEvap = lidUnit->fluxes.evap;
+    lidInfil = lidUnit->fluxes.storExfil;
+    lidDrain = lidUnit->fluxes.storDrain;
 
     //... find surface runoff from the LID unit (in cfs)
-    lidRunoff = lidproc_getOutflow(lidUnit, lidProc, lidInflow, EvapRate,
-                                  NativeInfil, MaxNativeInfil, tStep,
-                                  &lidEvap, &lidInfil, &lidDrain) * lidArea;
+    lidRunoff = lidUnit->fluxes.surfOutflow * lidArea;
     
     //... convert drain flow to CFS
     lidDrain *= lidArea;
@@ -2018,5 +2254,5 @@ void initLidRptFile(char* title, char* lidID, char* subcatchID, TLidUnit* lidUni
 
     //... initialize LID dryness state
     lidUnit->rptFile->wasDry = 1;
-    strcpy(lidUnit->rptFile->results, "");
+    lidUnit->rptFile->bufLen = 0;
 }
@@ -64,10 +64,26 @@ enum TimePeriod {
     PREVIOUS,                // previous time period
     CURRENT};                // current time period
 
+enum LidRptVars {
+    SURF_INFLOW,             // inflow to surface layer
+    TOTAL_EVAP,              // evaporation rate from all layers
+    SURF_INFIL,              // infiltration into surface layer
+    PAVE_PERC,               // percolation through pavement layer
+    SOIL_PERC,               // percolation through soil layer
+    STOR_EXFIL,              // exfiltration out of storage layer
+    SURF_OUTFLOW,            // outflow from surface layer
+    STOR_DRAIN,              // outflow from storage layer
+    SURF_DEPTH,              // ponded depth on surface layer
+    PAVE_DEPTH,              // water level in pavement layer
+    SOIL_MOIST,              // moisture content of soil layer
+    STOR_DEPTH,              // water level in storage layer
+    MAX_RPT_VARS};
+
 //-----------------------------------------------------------------------------
 //  Data Structures
 //-----------------------------------------------------------------------------
 #define MAX_LAYERS 4
+#define RPT_BUFSIZE 16384    // size of a LID report file's output buffer
 
 // LID Surface Layer
 typedef struct
@@ -166,9 +182,26 @@ typedef struct
 {
     FILE*     file;               // file pointer
     int       wasDry;             // number of successive dry periods
-    char      results[256];       // results for current time period
+    double    rptTime;            // elapsed time of saved results (msec)
+    double    results[MAX_RPT_VARS]; // results for current time period
+    char*     buffer;             // results waiting to be written to file
+    int       bufLen;             // number of characters in buffer
 }   TLidRptFile;
 
+// LID Flux Rates - fluxes through a LID unit over the current time step
+typedef struct
+{
+    double   inflow;         // precip. + runon to surface layer (ft/s)
+    double   surfInfil;      // infil. rate from surface layer (ft/s)
+    double   surfOutflow;    // outflow from surface layer (ft/s)
+    double   evap;           // total evaporation rate (ft/s)
+    double   pavePerc;       // percolation from pavement layer (ft/s)
+    double   soilPerc;       // percolation from soil layer (ft/s)
+    double   storExfil;      // exfil. rate from storage layer (ft/s)
+    double   storDrain;      // underdrain flow rate (ft/s)
+    double   volume;         // total volume stored in unit (ft)
+}  TLidFluxes;
+
 // LID Unit - specific LID process applied over a given area
 typedef struct
 {
@@ -200,6 +233,7 @@ typedef struct
     double   volTreated;     // total volume treated (ft)                      //(5.1.013)
     double   nextRegenDay;   // next day when unit regenerated                 //
     TWaterBalance  waterBalance;     // water balance quantites
+    TLidFluxes     fluxes;           // flux rates over current time step
 }  TLidUnit;
 
 //-----------------------------------------------------------------------------
@@ -220,8 +254,14 @@ double   lid_getFlowToPerv(int subcatch);
 double   lid_getDrainFlow(int subcatch, int timePeriod);
 double   lid_getStoredVolume(int subcatch);
 void     lid_addDrainLoads(int subcatch, double c[], double tStep);
-void     lid_addDrainRunon(int subcatch);
+int      lid_getUnitCount(int subcatch);
+int      lid_getUnits(int subcatch, TLidUnit* units[]);
+int      lid_getDrainSubcatch(int subcatch, TLidUnit* lidUnit);
+void     lid_addDrainRunon(int subcatch, TLidUnit* lidUnit);
 void     lid_addDrainInflow(int subcatch, double f);
+int      lid_openBatch(void);
+void     lid_closeBatch(void);
+void     lid_evalUnits(double tStep);
 void     lid_getRunoff(int subcatch, double tStep);
 void     lid_writeSummary(void);
 void     lid_writeWaterBalance(void);
@@ -237,5 +277,7 @@ double   lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc,
 void     lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall,
          double ucfRainDepth);
 
+void     lidproc_flushRptFile(TLidRptFile* rptFile);
+
 
 #endif //LID_H
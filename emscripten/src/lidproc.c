@@ -89,20 +89,6 @@ enum LidLayerTypes {
     PAVE,                    // pavement layer
     DRAIN};                  // underdrain system
 
-enum LidRptVars {
-    SURF_INFLOW,             // inflow to surface layer
-    TOTAL_EVAP,              // evaporation rate from all layers
-    SURF_INFIL,              // infiltration into surface layer
-    PAVE_PERC,               // percolation through pavement layer
-    SOIL_PERC,               // percolation through soil layer
-    STOR_EXFIL,              // exfiltration out of storage layer
-    SURF_OUTFLOW,            // outflow from surface layer
-    STOR_DRAIN,              // outflow from storage layer
-    SURF_DEPTH,              // ponded depth on surface layer
-    PAVE_DEPTH,              // water level in pavement layer
-    SOIL_MOIST,              // moisture content of soil layer
-    STOR_DEPTH,              // water level in storage layer
-    MAX_RPT_VARS};
 
 //-----------------------------------------------------------------------------
 //  Imported variables 
@@ -141,12 +127,20 @@ static double     StorageVolume;  // volume in storage layer (ft)
 
 static double     Xold[MAX_LAYERS];  // previous moisture level in LID layers
 
+// LID units are evaluated in parallel (see lid_evalUnits)
+#pragma omp threadprivate(theLidUnit, theLidProc, Tstep, EvapRate, \
+    MaxNativeInfil, SurfaceInflow, SurfaceInfil, SurfaceEvap, SurfaceOutflow, \
+    SurfaceVolume, PaveEvap, PavePerc, PaveVolume, SoilEvap, SoilPerc, \
+    SoilVolume, StorageInflow, StorageExfil, StorageEvap, StorageDrain, \
+    StorageVolume, Xold)
+
 //-----------------------------------------------------------------------------
 //  External Functions (declared in lid.h)
 //-----------------------------------------------------------------------------
 // lidproc_initWaterBalance  (called by lid_initState)
-// lidproc_getOutflow        (called by evalLidUnit in lid.c)
+// lidproc_getOutflow        (called by lid_evalUnits in lid.c)
 // lidproc_saveResults       (called by evalLidUnit in lid.c)
+// lidproc_flushRptFile      (called by lid_closeBatch & freeLidGroup)
 
 //-----------------------------------------------------------------------------
 // Local Functions
@@ -170,6 +164,8 @@ static double getDrainMatOutflow(double depth);
 static void   getEvapRates(double surfaceVol, double paveVol,
               double soilVol, double storageVol, double pervFrac);
 
+static void   saveFluxRates(void);
+static void   writeResults(TLidRptFile* rptFile);
 static void   updateWaterBalance(TLidUnit *lidUnit, double inflow,
                                  double evap, double infil, double surfFlow,
                                  double drainFlow, double storage);
@@ -321,7 +317,8 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
     case VEG_SWALE:       fluxRates = &swaleFluxRates;
                           omega = 0.5;
                           break;
-    default:              return 0.0;
+    default:              saveFluxRates();
+                          return 0.0;
     }
 
     //... update moisture levels and flux rates over the time step
@@ -353,8 +350,10 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
     theLidUnit->storageDepth = x[STOR];
     for (i = 0; i < MAX_LAYERS; i++) theLidUnit->oldFluxRates[i] = f[i];
 
-    //... assign values to LID unit evaporation, infiltration & drain flow
-    *lidEvap = SurfaceEvap + PaveEvap + SoilEvap + StorageEvap;
+    //... save flux rates for reporting & assign values to LID unit
+    //    evaporation, infiltration & drain flow
+    saveFluxRates();
+    *lidEvap = theLidUnit->fluxes.evap;
     *lidInfil = StorageExfil;
     *lidDrain = StorageDrain;
 
@@ -367,7 +366,8 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
 void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDepth)
 //
 //  Purpose: updates the mass balance for an LID unit and saves
-//           current flux rates to the LID report file.
+//           the flux rates found by lidproc_getOutflow to the LID
+//           report file.
 //  Input:   lidUnit = ptr. to LID unit
 //           ucfRainfall = units conversion factor for rainfall rate
 //           ucfDepth = units conversion factor for rainfall depth
@@ -375,103 +375,154 @@ void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDe
 //
 {
     double ucf;                        // units conversion factor
-    double totalEvap;                  // total evaporation rate (ft/s)
-    double totalVolume;                // total volume stored in LID (ft)
+    TLidFluxes* fluxes = &lidUnit->fluxes;  // unit's current flux rates
     double rptVars[MAX_RPT_VARS];      // array of reporting variables
     int    isDry = FALSE;              // true if current state of LID is dry
-    char   timeStamp[24];              // date/time stamp
-    double elapsedHrs;                 // elapsed hours
-
-    //... find total evap. rate and stored volume
-    totalEvap = SurfaceEvap + PaveEvap + SoilEvap + StorageEvap; 
-    totalVolume = SurfaceVolume + PaveVolume + SoilVolume + StorageVolume;
+    int    i;
+    TLidRptFile* rptFile = lidUnit->rptFile;
 
     //... update mass balance totals
-    updateWaterBalance(theLidUnit, SurfaceInflow, totalEvap, StorageExfil,
-                       SurfaceOutflow, StorageDrain, totalVolume);
+    updateWaterBalance(lidUnit, fluxes->inflow, fluxes->evap,
+                       fluxes->storExfil, fluxes->surfOutflow,
+                       fluxes->storDrain, fluxes->volume);
 
     //... check if dry-weather conditions hold
-    if ( SurfaceInflow  < MINFLOW &&
-         SurfaceOutflow < MINFLOW &&
-         StorageDrain   < MINFLOW &&
-         StorageExfil   < MINFLOW &&
-		 totalEvap      < MINFLOW
+    if ( fluxes->inflow      < MINFLOW &&
+         fluxes->surfOutflow < MINFLOW &&
+         fluxes->storDrain   < MINFLOW &&
+         fluxes->storExfil   < MINFLOW &&
+         fluxes->evap        < MINFLOW
        ) isDry = TRUE;
 
     //... update status of HasWetLids
     if ( !isDry ) HasWetLids = TRUE;
 
     //... write results to LID report file
-    if ( lidUnit->rptFile )
+    if ( rptFile )
     {
         //... convert rate results to original units (in/hr or mm/hr)
         ucf = ucfRainfall;
-        rptVars[SURF_INFLOW]  = SurfaceInflow*ucf;
-        rptVars[TOTAL_EVAP]   = totalEvap*ucf;
-        rptVars[SURF_INFIL]   = SurfaceInfil*ucf;
-        rptVars[PAVE_PERC]    = PavePerc*ucf;
-        rptVars[SOIL_PERC]    = SoilPerc*ucf;
-        rptVars[STOR_EXFIL]   = StorageExfil*ucf;
-        rptVars[SURF_OUTFLOW] = SurfaceOutflow*ucf;
-        rptVars[STOR_DRAIN]   = StorageDrain*ucf;
+        rptVars[SURF_INFLOW]  = fluxes->inflow*ucf;
+        rptVars[TOTAL_EVAP]   = fluxes->evap*ucf;
+        rptVars[SURF_INFIL]   = fluxes->surfInfil*ucf;
+        rptVars[PAVE_PERC]    = fluxes->pavePerc*ucf;
+        rptVars[SOIL_PERC]    = fluxes->soilPerc*ucf;
+        rptVars[STOR_EXFIL]   = fluxes->storExfil*ucf;
+        rptVars[SURF_OUTFLOW] = fluxes->surfOutflow*ucf;
+        rptVars[STOR_DRAIN]   = fluxes->storDrain*ucf;
 
         //... convert storage results to original units (in or mm)
         ucf = ucfRainDepth;
-        rptVars[SURF_DEPTH] = theLidUnit->surfaceDepth*ucf;
-        rptVars[PAVE_DEPTH] = theLidUnit->paveDepth;
-        rptVars[SOIL_MOIST] = theLidUnit->soilMoisture;
-        rptVars[STOR_DEPTH] = theLidUnit->storageDepth*ucf;
+        rptVars[SURF_DEPTH] = lidUnit->surfaceDepth*ucf;
+        rptVars[PAVE_DEPTH] = lidUnit->paveDepth;
+        rptVars[SOIL_MOIST] = lidUnit->soilMoisture;
+        rptVars[STOR_DEPTH] = lidUnit->storageDepth*ucf;
 
         //... if the current LID state is wet but the previous state was dry
         //    for more than one period then write the saved previous results
         //    to the report file thus marking the end of a dry period
-        if ( !isDry && theLidUnit->rptFile->wasDry > 1)
-        {
-            fprintf(theLidUnit->rptFile->file, "%s",
-				  theLidUnit->rptFile->results);
-        }
+        if ( !isDry && rptFile->wasDry > 1) writeResults(rptFile);
 
-        //... write the current results to a string which is saved between
-        //    reporting periods
-        elapsedHrs = NewRunoffTime / 1000.0 / 3600.0;
-        datetime_getTimeStamp(M_D_Y, getDateTime(NewRunoffTime), 24, timeStamp);
-        sprintf(theLidUnit->rptFile->results,
-             "\n%20s\t %8.3f\t %8.3f\t %8.4f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t"
-             "%8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f",
-             timeStamp, elapsedHrs, rptVars[0], rptVars[1], rptVars[2],
-             rptVars[3], rptVars[4], rptVars[5], rptVars[6], rptVars[7],
-             rptVars[8], rptVars[9], rptVars[10], rptVars[11]);
+        //... save the current results between reporting periods
+        //    (they are only formatted if they get written to file)
+        rptFile->rptTime = NewRunoffTime;
+        for (i = 0; i < MAX_RPT_VARS; i++) rptFile->results[i] = rptVars[i];
 
         //... if the current LID state is dry
         if ( isDry )
         {
             //... if the previous state was wet then write the current
             //    results to file marking the start of a dry period
-            if ( theLidUnit->rptFile->wasDry == 0 )
-            {
-                fprintf(theLidUnit->rptFile->file, "%s",
-					theLidUnit->rptFile->results);
-            }
+            if ( rptFile->wasDry == 0 ) writeResults(rptFile);
 
             //... increment the number of successive dry periods
-            theLidUnit->rptFile->wasDry++;
+            rptFile->wasDry++;
         }
 
         //... if the current LID state is wet
         else
         {
             //... write the current results to the report file
-			fprintf(theLidUnit->rptFile->file, "%s",
-			    theLidUnit->rptFile->results);
+            writeResults(rptFile);
 
             //... re-set the number of successive dry periods to 0
-            theLidUnit->rptFile->wasDry = 0; 
+            rptFile->wasDry = 0; 
         }
     }
 }
 
 //=============================================================================
 
+void lidproc_flushRptFile(TLidRptFile* rptFile)
+//
+//  Purpose: writes any buffered results to a LID report file.
+//  Input:   rptFile = ptr. to LID report file
+//  Output:  none
+//
+{
+    if ( rptFile->bufLen > 0 && rptFile->file )
+    {
+        fwrite(rptFile->buffer, 1, rptFile->bufLen, rptFile->file);
+    }
+    rptFile->bufLen = 0;
+}
+
+//=============================================================================
+
+void writeResults(TLidRptFile* rptFile)
+//
+//  Purpose: adds the saved results of a LID unit to its report file.
+//  Input:   rptFile = ptr. to LID report file
+//  Output:  none
+//
+//  Results are collected in the file's buffer which is only written to
+//  disk once it fills up (or when the file is closed).
+//
+{
+    char   line[256];                  // formatted results
+    char   timeStamp[24];              // date/time stamp
+    double elapsedHrs;                 // elapsed hours
+    double *x = rptFile->results;
+    int    n;
+
+    elapsedHrs = rptFile->rptTime / 1000.0 / 3600.0;
+    datetime_getTimeStamp(M_D_Y, getDateTime(rptFile->rptTime), 24, timeStamp);
+    n = snprintf(line, sizeof(line),
+             "\n%20s\t %8.3f\t %8.3f\t %8.4f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t"
+             "%8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f",
+             timeStamp, elapsedHrs, x[0], x[1], x[2], x[3], x[4], x[5], x[6],
+             x[7], x[8], x[9], x[10], x[11]);
+    n = MIN(n, (int)sizeof(line) - 1);
+    if ( rptFile->bufLen + n > RPT_BUFSIZE ) lidproc_flushRptFile(rptFile);
+    memcpy(rptFile->buffer + rptFile->bufLen, line, n);
+    rptFile->bufLen += n;
+}
+
+//=============================================================================
+
+void saveFluxRates()
+//
+//  Purpose: saves the flux rates just computed for the current LID unit.
+//  Input:   none
+//  Output:  none
+//
+{
+    TLidFluxes* fluxes = &theLidUnit->fluxes;
+
+    fluxes->inflow      = SurfaceInflow;
+    fluxes->surfInfil   = SurfaceInfil;
+    fluxes->surfOutflow = SurfaceOutflow;
+    fluxes->evap        = SurfaceEvap + PaveEvap + SoilEvap + StorageEvap;
+    fluxes->pavePerc    = PavePerc;
+    fluxes->soilPerc    = SoilPerc;
+    fluxes->storExfil   = StorageExfil;
+    fluxes->storDrain   = StorageDrain;
+    fluxes->volume      = SurfaceVolume + PaveVolume + SoilVolume +
+                          StorageVolume;
+}
+
+//=============================================================================
+
 void roofFluxRates(double x[], double f[])
 //
 //  Purpose: computes flux rates for roof disconnection.
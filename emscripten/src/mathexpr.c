@@ -65,6 +65,25 @@ struct TreeNode
 };
 typedef struct TreeNode ExprTree;
 
+//  Instruction of a compiled math expression (its result is stored in the
+//  register with the same index as the instruction)
+typedef struct
+{
+    int    opcode;                // operator code
+    int    ivar;                  // variable index
+    int    left;                  // register of left (or only) operand
+    int    right;                 // register of right operand
+    double fvalue;                // numerical value
+}   ExprInstr;
+
+//  Compiled math expression
+struct ExprProgram
+{
+    int        count;             // number of instructions
+    ExprInstr  *code;             // instructions in evaluation order
+};
+typedef struct ExprProgram ExprProgram;
+
 // Local variables
 //----------------
 static int    Err;
@@ -99,6 +118,10 @@ static ExprTree * getOp(int *);
 static ExprTree * getTree(void);
 static void       traverseTree(ExprTree *, MathExpr **);
 static void       deleteTree(ExprTree *);
+static int        isBinaryOp(int);
+static double     applyOp(int, double, double);
+static int        addInstr(ExprInstr *, int *, ExprInstr *);
+static ExprProgram * compileExpr(MathExpr *);
 
 // Callback functions
 static int    (*getVariableIndex) (char *); // return index of named variable
@@ -311,7 +334,7 @@ ExprTree * newNode()
 {
     ExprTree *node;
     node = (ExprTree *) malloc(sizeof(ExprTree));
-    if (!node) Err = 2;
+    if (!node) Err = MATHEXPR_MEMORY_ERR;
     else
     {
         node->opcode = 0;
@@ -345,7 +368,7 @@ ExprTree * getSingleOp(int *lex)
         /* --- Error if not a singleton operand */
         if ( *lex < 7 || *lex == 9 || *lex > 30)
         {
-            Err = 1;
+            Err = MATHEXPR_SYNTAX_ERR;
             return NULL;
         }
 
@@ -355,6 +378,7 @@ ExprTree * getSingleOp(int *lex)
         if ( *lex == 7 || *lex == 8 )
         {
             left = newNode();
+            if (Err) return NULL;
             left->opcode = opcode;
             if ( *lex == 7 ) left->fvalue = Fvalue;
             if ( *lex == 8 ) left->ivar = Ivar;
@@ -366,11 +390,12 @@ ExprTree * getSingleOp(int *lex)
             *lex = getLex();
             if ( *lex != 1 )
             {
-               Err = 1;
+               Err = MATHEXPR_SYNTAX_ERR;
                return NULL;
             }
             Bc++;
             left = newNode();
+            if (Err) return NULL;
             left->left = getTree();
             left->opcode = opcode;
         }
@@ -389,13 +414,15 @@ ExprTree * getSingleOp(int *lex)
         }
         if ( *lex != 7 )
         {
-            Err = 1;
+            Err = MATHEXPR_SYNTAX_ERR;
             return NULL;
         }
         right = newNode();
+        if (Err) return NULL;
         right->opcode = *lex;
         right->fvalue = Fvalue;
         node = newNode();
+        if (Err) return NULL;
         node->left = left;
         node->right = right;
         node->opcode = 31;
@@ -405,7 +432,7 @@ ExprTree * getSingleOp(int *lex)
             *lex = getLex();
             if ( *lex != 2 )
             {
-                Err = 1;
+                Err = MATHEXPR_SYNTAX_ERR;
                 return NULL;
             }
         }
@@ -435,11 +462,13 @@ ExprTree * getOp(int *lex)
         else if ( *lex == 3) *lex = getLex();
     }
     left = getSingleOp(lex);
+    if (Err) return NULL;
     while ( *lex == 5 || *lex == 6 )
     {
         opcode = *lex;
         *lex = getLex();
         right = getSingleOp(lex);
+        if (Err) return NULL;
         node = newNode();
         if (Err) return NULL;
         node->left = left;
@@ -472,6 +501,7 @@ ExprTree * getTree()
     left = getOp(&lex);
     for (;;)
     {
+        if (Err) break;
         if ( lex == 0 || lex == 2 )
         {
             if ( lex == 2 ) Bc--;
@@ -480,7 +510,7 @@ ExprTree * getTree()
 
         if (lex != 3 && lex != 4 )
         {
-            Err = 1;
+            Err = MATHEXPR_SYNTAX_ERR;
             break;
         }
 
@@ -502,14 +532,21 @@ void traverseTree(ExprTree *tree, MathExpr **expr)
 // Converts binary tree to linked list (postfix format)
 {
     MathExpr *node;
-    if ( tree == NULL) return;
+    if ( tree == NULL || Err ) return;
     traverseTree(tree->left,  expr);
     traverseTree(tree->right, expr);
+    if ( Err ) return;
     node = (MathExpr *) malloc(sizeof(MathExpr));
+    if ( !node )
+    {
+        Err = MATHEXPR_MEMORY_ERR;
+        return;
+    }
     node->fvalue = tree->fvalue;
     node->opcode = tree->opcode;
     node->ivar = tree->ivar;
     node->next = NULL;
+    node->program = NULL;
     node->prev = (*expr);
     if (*expr) (*expr)->next = node;
     (*expr) = node;
@@ -529,206 +566,262 @@ void deleteTree(ExprTree *tree)
 
 //=============================================================================
 
+int isBinaryOp(int opcode)
+{
+    return (opcode >= 3 && opcode <= 6) || opcode == 31;
+}
+
+//=============================================================================
+
 // Turn on "precise" floating point option
 #pragma float_control(precise, on, push)
 
-double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
-//  Mathematica expression evaluation using a stack
+double applyOp(int opcode, double r2, double r1)
+//  Applies an operator to its left operand r2 and right operand r1
+//  (unary operators only use r2)
 {
-    
-// --- Note: the ExprStack array must be declared locally and not globally
-//     since this function can be called recursively.
-
-    double ExprStack[MAX_STACK_SIZE];
-    MathExpr *node = expr;
-    double r1, r2;
-    int stackindex = 0;
-    
-    ExprStack[0] = 0.0;
-    while(node != NULL)
-    {
-	switch (node->opcode)
-	{
-	    case 3:  
-		r1 = ExprStack[stackindex];
-		stackindex--;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 + r1;
-		break;
-
-        case 4:  
-		r1 = ExprStack[stackindex];
-		stackindex--;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 - r1;
-		break;
-
-        case 5:  
-		r1 = ExprStack[stackindex];
-		stackindex--;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 * r1;
-		break;
-
-        case 6:  
-		r1 = ExprStack[stackindex];
-		stackindex--;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 / r1;
-		break;				
-
-        case 7:  
-		stackindex++;
-		ExprStack[stackindex] = node->fvalue;
-		break;
+    switch (opcode)
+    {
+    case 3:  return r2 + r1;
+    case 4:  return r2 - r1;
+    case 5:  return r2 * r1;
+    case 6:  return r2 / r1;
+    case 9:  return -r2;
+    case 10: return cos(r2);
+    case 11: return sin(r2);
+    case 12: return tan(r2);
+    case 13:
+        if (r2 == 0.0) return 0.0;
+        return 1.0/tan( r2 );
+    case 14: return fabs( r2 );
+    case 15:
+        if (r2 < 0.0) return -1.0;
+        if (r2 > 0.0) return 1.0;
+        return 0.0;
+    case 16:
+        if (r2 < 0.0) return 0.0;
+        return sqrt( r2 );
+    case 17:
+        if (r2 <= 0) return 0.0;
+        return log(r2);
+    case 18: return exp(r2);
+    case 19: return asin( r2 );
+    case 20: return acos( r2 );
+    case 21: return atan( r2 );
+    case 22: return 1.57079632679489661923 - atan(r2);
+    case 23: return (exp(r2)-exp(-r2))/2.0;
+    case 24: return (exp(r2)+exp(-r2))/2.0;
+    case 25: return (exp(r2)-exp(-r2))/(exp(r2)+exp(-r2));
+    case 26: return (exp(r2)+exp(-r2))/(exp(r2)-exp(-r2));
+    case 27:
+        if (r2 == 0.0) return 0.0;
+        return log10( r2 );
+    case 28:
+        if (r2 <= 0.0) return 0.0;
+        return 1.0;
+    case 31:
+        if (r2 <= 0.0) return 0.0;
+        return exp(r1*log(r2));
+    }
+    return r2;
+}
 
-        case 8:
-        if (getVariableValue != NULL)
+//=============================================================================
+
+int addInstr(ExprInstr *code, int *count, ExprInstr *instr)
+//  Adds an instruction to a compiled expression, folding it into a constant
+//  when all of its operands are constants and reusing an identical earlier
+//  instruction when one exists. Returns the register holding its result.
+{
+    int i;
+
+    // --- constant folding
+    if ( instr->opcode != 7 && instr->opcode != 8 &&
+         code[instr->left].opcode == 7 && code[instr->right].opcode == 7 )
+    {
+        instr->fvalue = applyOp(instr->opcode, code[instr->left].fvalue,
+                                code[instr->right].fvalue);
+        instr->opcode = 7;
+        instr->left = -1;
+        instr->right = -1;
+    }
+
+    // --- order the operands of commutative operators
+    if ( (instr->opcode == 3 || instr->opcode == 5) &&
+         instr->left > instr->right )
+    {
+        i = instr->left;
+        instr->left = instr->right;
+        instr->right = i;
+    }
+
+    // --- common subexpression reuse
+    for (i = 0; i < *count; i++)
+    {
+        if ( code[i].opcode == instr->opcode &&
+             code[i].ivar   == instr->ivar   &&
+             code[i].left   == instr->left   &&
+             code[i].right  == instr->right  &&
+             memcmp(&code[i].fvalue, &instr->fvalue, sizeof(double)) == 0 )
+            return i;
+    }
+    code[*count] = *instr;
+    (*count)++;
+    return *count - 1;
+}
+
+//=============================================================================
+
+ExprProgram * compileExpr(MathExpr *expr)
+//  Converts a postfix expression list into a flat array of instructions
+//  whose operands refer to the results of earlier instructions.
+{
+    int n = 0, count = 0, sp = 0, i, k;
+    int *stack;
+    int *used;
+    ExprInstr instr;
+    ExprInstr *code;
+    ExprProgram *prog;
+    MathExpr *node;
+
+    // --- build the instruction array
+    for (node = expr; node != NULL; node = node->next) n++;
+    if ( n == 0 )
+    {
+        Err = MATHEXPR_SYNTAX_ERR;
+        return NULL;
+    }
+    code = (ExprInstr *) calloc(n, sizeof(ExprInstr));
+    stack = (int *) calloc(n, sizeof(int));
+    if ( !code || !stack )
+    {
+        free(code);
+        free(stack);
+        Err = MATHEXPR_MEMORY_ERR;
+        return NULL;
+    }
+    for (node = expr; node != NULL; node = node->next)
+    {
+        instr.opcode = node->opcode;
+        instr.ivar = -1;
+        instr.left = -1;
+        instr.right = -1;
+        instr.fvalue = 0.0;
+        if ( node->opcode == 7 ) instr.fvalue = node->fvalue;
+        else if ( node->opcode == 8 ) instr.ivar = node->ivar;
+        else if ( isBinaryOp(node->opcode) )
+        {
+            if ( sp < 2 ) break;
+            instr.right = stack[--sp];
+            instr.left = stack[--sp];
+        }
+        else if ( node->opcode >= 9 && node->opcode <= 28 )
         {
-           r1 = getVariableValue(node->ivar);
+            if ( sp < 1 ) break;
+            instr.left = stack[--sp];
+            instr.right = instr.left;
         }
-        else r1 = 0.0;
-		stackindex++;
-		ExprStack[stackindex] = r1;
-		break;
-
-        case 9: 
-		ExprStack[stackindex] = -ExprStack[stackindex];
-		break;
-
-        case 10: 
-		r1 = ExprStack[stackindex];
-		r2 = cos(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 11: 
-		r1 = ExprStack[stackindex];
-		r2 = sin(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 12: 
-		r1 = ExprStack[stackindex];
-		r2 = tan(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 13: 
-		r1 = ExprStack[stackindex];
-		if (r1 == 0.0) r2 = 0.0;
-		else r2 = 1.0/tan( r1 );    
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 14: 
-		r1 = ExprStack[stackindex];
-		r2 = fabs( r1 );       
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 15: 
-		r1 = ExprStack[stackindex];
-		if (r1 < 0.0) r2 = -1.0;
-		else if (r1 > 0.0) r2 = 1.0;
-		else r2 = 0.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 16: 
-		r1 = ExprStack[stackindex];
-		if (r1 < 0.0) r2 = 0.0;
-		else r2 = sqrt( r1 );     
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 17: 
-		r1 = ExprStack[stackindex];
-		if (r1 <= 0) r2 = 0.0;
-		else r2 = log(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 18: 
-		r1 = ExprStack[stackindex];
-		r2 = exp(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 19: 
-		r1 = ExprStack[stackindex];
-		r2 = asin( r1 );
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 20: 
-		r1 = ExprStack[stackindex];
-		r2 = acos( r1 );      
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 21: 
-		r1 = ExprStack[stackindex];
-		r2 = atan( r1 );      
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 22: 
-		r1 = ExprStack[stackindex];
-		r2 = 1.57079632679489661923 - atan(r1);  
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 23:
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)-exp(-r1))/2.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 24: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)+exp(-r1))/2.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 25: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)-exp(-r1))/(exp(r1)+exp(-r1));
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 26: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)+exp(-r1))/(exp(r1)-exp(-r1));
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 27: 
-		r1 = ExprStack[stackindex];
-		if (r1 == 0.0) r2 = 0.0;
-		else r2 = log10( r1 );     
-		ExprStack[stackindex] = r2;
-		break;
-
-        case 28:
- 		r1 = ExprStack[stackindex];
-		if (r1 <= 0.0) r2 = 0.0;
-		else           r2 = 1.0;
-		ExprStack[stackindex] = r2;
-		break;
-               
-        case 31: 
-		r1 = ExprStack[stackindex];
-		r2 = ExprStack[stackindex-1];
-		if (r2 <= 0.0) r2 = 0.0;
-		else r2 = exp(r1*log(r2));
-		ExprStack[stackindex-1] = r2;
-		stackindex--;
-		break;
+        else break;
+        stack[sp++] = addInstr(code, &count, &instr);
+    }
+    if ( node != NULL || sp != 1 )
+    {
+        free(code);
+        free(stack);
+        Err = MATHEXPR_SYNTAX_ERR;
+        return NULL;
+    }
+
+    // --- drop instructions not needed by the result (e.g. folded constants)
+    used = (int *) calloc(count, sizeof(int));
+    k = stack[0];
+    free(stack);
+    if ( !used )
+    {
+        free(code);
+        Err = MATHEXPR_MEMORY_ERR;
+        return NULL;
+    }
+    used[k] = 1;
+    for (i = k; i >= 0; i--)
+    {
+        if ( !used[i] || code[i].left < 0 ) continue;
+        used[code[i].left] = 1;
+        used[code[i].right] = 1;
+    }
+    n = 0;
+    for (i = 0; i <= k; i++)
+    {
+        if ( !used[i] ) continue;
+        code[n] = code[i];
+        if ( code[n].left >= 0 )
+        {
+            code[n].left = used[code[n].left] - 1;
+            code[n].right = used[code[n].right] - 1;
         }
-        node = node->next;
+        used[i] = n + 1;
+        n++;
+    }
+    free(used);
+
+    prog = (ExprProgram *) malloc(sizeof(ExprProgram));
+    if ( !prog )
+    {
+        free(code);
+        Err = MATHEXPR_MEMORY_ERR;
+        return NULL;
     }
-    r1 = ExprStack[stackindex];
+    prog->count = n;
+    prog->code = code;
+    return prog;
+}
+
+//=============================================================================
+
+double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
+//  Evaluates a compiled math expression
+{
+
+// --- Note: the register array must be declared locally and not globally
+//     since this function can be called recursively. Expressions too long
+//     for it have their registers allocated for each call.
+
+    double regBuf[MAX_STACK_SIZE];
+    double *reg = regBuf;
+    ExprProgram *prog;
+    ExprInstr *instr;
+    double r1;
+    int i;
+
+    if ( expr == NULL || expr->program == NULL ) return 0.0;
+    prog = expr->program;
+    if ( prog->count > MAX_STACK_SIZE )
+    {
+        reg = (double *) malloc(prog->count * sizeof(double));
+        if ( !reg ) return 0.0;
+    }
+    instr = prog->code;
+    r1 = 0.0;
+    for (i = 0; i < prog->count; i++, instr++)
+    {
+        switch (instr->opcode)
+        {
+        case 7:
+            r1 = instr->fvalue;
+            break;
+
+        case 8:
+            if (getVariableValue != NULL)
+                r1 = getVariableValue(instr->ivar);
+            else r1 = 0.0;
+            break;
+
+        default:
+            r1 = applyOp(instr->opcode, reg[instr->left], reg[instr->right]);
+        }
+        reg[i] = r1;
+    }
+    if ( reg != regBuf ) free(reg);
 
     // Set result to 0 if it is NaN due to an illegal math op
     if ( r1 != r1 ) r1 = 0.0;
@@ -736,6 +829,7 @@ double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
     return r1;
 }
 
+
 // Turn off "precise" floating point option
 #pragma float_control(pop)
 
@@ -743,7 +837,15 @@ double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
 
 void mathexpr_delete(MathExpr *expr)
 {
-    if (expr) mathexpr_delete(expr->next);
+    if (expr)
+    {
+        mathexpr_delete(expr->next);
+        if (expr->program)
+        {
+            free(expr->program->code);
+            free(expr->program);
+        }
+    }
     free(expr);
 }
 
@@ -771,7 +873,34 @@ MathExpr * mathexpr_create(char *formula, int (*getVar) (char *))
             result = expr;
             expr = expr->prev;
         }
+
+        // --- discard a partial list if memory ran out
+        if (Err)
+        {
+            mathexpr_delete(result);
+            result = NULL;
+        }
+
+        // --- compile the expression list into an instruction array
+        if (result)
+        {
+            result->program = compileExpr(result);
+            if (result->program == NULL)
+            {
+                mathexpr_delete(result);
+                result = NULL;
+            }
+        }
     }
     deleteTree(tree);
+    if (result == NULL && Err == 0) Err = MATHEXPR_SYNTAX_ERR;
     return result;
 }
+
+//=============================================================================
+
+int mathexpr_getError()
+//  Returns why the last call to mathexpr_create failed (0 if it didn't)
+{
+    return Err;
+}
@@ -12,6 +12,9 @@
 #define MATHEXPR_H
 
 
+//  Compiled form of a math expression (private to mathexpr.c)
+struct ExprProgram;
+
 //  Node in a tokenized math expression list
 struct ExprNode
 {
@@ -20,12 +23,20 @@ struct ExprNode
     double fvalue;                // numerical value
 	struct ExprNode *prev;        // previous node
     struct ExprNode *next;        // next node
+    struct ExprProgram *program;  // compiled expression (head node only)
 };
 typedef struct ExprNode MathExpr;
 
+//  Reasons why mathexpr_create fails
+#define MATHEXPR_SYNTAX_ERR  1    // formula is not a valid expression
+#define MATHEXPR_MEMORY_ERR  2    // out of memory
+
 //  Creates a tokenized math expression from a string
 MathExpr* mathexpr_create(char* s, int (*getVar) (char *));
 
+//  Returns why the last call to mathexpr_create failed (0 if it didn't)
+int  mathexpr_getError(void);
+
 //  Evaluates a tokenized math expression
 double mathexpr_eval(MathExpr* expr, double (*getVal) (int));
 
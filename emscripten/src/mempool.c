@@ -8,6 +8,10 @@
 //
 //  Modified by L. Rossman, 8/13/94.
 //
+//  Allocations are aligned to 8 bytes and requests larger than a block
+//  are given a block of their own so the pool can hold arrays of
+//  object data as well as ID strings.
+//
 //  AllocInit()     - create an alloc pool, returns the old pool handle
 //  Alloc()         - allocate memory
 //  AllocReset()    - reset the current pool
@@ -16,7 +20,6 @@
 //-----------------------------------------------------------------------------
 
 
-#include <stdlib.h>
 #include <stdlib.h>
 #include "mempool.h"
 
@@ -62,21 +65,27 @@ static alloc_root_t *root;
 **  Private routine to allocate a header and memory block.
 */
 
-static alloc_hdr_t *AllocHdr(void);
+static alloc_hdr_t *AllocHdr(long);
                 
-static alloc_hdr_t * AllocHdr()
+static alloc_hdr_t * AllocHdr(long size)
 {
     alloc_hdr_t     *hdr;
     char            *block;
 
-    block = (char *) malloc(ALLOC_BLOCK_SIZE);
+    if (size < ALLOC_BLOCK_SIZE) size = ALLOC_BLOCK_SIZE;
+    block = (char *) malloc(size);
     hdr   = (alloc_hdr_t *) malloc(sizeof(alloc_hdr_t));
 
-    if (hdr == NULL || block == NULL) return(NULL);
+    if (hdr == NULL || block == NULL)
+    {
+        free(block);
+        free(hdr);
+        return(NULL);
+    }
     hdr->block = block;
     hdr->free  = block;
     hdr->next  = NULL;
-    hdr->end   = block + ALLOC_BLOCK_SIZE;
+    hdr->end   = block + size;
 
     return(hdr);
 }
@@ -95,7 +104,7 @@ alloc_handle_t * AllocInit()
 
     root = (alloc_root_t *) malloc(sizeof(alloc_root_t));
     if (root == NULL) return(NULL);
-    if ( (root->first = AllocHdr()) == NULL) return(NULL);
+    if ( (root->first = AllocHdr(ALLOC_BLOCK_SIZE)) == NULL) return(NULL);
     root->current = root->first;
     newpool = (alloc_handle_t *) root;
     return(newpool);
@@ -112,40 +121,45 @@ alloc_handle_t * AllocInit()
 char * Alloc(long size)
 {
     alloc_hdr_t  *hdr = root->current;
+    alloc_hdr_t  *next;
     char         *ptr;
 
     /*
-    **  Align to 4 byte boundary - should be ok for most machines.
-    **  Change this if your machine has weird alignment requirements.
+    **  Align to 8 byte boundary so that blocks of doubles are
+    **  properly aligned.
     */
-    size = (size + 3) & 0xfffffffc;
+    size = (size + 7) & ~7L;
 
     ptr = hdr->free;
-    hdr->free += size;
 
     /* Check if the current block is exhausted. */
 
-    if (hdr->free >= hdr->end)
+    if (size > hdr->end - hdr->free)
     {
-        /* Is the next block already allocated? */
+        /* Is the next block already allocated and large enough? */
 
-        if (hdr->next != NULL)
+        next = hdr->next;
+        if (next != NULL && size <= next->end - next->block)
         {
             /* re-use block */
-            hdr->next->free = hdr->next->block;
-            root->current = hdr->next;
+            next->free = next->block;
         }
         else
         {
-            /* extend the pool with a new block */
-            if ( (hdr->next = AllocHdr()) == NULL) return(NULL);
-            root->current = hdr->next;
+            /*
+            **  extend the pool with a new block (requests larger
+            **  than ALLOC_BLOCK_SIZE get a block of their own)
+            */
+            if ( (next = AllocHdr(size)) == NULL) return(NULL);
+            next->next = hdr->next;
+            hdr->next = next;
         }
+        root->current = next;
 
         /* set ptr to the first location in the next block */
-        ptr = root->current->free;
-        root->current->free += size;
+        ptr = next->free;
     }
+    root->current->free = ptr + size;
 
     /* Return pointer to allocated memory. */
 
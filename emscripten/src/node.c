@@ -45,6 +45,16 @@
 #include "headers.h"
 #include "findroot.h"
 
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const int    MINVOLSTEPS = 64;    // min. height steps in storage
+                                         //   volume table
+static const int    MAXVOLSTEPS = 4096;  // max. height steps in storage
+                                         //   volume table
+static const double VOLDEPTHTOL = 0.001; // tolerance on depth found from
+                                         //   storage volume (ft or m)
+
 //-----------------------------------------------------------------------------                  
 //  Local Declarations
 //-----------------------------------------------------------------------------
@@ -84,7 +94,10 @@ static int    outfall_readParams(int j, int k, char* tok[], int ntoks);
 static void   outfall_setOutletDepth(int j, double yNorm, double yCrit, double z);
 
 static int    storage_readParams(int j, int k, char* tok[], int ntoks);
+static void   storage_createVolTable(int j);
+static double storage_getVolTableErr(int k);
 static double storage_getDepth(int j, double v);
+static double storage_getTableDepth(int k, double v);
 static double storage_getVolume(int j, double d);
 static double storage_getSurfArea(int j, double d);
 static void   storage_getVolDiff(double y, double* f, double* df, void* p);
@@ -221,6 +234,9 @@ void  node_validate(int j)
         if (node_getVolume(j, Node[j].fullDepth) < 0.0)                        //
             report_writeErrorMsg(ERR_STORAGE_VOLUME, Node[j].ID);              //
 
+    // --- tabulate volume v. depth for functional storage curves
+    if ( Node[j].type == STORAGE ) storage_createVolTable(j);
+
     if ( Node[j].type == DIVIDER ) divider_validate(j);
 
     // --- initialize dry weather inflows
@@ -741,6 +757,145 @@ int storage_readParams(int j, int k, char* tok[], int ntoks)
 
 //=============================================================================
 
+void storage_createVolTable(int j)
+//
+//  Input:   j = node index
+//  Output:  none
+//  Purpose: tabulates volume at equal height steps for a storage node whose
+//           functional area v. height curve has no closed-form inverse.
+//
+//  The number of height steps is doubled until depths interpolated from
+//  the table are within VOLDEPTHTOL of the true depth, so storage_getDepth
+//  can use them as is. If that would take more than MAXVOLSTEPS steps the
+//  table only brackets the depth for Newton's method to refine. It is
+//  discarded (and the full depth range searched instead) if volume does
+//  not increase with depth.
+//
+{
+    int    i, n;
+    int    k = Node[j].subIndex;
+    double e, y;
+    double* volTable;
+
+    // --- table only needed when Newton iterations would otherwise be used
+    FREE(Storage[k].volTable);
+    if ( Storage[k].aCurve >= 0 ) return;
+    if ( Storage[k].aExpon == 0.0 || Storage[k].aConst == 0.0 ) return;
+    if ( Node[j].fullDepth <= 0.0 ) return;
+
+    e = Storage[k].aExpon + 1.0;
+    for ( n = MINVOLSTEPS; n <= MAXVOLSTEPS; n *= 2 )
+    {
+        FREE(Storage[k].volTable);
+        volTable = (double *) calloc(n+1, sizeof(double));
+        if ( volTable == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY, "");
+            return;
+        }
+        Storage[k].volTable = volTable;
+        Storage[k].volSteps = n;
+        Storage[k].volStep = Node[j].fullDepth * UCF(LENGTH) / n;
+
+        // --- compute volume at each height step
+        //     (using same expression as storage_getVolDiff)
+        for ( i = 1; i <= n; i++ )
+        {
+            y = i * Storage[k].volStep;
+            volTable[i] = Storage[k].aConst * y +
+                          Storage[k].aCoeff / e * pow(y, e);
+            if ( volTable[i] <= volTable[i-1] )
+            {
+                FREE(Storage[k].volTable);
+                return;
+            }
+        }
+
+        // --- stop once interpolated depths are accurate enough
+        Storage[k].volTableErr = storage_getVolTableErr(k);
+        if ( Storage[k].volTableErr <= VOLDEPTHTOL ) return;
+    }
+}
+
+//=============================================================================
+
+double storage_getVolTableErr(int k)
+//
+//  Input:   k = storage unit index
+//  Output:  returns largest error in depth (user units) interpolated
+//           from the storage unit's volume table
+//  Purpose: finds how closely a storage unit's volume table reproduces
+//           the depth of any volume it covers.
+//
+//  Within a height step the interpolation error is largest where the
+//  slope of the volume curve, aConst + aCoeff*y^aExpon, equals the slope
+//  of the step's chord. Since that slope varies monotonically with y the
+//  point is unique and can be found directly.
+//
+{
+    int    i;
+    double y0, y, s, r;
+    double err, maxErr = 0.0;
+    double e = Storage[k].aExpon + 1.0;
+    double h = Storage[k].volStep;
+    double* volTable = Storage[k].volTable;
+
+    for ( i = 0; i < Storage[k].volSteps; i++ )
+    {
+        // --- find where the volume curve is parallel to the step's chord
+        y0 = i * h;
+        s = (volTable[i+1] - volTable[i]) / h;
+        r = (s - Storage[k].aConst) / Storage[k].aCoeff;
+        if ( r <= 0.0 ) return BIG;
+        y = pow(r, 1.0 / Storage[k].aExpon);
+        y = MAX(y0, MIN(y, y0 + h));
+
+        // --- error between the true and the interpolated depth there
+        err = Storage[k].aConst * y + Storage[k].aCoeff / e * pow(y, e);
+        err = fabs(y0 + (err - volTable[i]) / s - y);
+        maxErr = MAX(maxErr, err);
+    }
+    return maxErr;
+}
+
+//=============================================================================
+
+double storage_getTableDepth(int k, double v)
+//
+//  Input:   k = storage unit index
+//           v = volume (user units)
+//  Output:  returns depth of water (user units)
+//  Purpose: finds a storage unit's water depth from its volume table.
+//
+{
+    int    lo = 0, hi = Storage[k].volSteps, m;
+    double d;
+    double* volTable = Storage[k].volTable;
+    TStorageVol storageVol;
+
+    // --- find the height step whose volumes bracket v
+    while ( hi - lo > 1 )
+    {
+        m = (lo + hi) / 2;
+        if ( v < volTable[m] ) hi = m;
+        else lo = m;
+    }
+
+    // --- interpolate depth within the step
+    d = (lo + (v - volTable[lo]) / (volTable[hi] - volTable[lo])) *
+        Storage[k].volStep;
+    if ( Storage[k].volTableErr <= VOLDEPTHTOL ) return d;
+
+    // --- refine it with Newton's method bounded by the step's end points
+    storageVol.k = k;
+    storageVol.v = v;
+    findroot_Newton(lo * Storage[k].volStep, hi * Storage[k].volStep, &d,
+                    VOLDEPTHTOL, storage_getVolDiff, &storageVol);
+    return d;
+}
+
+//=============================================================================
+
 double storage_getDepth(int j, double v)
 //
 //  Input:   j = node index
@@ -777,13 +932,18 @@ double storage_getDepth(int j, double v)
             e = 1.0 / (Storage[k].aExpon + 1.0);
             d = pow(v / (Storage[k].aCoeff * e), e);
         }
+        else if ( Storage[k].volTable &&
+                  v <= Storage[k].volTable[Storage[k].volSteps] )
+        {
+            d = storage_getTableDepth(k, v);
+        }
         else
         {
             storageVol.k = k;
             storageVol.v = v;
             d = v / (Storage[k].aConst + Storage[k].aCoeff);
             findroot_Newton(0.0, Node[j].fullDepth*UCF(LENGTH), &d,
-                            0.001, storage_getVolDiff, &storageVol);            
+                            VOLDEPTHTOL, storage_getVolDiff, &storageVol);
         }
         d /= UCF(LENGTH);
         if ( d > Node[j].fullDepth ) d = Node[j].fullDepth;
@@ -91,6 +91,22 @@ struct  TableEntry
 };
 typedef struct TableEntry TTableEntry;
 
+//-------------------------------
+// BINARY TIME SERIES FILE READER
+//-------------------------------
+typedef struct
+{
+   int           chunkSize;       // entries per chunk of file
+   int           chunkCount;      // number of chunks in file
+   double        entryCount;      // number of entries in file
+   double*       chunkStart;      // date of first entry in each chunk
+   int           chunk;           // index of chunk held in window
+   int           size;            // number of entries in window
+   int           pos;             // window position of current entry
+   double*       x;               // dates of entries in window
+   float*        y;               // values of entries in window
+}  TTableStore;
+
 //-------------------------
 // CURVE/TIME SERIES OBJECT
 //-------------------------
@@ -106,7 +122,11 @@ typedef struct
    TTableEntry*  firstEntry;      // first data point
    TTableEntry*  lastEntry;       // last data point
    TTableEntry*  thisEntry;       // current data point
+   TTableEntry*  freeEntry;       // next unused entry in allocated block
+   int           freeCount;       // number of unused entries in block
+   int           entryCount;      // number of data points
    TFile         file;            // external data file
+   TTableStore*  store;           // reader for a binary external data file
 }  TTable;
 
 //-----------------
@@ -353,6 +373,7 @@ typedef struct
    double        inflow;          // inflow rate (ft/sec)
    double        runoff;          // runoff rate (ft/sec)
    double        depth;           // depth of surface runoff (ft)
+   double        infil;           // infiltration rate (ft/sec)
 }  TSubarea;
 
 //-------------------------
@@ -362,9 +383,28 @@ typedef struct
 {
    double        fraction;        // fraction of land area with land use
    double*       buildup;         // array of buildups for each pollutant
+                                  // (row of a subcatch x landuse x pollutant
+                                  //  block shared by all subcatchments)
    DateTime      lastSwept;       // date/time of last street sweeping
 }  TLandFactor;
 
+//-------------------------
+// SURFACE WATER BALANCE
+//-------------------------
+// Volumes (ft3) for the non-LID portion of a subcatchment over a time step
+typedef struct
+{
+   double        inflow;          // precip + snowmelt + runon + ponded water
+   double        evap;            // evaporation
+   double        pevap;           // pervious area evaporation
+   double        infil;           // infiltration
+   double        outflow;         // runoff to subcatchment's outlet
+   double        runon;           // runon from other areas
+   double        impervRunoff;    // impervious area runoff
+   double        pervRunoff;      // pervious area runoff
+   double        runoff;          // total runoff rate (cfs)
+}  TSurfBalance;
+
 //--------------------
 // SUBCATCHMENT OBJECT
 //--------------------
@@ -395,6 +435,8 @@ typedef struct
    //-----------------------------
    double        lidArea;         // area devoted to LIDs (ft2)
    double        rainfall;        // current rainfall (ft/sec)
+   double        netPrecip[3];    // current net precip. on each subarea (ft/sec)
+   TSurfBalance  surfBalance;     // current non-LID surface water balance
    double        evapLoss;        // current evap losses (ft/sec)
    double        infilLoss;       // current infil losses (ft/sec)
    double        runon;           // runon from other subcatchments (cfs)
@@ -502,6 +544,7 @@ typedef struct
    //-----------------------------
    int           degree;          // number of outflow links
    char          updated;         // true if state has been updated
+   char          frozen;          // true if in a steady state region
    double        crownElev;       // top of highest flowing closed conduit (ft)
    double        inflow;          // total inflow (cfs)
    double        outflow;         // total outflow (cfs)
@@ -546,6 +589,12 @@ typedef struct
    double      aExpon;            // exponent of area v. height curve
    int         aCurve;            // index of tabulated area v. height curve
    TExfil*     exfil;             // ptr. to exfiltration object
+   double*     volTable;          // volumes at equal height steps for
+                                  // functional area v. height curve
+   double      volStep;           // height step of volume table
+   int         volSteps;          // number of height steps in volume table
+   double      volTableErr;       // max. error in depth interpolated
+                                  // from volume table
    //-----------------------------
    double      hrt;               // hydraulic residence time (sec)
    double      evapLoss;          // evaporation loss (ft3)
@@ -672,6 +721,7 @@ typedef struct
    double        dqdh;            // change in flow w.r.t. head (ft2/sec)
    signed char   direction;       // flow direction flag
    char          bypassed;        // bypass dynwave calc. flag
+   char          frozen;          // true if in a steady state region
    char          normalFlow;      // normal flow limited flag
    char          inletControl;    // culvert inlet control flag
 }  TLink;
@@ -817,6 +867,10 @@ typedef struct
    double        sweepDays0;      // days since last sweeping at start
    TBuildup*     buildupFunc;     // array of buildup functions for pollutants
    TWashoff*     washoffFunc;     // array of washoff functions for pollutants
+   int*          buildupOrder;    // pollutants grouped by buildup function
+   int*          washoffOrder;    // pollutants grouped by washoff function
+   int           buildupGroup[EXTERNAL_BUILDUP+2]; // start of each buildup group
+   int           washoffGroup[EMC_WASHOFF+2];      // start of each washoff group
 }  TLanduse;
 
 //--------------------------
@@ -13,6 +13,10 @@
 #include <math.h>
 #include "odesolve.h"
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #define MAXSTP 10000
 #define TINY   1.0e-30
 #define SAFETY 0.9
@@ -24,37 +28,86 @@
 //-----------------------------------------------------------------------------
 //    Local declarations
 //-----------------------------------------------------------------------------
-int      nmax;      // max. number of equations
-double*  y;         // dependent variable
-double*  yscal;     // scaling factors
-double*  yerr;      // integration errors
-double*  ytemp;     // temporary values of y
-double*  dydx;      // derivatives of y
-double*  ak;        // derivatives at intermediate points
+//  Work arrays used by one thread. For a batch of m systems of n equations
+//  the values of system k are stored at positions k*n to k*n+n-1.
+typedef struct
+{
+    double*  y;         // dependent variable
+    double*  yscal;     // scaling factors
+    double*  yerr;      // integration errors
+    double*  ytemp;     // temporary values of y
+    double*  dydx;      // derivatives of y
+    double*  ak;        // derivatives at intermediate points
+    double*  x;         // independent variable of each system
+    double*  h;         // step size to try for each system
+    double*  hnext;     // next step size of each system
+    int*     nstp;      // number of steps taken by each system
+    int*     state;     // integration state of each system
+}  TOdeWork;
+
+// integration states of a system in a batch
+enum OdeStates {ODE_NEWSTEP, ODE_TRIAL, ODE_DONE};
+
+int       nmax;      // max. number of equations
+int       nwork;     // number of work arrays (one per thread)
+TOdeWork* work;      // work arrays
 
 
 // function that integrates over an error-controlled stepsize
-int rkqs(double* x, int n, double htry, double eps, double* hdid,
+int rkqs(TOdeWork* w, double* x, int n, double htry, double eps, double* hdid,
          double* hnext, void (*derivs)(double, double*, double*));
 
 // function that performs the Runge-Kutta integration step
-void rkck(double x, int n, double h, void (*derivs)(double, double*, double*));
+void rkck(TOdeWork* w, double x, int n, double h,
+          void (*derivs)(double, double*, double*));
+
+// function that performs a Runge-Kutta step for a batch of systems
+void rkckBatch(TOdeWork* w, int m, int n,
+               void (*derivs)(int, double, double*, double*));
+
+// function that returns the work arrays of the calling thread
+TOdeWork* getWork(void);
 
 
 //-----------------------------------------------------------------------------
-//    open the ODE solver to solve system of n equations
+//    open the ODE solver to solve system of n equations, or batches of
+//    up to ODE_MAXLANES such systems, from each thread
 //    (return 1 if successful, 0 if not)
 //-----------------------------------------------------------------------------
 int odesolve_open(int n)
 {
+    int k, m = ODE_MAXLANES;
+    TOdeWork* w;
+
     nmax  = 0;
-    y     = (double *) calloc(n, sizeof(double));
-    yscal = (double *) calloc(n, sizeof(double));
-    dydx  = (double *) calloc(n, sizeof(double));
-    yerr  = (double *) calloc(n, sizeof(double));
-    ytemp = (double *) calloc(n, sizeof(double));
-    ak    = (double *) calloc(5*n, sizeof(double));
-    if ( !y || !yscal || !dydx || !yerr || !ytemp || !ak ) return 0;
+    nwork = 1;
+#if defined(_OPENMP)
+    nwork = omp_get_max_threads();
+#endif
+    work = (TOdeWork *) calloc(nwork, sizeof(TOdeWork));
+    if ( !work )
+    {
+        nwork = 0;
+        return 0;
+    }
+    for (k = 0; k < nwork; k++)
+    {
+        w = &work[k];
+        w->y     = (double *) calloc(m*n, sizeof(double));
+        w->yscal = (double *) calloc(m*n, sizeof(double));
+        w->dydx  = (double *) calloc(m*n, sizeof(double));
+        w->yerr  = (double *) calloc(m*n, sizeof(double));
+        w->ytemp = (double *) calloc(m*n, sizeof(double));
+        w->ak    = (double *) calloc(5*m*n, sizeof(double));
+        w->x     = (double *) calloc(m, sizeof(double));
+        w->h     = (double *) calloc(m, sizeof(double));
+        w->hnext = (double *) calloc(m, sizeof(double));
+        w->nstp  = (int *) calloc(m, sizeof(int));
+        w->state = (int *) calloc(m, sizeof(int));
+        if ( !w->y || !w->yscal || !w->dydx || !w->yerr || !w->ytemp ||
+             !w->ak || !w->x || !w->h || !w->hnext || !w->nstp ||
+             !w->state ) return 0;
+    }
     nmax = n;
     return 1;
 }
@@ -65,22 +118,46 @@ int odesolve_open(int n)
 //-----------------------------------------------------------------------------
 void odesolve_close()
 {
-    if ( y ) free(y);
-    y = NULL;
-    if ( yscal ) free(yscal);
-    yscal = NULL;
-    if ( dydx ) free(dydx);
-    dydx = NULL;
-    if ( yerr ) free(yerr);
-    yerr = NULL;
-    if ( ytemp ) free(ytemp);
-    ytemp = NULL;
-    if ( ak ) free(ak);
-    ak = NULL;
+    int k;
+    TOdeWork* w;
+
+    for (k = 0; k < nwork; k++)
+    {
+        w = &work[k];
+        if ( w->y ) free(w->y);
+        if ( w->yscal ) free(w->yscal);
+        if ( w->dydx ) free(w->dydx);
+        if ( w->yerr ) free(w->yerr);
+        if ( w->ytemp ) free(w->ytemp);
+        if ( w->ak ) free(w->ak);
+        if ( w->x ) free(w->x);
+        if ( w->h ) free(w->h);
+        if ( w->hnext ) free(w->hnext);
+        if ( w->nstp ) free(w->nstp);
+        if ( w->state ) free(w->state);
+    }
+    if ( work ) free(work);
+    work = NULL;
+    nwork = 0;
     nmax = 0;
 }
 
 
+TOdeWork* getWork()
+//---------------------------------------------------------------
+//   Returns the work arrays of the calling thread (or NULL if
+//   the solver was not opened for that many threads).
+//---------------------------------------------------------------
+{
+    int k = 0;
+#if defined(_OPENMP)
+    k = omp_get_thread_num();
+#endif
+    if ( nmax == 0 || k >= nwork ) return NULL;
+    return &work[k];
+}
+
+
 int odesolve_integrate(double ystart[], int n, double x1, double x2,
       double eps, double h1, void (*derivs)(double, double*, double*))
 //---------------------------------------------------------------
@@ -96,7 +173,13 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
     double hdid, hnext;
     double x = x1;
     double h = h1;
-    if (nmax < n) return 1;
+    double *y, *yscal, *dydx;
+    TOdeWork* w = getWork();
+
+    if (nmax < n || w == NULL) return 1;
+    y = w->y;
+    yscal = w->yscal;
+    dydx = w->dydx;
     for (i=0; i<n; i++) y[i] = ystart[i];
     for (nstp=1; nstp<=MAXSTP; nstp++)
     {
@@ -104,7 +187,7 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
         for (i=0; i<n; i++)
             yscal[i] = fabs(y[i]) + fabs(dydx[i]*h) + TINY;
         if ((x+h-x2)*(x+h-x1) > 0.0) h = x2 - x;
-        errcode = rkqs(&x,n,h,eps,&hdid,&hnext,derivs);
+        errcode = rkqs(w,&x,n,h,eps,&hdid,&hnext,derivs);
         if (errcode) break;
         if ((x-x2)*(x2-x1) >= 0.0)
         {
@@ -118,7 +201,129 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
 }
 
 
-int rkqs(double* x, int n, double htry, double eps, double* hdid,
+int odesolve_integrateBatch(double ystart[], int m, int n, double x1,
+      double x2, double eps, double h1,
+      void (*derivs)(int, double, double*, double*))
+//---------------------------------------------------------------
+//   Integrates m independent systems of n equations from x1 to x2
+//   in lock-step. The starting values of system k are in
+//   ystart[k*n] to ystart[k*n+n-1]. Every system keeps its own
+//   adaptive step size and follows exactly the same sequence of
+//   steps as odesolve_integrate would, but each Runge-Kutta stage
+//   is computed for all active systems before moving to the next
+//   one. derivs(k, x, y, dydx) computes the derivatives of system
+//   k. On completion, ystart[] contains the new values of each
+//   system that was integrated successfully. The error code of the
+//   last system that failed (or 0) is returned.
+//---------------------------------------------------------------
+{
+    int    i, k, kn, active, errcode = 0;
+    double err, errmax, htemp, xnew;
+    TOdeWork* w = getWork();
+
+    if (nmax < n || m > ODE_MAXLANES || w == NULL) return 1;
+    for (k=0; k<m; k++)
+    {
+        for (i=0; i<n; i++) w->y[k*n+i] = ystart[k*n+i];
+        w->x[k] = x1;
+        w->hnext[k] = h1;
+        w->nstp[k] = 0;
+        w->state[k] = ODE_NEWSTEP;
+    }
+    active = m;
+    while (active > 0)
+    {
+        // --- start a new step for systems that completed their last one
+        for (k=0; k<m; k++)
+        {
+            if (w->state[k] != ODE_NEWSTEP) continue;
+            kn = k*n;
+            w->nstp[k]++;
+            if (w->nstp[k] > MAXSTP)
+            {
+                errcode = 3;
+                w->state[k] = ODE_DONE;
+                active--;
+                continue;
+            }
+            derivs(k, w->x[k], &w->y[kn], &w->dydx[kn]);
+            w->h[k] = w->hnext[k];
+            for (i=0; i<n; i++)
+                w->yscal[kn+i] = fabs(w->y[kn+i]) +
+                                 fabs(w->dydx[kn+i]*w->h[k]) + TINY;
+            if ((w->x[k]+w->h[k]-x2)*(w->x[k]+w->h[k]-x1) > 0.0)
+                w->h[k] = x2 - w->x[k];
+            w->state[k] = ODE_TRIAL;
+        }
+        if (active == 0) break;
+
+        // --- take a Runge-Kutta-Cash-Karp step in each active system
+        rkckBatch(w, m, n, derivs);
+
+        // --- accept or reject the step of each system
+        for (k=0; k<m; k++)
+        {
+            if (w->state[k] != ODE_TRIAL) continue;
+            kn = k*n;
+            errmax = 0.0;
+            for (i=0; i<n; i++)
+            {
+                err = fabs(w->yerr[kn+i]/w->yscal[kn+i]);
+                if (err > errmax) errmax = err;
+            }
+            errmax /= eps;
+
+            // --- error too large; reduce stepsize & repeat
+            if (errmax > 1.0)
+            {
+                htemp = SAFETY*w->h[k]*pow(errmax,PSHRNK);
+                if (w->h[k] >= 0)
+                {
+                    if (htemp > 0.1*w->h[k]) w->h[k] = htemp;
+                    else w->h[k] = 0.1*w->h[k];
+                }
+                else
+                {
+                    if (htemp < 0.1*w->h[k]) w->h[k] = htemp;
+                    else w->h[k] = 0.1*w->h[k];
+                }
+                xnew = w->x[k] + w->h[k];
+                if (xnew == w->x[k])
+                {
+                    errcode = 3;
+                    w->state[k] = ODE_DONE;
+                    active--;
+                }
+                continue;
+            }
+
+            // --- step succeeded; compute size of next step
+            if (errmax > ERRCON)
+                w->hnext[k] = SAFETY*w->h[k]*pow(errmax,PGROW);
+            else w->hnext[k] = 5.0*w->h[k];
+            w->x[k] += w->h[k];
+            for (i=0; i<n; i++) w->y[kn+i] = w->ytemp[kn+i];
+
+            // --- check if end of integration interval reached
+            w->state[k] = ODE_DONE;
+            active--;
+            if ((w->x[k]-x2)*(x2-x1) >= 0.0)
+            {
+                for (i=0; i<n; i++) ystart[kn+i] = w->y[kn+i];
+            }
+            else if (fabs(w->hnext[k]) <= 0.0) errcode = 2;
+            else
+            {
+                w->state[k] = ODE_NEWSTEP;
+                active++;
+            }
+        }
+    }
+    return errcode;
+}
+
+
+int rkqs(TOdeWork* w, double* x, int n, double htry, double eps, double* hdid,
          double* hnext, void (*derivs)(double, double*, double*))
 //---------------------------------------------------------------
 //   Fifth-order Runge-Kutta integration step with monitoring of
@@ -136,13 +341,13 @@ int rkqs(double* x, int n, double htry, double eps, double* hdid,
     for (;;)
     {
         // --- take a Runge-Kutta-Cash-Karp step
-        rkck(xold, n, h, derivs);
+        rkck(w, xold, n, h, derivs);
 
         // --- compute scaled maximum error
         errmax = 0.0;
         for (i=0; i<n; i++)
         {
-            err = fabs(yerr[i]/yscal[i]);
+            err = fabs(w->yerr[i]/w->yscal[i]);
             if (err > errmax) errmax = err;
         }
         errmax /= eps;
@@ -172,14 +377,15 @@ int rkqs(double* x, int n, double htry, double eps, double* hdid,
             if (errmax > ERRCON) *hnext = SAFETY*h*pow(errmax,PGROW);
             else *hnext = 5.0*h;
             *x += (*hdid=h);
-            for (i=0; i<n; i++) y[i] = ytemp[i];
+            for (i=0; i<n; i++) w->y[i] = w->ytemp[i];
             return 0;
         }
     }
 }
 
 
-void rkck(double x, int n, double h, void (*derivs)(double, double*, double*))
+void rkck(TOdeWork* w, double x, int n, double h,
+          void (*derivs)(double, double*, double*))
 //----------------------------------------------------------------------
 //   Uses the Runge-Kutta-Cash-Karp method to advance y[] at x
 //   over stepsize h.
@@ -195,11 +401,15 @@ void rkck(double x, int n, double h, void (*derivs)(double, double*, double*))
     double dc1=c1-2825.0/27648.0, dc3=c3-18575.0/48384.0,
            dc4=c4-13525.0/55296.0, dc6=c6-0.25;
     int i;
-    double *ak2 = (ak);
-    double *ak3 = ((ak)+(n));
-    double *ak4 = ((ak)+(2*n));
-    double *ak5 = ((ak)+(3*n));
-    double *ak6 = ((ak)+(4*n));
+    double *y = w->y;
+    double *yerr = w->yerr;
+    double *ytemp = w->ytemp;
+    double *dydx = w->dydx;
+    double *ak2 = (w->ak);
+    double *ak3 = ((w->ak)+(n));
+    double *ak4 = ((w->ak)+(2*n));
+    double *ak5 = ((w->ak)+(3*n));
+    double *ak6 = ((w->ak)+(4*n));
 
     for (i=0; i<n; i++)
         ytemp[i] = y[i] + b21*h*dydx[i];
@@ -228,3 +438,99 @@ void rkck(double x, int n, double h, void (*derivs)(double, double*, double*))
     for (i=0; i<n; i++)
         yerr[i] = h*(dc1*dydx[i] +dc3*ak3[i] + dc4*ak4[i] + dc5*ak5[i] + dc6*ak6[i]);
 }
+
+
+void rkckBatch(TOdeWork* w, int m, int n,
+               void (*derivs)(int, double, double*, double*))
+//----------------------------------------------------------------------
+//   Uses the Runge-Kutta-Cash-Karp method to advance y[] over stepsize
+//   h[k] for each system k of a batch whose step is being tried.
+//   The arithmetic of each system is identical to that of rkck().
+//----------------------------------------------------------------------
+{
+    double a2=0.2, a3=0.3, a4=0.6, a5=1.0, a6=0.875,
+           b21=0.2, b31=3.0/40.0, b32=9.0/40.0, b41=0.3, b42= -0.9, b43=1.2,
+           b51= -11.0/54.0, b52=2.5, b53= -70.0/27.0, b54=35.0/27.0,
+           b61=1631.0/55296.0, b62=175.0/512.0, b63=575.0/13824.0,
+           b64=44275.0/110592.0, b65=253.0/4096.0, c1=37.0/378.0,
+           c3=250.0/621.0, c4=125.0/594.0, c6=512.0/1771.0,
+           dc5= -277.0/14336.0;
+    double dc1=c1-2825.0/27648.0, dc3=c3-18575.0/48384.0,
+           dc4=c4-13525.0/55296.0, dc6=c6-0.25;
+    int i, k, kn;
+    double h;
+    double *y = w->y;
+    double *yerr = w->yerr;
+    double *ytemp = w->ytemp;
+    double *dydx = w->dydx;
+    double *ak2 = (w->ak);
+    double *ak3 = ((w->ak)+(m*n));
+    double *ak4 = ((w->ak)+(2*m*n));
+    double *ak5 = ((w->ak)+(3*m*n));
+    double *ak6 = ((w->ak)+(4*m*n));
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + b21*h*dydx[i];
+        derivs(k, w->x[k]+a2*h, &ytemp[kn], &ak2[kn]);
+    }
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + h*(b31*dydx[i]+b32*ak2[i]);
+        derivs(k, w->x[k]+a3*h, &ytemp[kn], &ak3[kn]);
+    }
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + h*(b41*dydx[i]+b42*ak2[i] + b43*ak3[i]);
+        derivs(k, w->x[k]+a4*h, &ytemp[kn], &ak4[kn]);
+    }
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + h*(b51*dydx[i]+b52*ak2[i] + b53*ak3[i] +
+                       b54*ak4[i]);
+        derivs(k, w->x[k]+a5*h, &ytemp[kn], &ak5[kn]);
+    }
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + h*(b61*dydx[i]+b62*ak2[i] + b63*ak3[i] +
+                       b64*ak4[i] + b65*ak5[i]);
+        derivs(k, w->x[k]+a6*h, &ytemp[kn], &ak6[kn]);
+    }
+
+    for (k=0; k<m; k++)
+    {
+        if (w->state[k] != ODE_TRIAL) continue;
+        kn = k*n;
+        h = w->h[k];
+        for (i=kn; i<kn+n; i++)
+            ytemp[i] = y[i] + h*(c1*dydx[i] + c3*ak3[i] + c4*ak4[i] +
+                       c6*ak6[i]);
+        for (i=kn; i<kn+n; i++)
+            yerr[i] = h*(dc1*dydx[i] +dc3*ak3[i] + dc4*ak4[i] + dc5*ak5[i] +
+                      dc6*ak6[i]);
+    }
+}
@@ -9,11 +9,17 @@
 #define ODESOLVE_H
 
 
+// max. number of systems integrated together by odesolve_integrateBatch
+#define ODE_MAXLANES 64
+
 // functions that open, close, and use the ODE solver
 int  odesolve_open(int n);
 void odesolve_close(void);
 int  odesolve_integrate(double ystart[], int n, double x1, double x2,
      double eps, double h1, void (*derivs)(double, double*, double*));
+int  odesolve_integrateBatch(double ystart[], int m, int n, double x1,
+     double x2, double eps, double h1,
+     void (*derivs)(int, double, double*, double*));
 
 
 #endif //ODESOLVE_H
@@ -97,6 +97,7 @@ static char     MemPoolAllocated;      // TRUE if memory pool allocated
 //  project_freeMatrix     (called from iface_closeRoutingFiles)
 //  project_findObject
 //  project_findID
+//  project_alloc
 
 //-----------------------------------------------------------------------------
 //  Function declarations
@@ -219,6 +220,9 @@ void project_validate()
     for ( i=0; i<Nobjects[GAGE]; i++ )     gage_validate(i);                   //(5.1.013)
     for ( i=0; i<Nobjects[SNOWMELT]; i++ ) snow_validateSnowmelt(i);
 
+    // --- group pollutants by land use buildup & washoff function
+    for ( i=0; i<Nobjects[LANDUSE]; i++ )  landuse_validate(i);
+
     // --- compute geometry tables for each shape curve
     j = 0;
     for ( i=0; i<Nobjects[CURVE]; i++ )
@@ -363,6 +367,29 @@ char  *project_findID(int type, char *id)
 
 //=============================================================================
 
+void  *project_alloc(int n, int size)
+//
+//  Input:   n    = number of items
+//           size = size of each item (bytes)
+//  Output:  returns pointer to zeroed memory or NULL if out of memory
+//  Purpose: allocates memory for object data from the project's memory pool.
+//
+//  NOTE: memory obtained this way is released all at once when the
+//        project is closed and must never be passed to free().
+//
+{
+    char *p = NULL;
+    long nbytes = (long)n * (long)size;
+
+    if ( !MemPoolAllocated ) return NULL;
+    #pragma omp critical(mempool)
+    p = Alloc(nbytes);
+    if ( p ) memset(p, 0, nbytes);
+    return p;
+}
+
+//=============================================================================
+
 double ** project_createMatrix(int nrows, int ncols)
 //
 //  Input:   nrows = number of rows (0-based)
@@ -571,6 +598,9 @@ int project_readOption(char* s1, char* s2)
       case ALLOW_PONDING:
       case SLOPE_WEIGHTING:
       case SKIP_STEADY_STATE:
+      case ACTIVE_SET:
+      case SKIP_STEADY_REGIONS:
+      case SKIP_DRY_PERIODS:
       case IGNORE_RAINFALL:
       case IGNORE_SNOWMELT:
       case IGNORE_GWATER:
@@ -584,6 +614,9 @@ int project_readOption(char* s1, char* s2)
           case ALLOW_PONDING:     AllowPonding    = m;  break;
           case SLOPE_WEIGHTING:   SlopeWeighting  = m;  break;
           case SKIP_STEADY_STATE: SkipSteadyState = m;  break;
+          case ACTIVE_SET:        ActiveSet       = m;  break;
+          case SKIP_STEADY_REGIONS: SkipSteadyRegions = m; break;
+          case SKIP_DRY_PERIODS:  SkipDryPeriods  = m;  break;
           case IGNORE_RAINFALL:   IgnoreRainfall  = m;  break;
           case IGNORE_SNOWMELT:   IgnoreSnowmelt  = m;  break;
           case IGNORE_GWATER:     IgnoreGwater    = m;  break;
@@ -823,6 +856,9 @@ void setDefaults()
    MinSurfArea     = 0.0;              // Force use of default min. surface area
    MinSlope        = 0.0;              // No user supplied minimum conduit slope
    SkipSteadyState = FALSE;            // Do flow routing in steady state periods 
+   ActiveSet       = FALSE;            // Re-solve all nodes in each DW trial
+   SkipSteadyRegions = FALSE;          // Route all parts of the network
+   SkipDryPeriods  = FALSE;            // Use DryStep throughout dry periods
    IgnoreRainfall  = FALSE;            // Analyze rainfall/runoff
    IgnoreRDII      = FALSE;            // Analyze RDII
    IgnoreSnowmelt  = FALSE;            // Analyze snowmelt 
@@ -974,7 +1010,8 @@ void createObjects()
 //        project_readInput().
 //
 {
-    int j, k;
+    int j, k, n;
+    double* buildup;
 
     // --- allocate memory for each category of object
     if ( ErrorCode ) return;
@@ -1020,19 +1057,21 @@ void createObjects()
     infil_create(Nobjects[SUBCATCH]);                                          //(5.1.015)
 
     // --- allocate memory for water quality state variables
+    //     (these per-object arrays come from the project's memory pool
+    //     and are released all at once when the project is closed)
     for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
         Subcatch[j].initBuildup =
-                              (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].pondedQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].totalLoad  = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+                        (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Subcatch[j].oldQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Subcatch[j].newQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Subcatch[j].pondedQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Subcatch[j].totalLoad  = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
     }
     for (j = 0; j < Nobjects[NODE]; j++)
     {
-        Node[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Node[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        Node[j].oldQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Node[j].newQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
         Node[j].extInflow = NULL;
         Node[j].dwfInflow = NULL;
         Node[j].rdiiInflow = NULL;
@@ -1040,29 +1079,37 @@ void createObjects()
     }
     for (j = 0; j < Nobjects[LINK]; j++)
     {
-        Link[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Link[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Link[j].totalLoad = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        Link[j].oldQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Link[j].newQual = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
+        Link[j].totalLoad = (double *) project_alloc(Nobjects[POLLUT], sizeof(double));
     }
 
     // --- allocate memory for land use buildup/washoff functions
     for (j = 0; j < Nobjects[LANDUSE]; j++)
     {
         Landuse[j].buildupFunc =
-            (TBuildup *) calloc(Nobjects[POLLUT], sizeof(TBuildup));
+            (TBuildup *) project_alloc(Nobjects[POLLUT], sizeof(TBuildup));
         Landuse[j].washoffFunc =
-            (TWashoff *) calloc(Nobjects[POLLUT], sizeof(TWashoff));
+            (TWashoff *) project_alloc(Nobjects[POLLUT], sizeof(TWashoff));
+        Landuse[j].buildupOrder =
+            (int *) project_alloc(Nobjects[POLLUT], sizeof(int));
+        Landuse[j].washoffOrder =
+            (int *) project_alloc(Nobjects[POLLUT], sizeof(int));
     }
 
     // --- allocate memory for subcatchment landuse factors
+    //     (pollutant buildup is stored in a single dense block indexed by
+    //     subcatchment, then land use, then pollutant)
+    n = Nobjects[SUBCATCH] * Nobjects[LANDUSE] * Nobjects[POLLUT];
+    buildup = (double *) project_alloc(n, sizeof(double));
     for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
         Subcatch[j].landFactor =
-            (TLandFactor *) calloc(Nobjects[LANDUSE], sizeof(TLandFactor));
+            (TLandFactor *) project_alloc(Nobjects[LANDUSE], sizeof(TLandFactor));
         for (k = 0; k < Nobjects[LANDUSE]; k++)
         {
-            Subcatch[j].landFactor[k].buildup =
-                (double *) calloc(Nobjects[POLLUT], sizeof(double));
+            Subcatch[j].landFactor[k].buildup = buildup;
+            buildup += Nobjects[POLLUT];
         }
     }
 
@@ -1108,7 +1155,11 @@ void createObjects()
     for ( j = 0; j < Nobjects[SNOWMELT]; j++ ) snow_initSnowmelt(j);
 
     // --- initialize storage node exfiltration
-    for (j = 0; j < Nnodes[STORAGE]; j++) Storage[j].exfil = NULL;
+    for (j = 0; j < Nnodes[STORAGE]; j++)
+    {
+        Storage[j].exfil = NULL;
+        Storage[j].volTable = NULL;
+    }
 
     // --- initialize link properties
     for (j = 0; j < Nobjects[LINK]; j++)
@@ -1144,62 +1195,29 @@ void deleteObjects()
 //        object before the latter is freed (e.g., we must free a
 //        subcatchment's land use factors before freeing the subcatchment).
 //
+//        Per-object data allocated with project_alloc (water quality state
+//        variables, land use factors, buildup/washoff functions, groundwater,
+//        snowpack, exfiltration and inflow objects, table entries, control
+//        rule clauses and LID units) is not freed here but is released with
+//        the project's memory pool in deleteHashTables.
+//
 {
-    int j, k;
+    int j;
 
-    // --- free memory for landuse factors & groundwater
+    // --- free memory for groundwater flow expressions
     if ( Subcatch ) for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        for (k = 0; k < Nobjects[LANDUSE]; k++)
-        {
-            FREE(Subcatch[j].landFactor[k].buildup);
-        }
-        FREE(Subcatch[j].landFactor);
-        FREE(Subcatch[j].groundwater);
         gwater_deleteFlowExpression(j);
-        FREE(Subcatch[j].snowpack);
-    }
-
-    // --- free memory for buildup/washoff functions
-    if ( Landuse ) for (j = 0; j < Nobjects[LANDUSE]; j++)
-    {
-        FREE(Landuse[j].buildupFunc);
-        FREE(Landuse[j].washoffFunc)
-    }
-
-    // --- free memory for water quality state variables
-    if ( Subcatch ) for (j = 0; j < Nobjects[SUBCATCH]; j++)
-    {
-        FREE(Subcatch[j].initBuildup);
-        FREE(Subcatch[j].oldQual);
-        FREE(Subcatch[j].newQual);
-        FREE(Subcatch[j].pondedQual);
-        FREE(Subcatch[j].totalLoad);
-    }
-    if ( Node ) for (j = 0; j < Nobjects[NODE]; j++)
-    {
-        FREE(Node[j].oldQual);
-        FREE(Node[j].newQual);
-    }
-    if ( Link ) for (j = 0; j < Nobjects[LINK]; j++)
-    {
-        FREE(Link[j].oldQual);
-        FREE(Link[j].newQual);
-        FREE(Link[j].totalLoad);
     }
 
     // --- free memory used for rainfall infiltration
     infil_delete();
 
-    // --- free memory used for storage exfiltration
+    // --- free memory used for storage exfiltration & volume tables
     if ( Node ) for (j = 0; j < Nnodes[STORAGE]; j++)
     {
-        if ( Storage[j].exfil )
-        {
-            FREE(Storage[j].exfil->btmExfil);
-            FREE(Storage[j].exfil->bankExfil);
-            FREE(Storage[j].exfil);
-        }
+        Storage[j].exfil = NULL;
+        FREE(Storage[j].volTable);
     }
 
     // --- free memory used for outfall pollutants loads
@@ -1293,6 +1311,7 @@ void deleteHashTables()
 
     // --- free object ID memory pool
     if ( MemPoolAllocated ) AllocFreePool();
+    MemPoolAllocated = FALSE;
 }
 
 //=============================================================================
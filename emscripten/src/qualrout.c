@@ -12,6 +12,13 @@
 //
 //   Water quality routing functions.
 //
+//   Nodes and links are updated in parallel. Node quality only depends on
+//   the old quality of the links that flow into it and link quality only
+//   depends on the new quality of its upstream node, so each sweep needs
+//   no ordering. Mass balance terms are saved per object and pollutant and
+//   then added to the routing totals in node and link order, which keeps
+//   results identical to a serial sweep.
+//
 //   Build 5.1.008:
 //   - Pollutant mass lost to seepage flow added to mass balance totals.
 //   - Pollutant concen. increased when evaporation occurs.
@@ -31,6 +38,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "headers.h"
 
 //-----------------------------------------------------------------------------
@@ -38,26 +46,109 @@
 //-----------------------------------------------------------------------------
 static const double ZeroVolume = 0.0353147; // 1 liter in ft3
 
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static int*    InLinkStart;  // start of each node's links in InLinks
+static int*    InLinks;      // links connected to each node (in index order)
+static double* SeepLoss;     // mass seepage rate by object & pollutant
+static double* ReactLoss;    // mass reaction rate by object & pollutant
+static double* StoreLoss;    // mass left in dry objects by object & pollutant
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
+//  qualrout_open            (called by routing_open)
+//  qualrout_close           (called by routing_close)
 //  qualrout_init            (called by swmm_start)
 //  qualrout_execute         (called by routing_execute)
 
 //-----------------------------------------------------------------------------
 //  Function declarations
 //-----------------------------------------------------------------------------
-static void  findLinkMassFlow(int i, double tStep);
+static void  findNodeMassFlow(int j);
+static void  findLinkMassLoad(int i, double tStep);
 static void  findNodeQual(int j);
 static void  findLinkQual(int i, double tStep);
 static void  findSFLinkQual(int i, double qSeep, double fEvap, double tStep);
 static void  findStorageQual(int j, double tStep);
 static void  updateHRT(int j, double v, double q, double tStep);
-static double getReactedQual(int p, double c, double v1, double tStep);
+static void  addMassLosses(int k);
+static double getReactedQual(int p, double c, double v1, double tStep,
+              double* reacted);
 static double getMixedQual(double c, double v1, double wIn, double qIn,
               double tStep);
 //=============================================================================
 
+int qualrout_open()
+//
+//  Input:   none
+//  Output:  returns an error code
+//  Purpose: allocates the arrays used to route water quality in parallel.
+//
+{
+    int i, j, n;
+    int nObjects = Nobjects[NODE] + Nobjects[LINK];
+
+    InLinkStart = NULL;
+    InLinks = NULL;
+    SeepLoss = NULL;
+    ReactLoss = NULL;
+    StoreLoss = NULL;
+    if ( Nobjects[POLLUT] == 0 ) return 0;
+
+    // --- allocate the node-to-link adjacency and mass loss arrays
+    n = nObjects * Nobjects[POLLUT];
+    InLinkStart = (int *) calloc(Nobjects[NODE]+1, sizeof(int));
+    InLinks = (int *) calloc(2*Nobjects[LINK]+1, sizeof(int));
+    SeepLoss = (double *) calloc(n, sizeof(double));
+    ReactLoss = (double *) calloc(n, sizeof(double));
+    StoreLoss = (double *) calloc(n, sizeof(double));
+    if ( !InLinkStart || !InLinks || !SeepLoss || !ReactLoss || !StoreLoss )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
+    // --- count the links connected to each node
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        InLinkStart[Link[i].node1+1]++;
+        if ( Link[i].node2 != Link[i].node1 ) InLinkStart[Link[i].node2+1]++;
+    }
+    for (j = 0; j < Nobjects[NODE]; j++) InLinkStart[j+1] += InLinkStart[j];
+
+    // --- list each node's links in increasing link index order
+    //     (InLinkStart[j] is advanced while filling and then restored)
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        InLinks[InLinkStart[Link[i].node1]++] = i;
+        if ( Link[i].node2 != Link[i].node1 )
+            InLinks[InLinkStart[Link[i].node2]++] = i;
+    }
+    for (j = Nobjects[NODE]; j > 0; j--) InLinkStart[j] = InLinkStart[j-1];
+    InLinkStart[0] = 0;
+    return 0;
+}
+
+//=============================================================================
+
+void qualrout_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the arrays used to route water quality.
+//
+{
+    FREE(InLinkStart);
+    FREE(InLinks);
+    FREE(SeepLoss);
+    FREE(ReactLoss);
+    FREE(StoreLoss);
+}
+
+//=============================================================================
+
 void    qualrout_init()
 //
 //  Input:   none
@@ -106,36 +197,90 @@ void qualrout_execute(double tStep)
     int    i, j;
     double qIn, vAvg;
 
-    // --- find mass flow each link contributes to its downstream node
-    for ( i = 0; i < Nobjects[LINK]; i++ ) findLinkMassFlow(i, tStep);
+    // --- find new water quality concentration at each node without
+    //     treatment (treatment shares state across nodes, so nodes with
+    //     treatment are updated serially below)
+#pragma omp parallel for num_threads(NumThreads) schedule(static) \
+    if(NumThreads > 1)
+    for (j = 0; j < Nobjects[NODE]; j++)
+    {
+        if ( Node[j].treatment ) continue;
+        findNodeMassFlow(j);
+        if ( Node[j].type == STORAGE || Node[j].oldVolume > FUDGE )
+        {
+            findStorageQual(j, tStep);
+        }
+        else findNodeQual(j);
+    }
 
-    // --- find new water quality concentration at each node  
+    // --- add node mass losses to mass balance totals in node order
     for (j = 0; j < Nobjects[NODE]; j++)
     {
+        if ( Node[j].treatment == NULL )
+        {
+            addMassLosses(j);
+            continue;
+        }
+
         // --- get node inflow and average volume
+        findNodeMassFlow(j);
         qIn = Node[j].inflow;
         vAvg = (Node[j].oldVolume + Node[j].newVolume) / 2.0;
-        
-        // --- save inflow concentrations if treatment applied
-        if ( Node[j].treatment )
-        {
-            if ( qIn < ZERO ) qIn = 0.0;
-            treatmnt_setInflow(qIn, Node[j].newQual);
-        }
-       
-        // --- find new quality at the node 
+
+        // --- save inflow concentrations for treatment
+        if ( qIn < ZERO ) qIn = 0.0;
+        treatmnt_setInflow(qIn, Node[j].newQual);
+
+        // --- find new quality at the node
         if ( Node[j].type == STORAGE || Node[j].oldVolume > FUDGE )
         {
             findStorageQual(j, tStep);
         }
         else findNodeQual(j);
+        addMassLosses(j);
 
         // --- apply treatment to new quality values
-        if ( Node[j].treatment ) treatmnt_treat(j, qIn, vAvg, tStep);
+        treatmnt_treat(j, qIn, vAvg, tStep);
     }
 
     // --- find new water quality in each link
-    for ( i = 0; i < Nobjects[LINK]; i++ ) findLinkQual(i, tStep);
+#pragma omp parallel for num_threads(NumThreads) schedule(static) \
+    if(NumThreads > 1)
+    for ( i = 0; i < Nobjects[LINK]; i++ )
+    {
+        findLinkMassLoad(i, tStep);
+        findLinkQual(i, tStep);
+    }
+
+    // --- add link mass losses to mass balance totals in link order
+    for ( i = 0; i < Nobjects[LINK]; i++ ) addMassLosses(Nobjects[NODE] + i);
+}
+
+//=============================================================================
+
+void addMassLosses(int k)
+//
+//  Input:   k = object index (node index or number of nodes + link index)
+//  Output:  none
+//  Purpose: adds the mass losses saved for a node or link to the mass
+//           balance totals and clears them.
+//
+{
+    int    p;
+    int    np = Nobjects[POLLUT];
+    double *seep = &SeepLoss[k*np],
+           *react = &ReactLoss[k*np],
+           *store = &StoreLoss[k*np];
+
+    for (p = 0; p < np; p++)
+    {
+        if ( seep[p] != 0.0 ) massbal_addSeepageLoss(p, seep[p]);
+        if ( react[p] != 0.0 ) massbal_addReactedMass(p, react[p]);
+        if ( store[p] != 0.0 ) massbal_addToFinalStorage(p, store[p]);
+    }
+    memset(seep, 0, np*sizeof(double));
+    memset(react, 0, np*sizeof(double));
+    memset(store, 0, np*sizeof(double));
 }
 
 //=============================================================================
@@ -173,38 +318,57 @@ double getMixedQual(double c, double v1, double wIn, double qIn, double tStep)
 
 //=============================================================================
 
-void findLinkMassFlow(int i, double tStep)
+void findNodeMassFlow(int j)
 //
-//  Input:   i = link index
-//           tStep = time step (sec)
+//  Input:   j = node index
 //  Output:  none
-//  Purpose: adds constituent mass flow out of link to the total
-//           accumulation at the link's downstream node.
+//  Purpose: adds constituent mass flow out of each link that discharges
+//           into a node to the total accumulation at the node.
 //
 //  Note:    Node[].newQual[], the accumulator variable, already contains
 //           contributions from runoff and other external inflows from
-//           calculations made in routing_execute().
+//           calculations made in routing_execute(). Links are examined in
+//           index order so the sums match a sweep over all links.
 {
-    int    j, p;
-    double qLink, w;
+    int    i, k, p;
+    double qLink;
 
-    // --- find inflow to downstream node
-    qLink = Link[i].newFlow;
+    for (k = InLinkStart[j]; k < InLinkStart[j+1]; k++)
+    {
+        // --- skip link if node is not its downstream node
+        i = InLinks[k];
+        qLink = Link[i].newFlow;
+        if ( qLink < 0.0 )
+        {
+            if ( Link[i].node1 != j ) continue;
+        }
+        else if ( Link[i].node2 != j ) continue;
+        qLink = fabs(qLink);
 
-    // --- identify index of downstream node
-    j = Link[i].node2;
-    if ( qLink < 0.0 ) j = Link[i].node1;
-    qLink = fabs(qLink);
+        // --- temporarily accumulate inflow load in Node[j].newQual
+        for (p = 0; p < Nobjects[POLLUT]; p++)
+        {
+            Node[j].newQual[p] += qLink * Link[i].oldQual[p];
+        }
+    }
+}
+
+//=============================================================================
+
+void findLinkMassLoad(int i, double tStep)
+//
+//  Input:   i = link index
+//           tStep = time step (sec)
+//  Output:  none
+//  Purpose: updates the total constituent load transported by a link.
+//
+{
+    int    p;
+    double qLink = fabs(Link[i].newFlow);
 
-    // --- examine each pollutant
     for (p = 0; p < Nobjects[POLLUT]; p++)
     {
-        // --- temporarily accumulate inflow load in Node[j].newQual
-        w = qLink * Link[i].oldQual[p];
-        Node[j].newQual[p] += w;
-
-        // --- update total load transported by link
-        Link[i].totalLoad[p] += w * tStep;
+        Link[i].totalLoad[p] += qLink * Link[i].oldQual[p] * tStep;
     }
 }
 
@@ -257,7 +421,10 @@ void findLinkQual(int i, double tStep)
            vEvap,            // volume lost to evaporation (ft3)
            vLosses,          // evap. + seepage volume loss (ft3)
            fEvap,            // evaporation concentration factor
-           barrels;          // number of barrels in conduit
+           barrels,          // number of barrels in conduit
+           *seep,            // mass seepage rates (mass/sec)
+           *react,           // mass reaction rates (mass/sec)
+           *store;           // mass left in dry link (mass)
 
     // --- identify index of upstream node
     j = Link[i].node1;
@@ -308,19 +475,23 @@ void findLinkQual(int i, double tStep)
     }
 
     // --- examine each pollutant
+    k = (Nobjects[NODE] + i) * Nobjects[POLLUT];
+    seep = &SeepLoss[k];
+    react = &ReactLoss[k];
+    store = &StoreLoss[k];
     for (p = 0; p < Nobjects[POLLUT]; p++)
     {
         // --- start with concen. at start of time step
         c1 = Link[i].oldQual[p];
 
         // --- update mass balance accounting for seepage loss
-        massbal_addSeepageLoss(p, qSeep*c1);
+        seep[p] = qSeep*c1;
 
         // --- increase concen. by evaporation factor
         c1 *= fEvap;
 
         // --- reduce concen. by 1st-order reaction
-        c2 = getReactedQual(p, c1, v1, tStep);
+        c2 = getReactedQual(p, c1, v1, tStep, &react[p]);
 
         // --- mix resulting contents with inflow from upstream node
         wIn = Node[j].newQual[p]*qIn;
@@ -329,7 +500,7 @@ void findLinkQual(int i, double tStep)
         // --- set concen. to zero if remaining volume is negligible
         if ( v2 < ZeroVolume )
         {
-            massbal_addToFinalStorage(p, c2 * v2);
+            store[p] = c2 * v2;
             c2 = 0.0;
         }
 
@@ -350,9 +521,9 @@ void  findSFLinkQual(int i, double qSeep, double fEvap, double tStep)
 //
 {
     int j = Link[i].node1;
+    int k = (Nobjects[NODE] + i) * Nobjects[POLLUT];
     int p;
     double c1, c2;
-    double lossRate;
 
     // --- examine each pollutant
     for (p = 0; p < Nobjects[POLLUT]; p++)
@@ -361,7 +532,7 @@ void  findSFLinkQual(int i, double qSeep, double fEvap, double tStep)
         c1 = Node[j].newQual[p];
 
         // --- update mass balance accounting for seepage loss
-        massbal_addSeepageLoss(p, qSeep*c1);
+        SeepLoss[k+p] = qSeep*c1;
 
         // --- increase concen. by evaporation factor
         c1 *= fEvap;
@@ -372,8 +543,7 @@ void  findSFLinkQual(int i, double qSeep, double fEvap, double tStep)
         {
             c2 = c1 * exp(-Pollut[p].kDecay * tStep);
             c2 = MAX(0.0, c2);
-            lossRate = (c1 - c2) * Link[i].newFlow;
-            massbal_addReactedMass(p, lossRate);
+            ReactLoss[k+p] = (c1 - c2) * Link[i].newFlow;
         }
         Link[i].newQual[p] = c2;
     }
@@ -398,7 +568,10 @@ void  findStorageQual(int j, double tStep)
            c2,               // final pollutant concentration (mass/ft3)
            qExfil = 0.0,     // exfiltration rate from storage unit (cfs)
            vEvap = 0.0,      // evaporation loss from storage unit (ft3)
-           fEvap = 1.0;      // evaporation concentration factor
+           fEvap = 1.0,      // evaporation concentration factor
+           *seep = &SeepLoss[j*Nobjects[POLLUT]],   // mass seepage rates
+           *react = &ReactLoss[j*Nobjects[POLLUT]], // mass reaction rates
+           *store = &StoreLoss[j*Nobjects[POLLUT]]; // mass left in dry node
 
     // --- get inflow rate & initial volume
     qIn = Node[j].inflow;
@@ -429,7 +602,7 @@ void  findStorageQual(int j, double tStep)
         c1 = Node[j].oldQual[p];
 
         // --- update mass balance accounting for exfiltration loss
-        massbal_addSeepageLoss(p, qExfil*c1);
+        seep[p] = qExfil*c1;
 
         // --- increase concen. by evaporation factor
         c1 *= fEvap;
@@ -438,7 +611,7 @@ void  findStorageQual(int j, double tStep)
         if ( Node[j].treatment == NULL ||
              Node[j].treatment[p].equation == NULL )
         {
-            c1 = getReactedQual(p, c1, v1, tStep);
+            c1 = getReactedQual(p, c1, v1, tStep, &react[p]);
         }
 
         // --- mix resulting contents with inflow from all sources
@@ -449,7 +622,7 @@ void  findStorageQual(int j, double tStep)
 // --- set concen. to zero if remaining volume & inflow is negligible          //(5.1.015)
         if (Node[j].newVolume <= ZeroVolume && qIn <= FLOW_TOL)                //(5.1.015)
         {
-            massbal_addToFinalStorage(p, c2 * Node[j].newVolume);
+            store[p] = c2 * Node[j].newVolume;
             c2 = 0.0;
         }
 
@@ -480,25 +653,26 @@ void updateHRT(int j, double v, double q, double tStep)
 
 //=============================================================================
 
-double getReactedQual(int p, double c, double v1, double tStep)
+double getReactedQual(int p, double c, double v1, double tStep,
+                      double* reacted)
 //
 //  Input:   p = pollutant index
 //           c = initial concentration (mass/ft3)
 //           v1 = initial volume (ft3)
 //           tStep = time step (sec)
-//  Output:  none
+//  Output:  reacted = rate of mass reacted (mass/sec);
+//           returns concentration after reaction (mass/ft3)
 //  Purpose: applies a first order reaction to a pollutant over a given
 //           time step.
 //
 {
-    double c2, lossRate;
+    double c2;
     double kDecay = Pollut[p].kDecay;
 
     if ( kDecay == 0.0 ) return c;
     c2 = c * (1.0 - kDecay * tStep);
     c2 = MAX(0.0, c2);
-    lossRate = (c - c2) * v1 / tStep;
-    massbal_addReactedMass(p, lossRate);
+    *reacted = (c - c2) * v1 / tStep;
     return c2;
 }
  
\ No newline at end of file
@@ -41,6 +41,12 @@
 //         Date/time for start of period (8-byte double)
 //         Rain depth (inches) (4-byte float)
 //
+//   The interface file is memory-mapped (read-only) once it has been
+//   created or opened, so that each gage reads its fixed-size records
+//   directly from the map through its own file position. The header's
+//   per-gage byte ranges serve as a block index, letting a gage whose
+//   records are in date order jump to a given date by binary search.
+//
 //   Release 5.1.010:
 //   - Modified error message for records out of sequence in std. format file.
 //
@@ -55,8 +61,20 @@
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+// --- define WINDOWS
+#undef WINDOWS
+#ifdef _WIN32
+  #define WINDOWS
+#endif
+#ifdef __WIN32__
+  #define WINDOWS
+#endif
+
 #include <stdlib.h>
 #include <string.h>
+#ifndef WINDOWS
+  #include <sys/mman.h>
+#endif
 #include "headers.h"
 
 //-----------------------------------------------------------------------------
@@ -67,6 +85,7 @@ enum RainFileFormat {UNKNOWN_FORMAT, NWS_TAPE, NWS_SPACE_DELIMITED,
                      AES_HLY, CMC_HLY, CMC_FIF, STD_SPACE_DELIMITED};
 enum ConditionCodes {NO_CONDITION, ACCUMULATED_PERIOD, DELETED_PERIOD,
                      MISSING_PERIOD};
+static const long RecordSize = sizeof(DateTime) + sizeof(float);
 
 //-----------------------------------------------------------------------------
 //  Shared variables
@@ -86,11 +105,18 @@ DateTime   PreviousDate;               // date of previous rainfall record
 int        GageIndex;                  // index of rain gage analyzed
 int        hasStationName;             // true if data contains station name
 
+static char*  RainMap;                 // contents of mapped interface file
+static long   RainMapSize;             // size of mapped interface file
+static int    RainMapped;              // TRUE if RainMap is a memory map
+static char*  RainSorted;              // TRUE if gage's records in date order
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
-//  rain_open   (called by swmm_start in swmm5.c)
-//  rain_close  (called by swmm_end in swmm5.c)
+//  rain_open        (called by swmm_start in swmm5.c)
+//  rain_close       (called by swmm_end in swmm5.c)
+//  rain_readRecord  (called by getFirstRainfall & getNextRainfall in gage.c)
+//  rain_findRecord  (called by skipRainRecords in gage.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -98,6 +124,8 @@ int        hasStationName;             // true if data contains station name
 static void createRainFile(int count);
 static int  rainFileConflict(int i);
 static void initRainFile(void);
+static void mapRainFile(void);
+static void unmapRainFile(void);
 static int  findGageInFile(int i, int kount);
 static int  addGageToRainFile(int i);
 static int  findFileFormat(FILE *f, int i, int *hdrLines);
@@ -155,7 +183,7 @@ void  rain_open(void)
         break;
 
       case USE_FILE:
-        if ( (Frain.file = fopen(Frain.name, "r+b")) == NULL)
+        if ( (Frain.file = fopen(Frain.name, "rb")) == NULL)
         {
             report_writeErrorMsg(ERR_RAIN_FILE_OPEN, Frain.name);
             return;
@@ -177,8 +205,12 @@ void  rain_open(void)
         createRainFile(count);
     }
 
-    // --- initialize rain file
-    if ( Frain.mode != NO_FILE ) initRainFile();
+    // --- initialize rain file and map it into memory
+    if ( Frain.mode != NO_FILE )
+    {
+        initRainFile();
+        mapRainFile();
+    }
 
     // --- open RDII processor (creates/opens a RDII interface file)
     rdii_openRdii();
@@ -193,6 +225,7 @@ void rain_close(void)
 //  Purpose: closes rain interface file and RDII processor.
 //
 {
+    unmapRainFile();
     if ( Frain.file )
     {
         fclose(Frain.file);
@@ -204,6 +237,187 @@ void rain_close(void)
 
 //=============================================================================
 
+int rain_readRecord(int j, DateTime* date, float* value)
+//
+//  Input:   j = rain gage index
+//  Output:  date = date/time of rainfall record
+//           value = rainfall depth of record (inches)
+//           returns TRUE if a record was read, FALSE if not
+//  Purpose: reads the record at a gage's current interface file position
+//           and advances the position to the next record.
+//
+{
+    long pos = Gage[j].currentFilePos;
+
+    if ( RainMap == NULL || pos >= Gage[j].endFilePos ) return FALSE;
+    memcpy(date, RainMap + pos, sizeof(DateTime));
+    memcpy(value, RainMap + pos + sizeof(DateTime), sizeof(float));
+    Gage[j].currentFilePos = pos + RecordSize;
+    return TRUE;
+}
+
+//=============================================================================
+
+long rain_findRecord(int j, DateTime aDate)
+//
+//  Input:   j = rain gage index
+//           aDate = a date/time
+//  Output:  returns interface file position of a record or -1 if none found
+//  Purpose: finds the last record with non-zero rainfall, at or after a
+//           gage's current file position, whose interval ends by aDate.
+//
+//  NOTE: only gages whose records are in date order can be searched.
+//
+{
+    long   n, lo, hi, mid, step;
+    long   pos0 = Gage[j].currentFilePos;
+    int    interval = Gage[j].rainInterval;
+    DateTime date;
+    float  v;
+
+    if ( RainMap == NULL || !RainSorted[j] ) return -1;
+    n = (Gage[j].endFilePos - pos0) / RecordSize;
+
+    // --- gallop ahead from current position to bracket the last record
+    //     whose interval ends by aDate (so that short skips stay cheap)
+    lo = -1;
+    hi = 0;
+    step = 1;
+    while ( hi < n )
+    {
+        memcpy(&date, RainMap + pos0 + hi*RecordSize, sizeof(DateTime));
+        if ( datetime_addSeconds(date, interval) > aDate ) break;
+        lo = hi;
+        hi += step;
+        step *= 2;
+    }
+    if ( hi > n ) hi = n;
+
+    // --- binary search within the bracket
+    while ( hi - lo > 1 )
+    {
+        mid = (lo + hi) / 2;
+        memcpy(&date, RainMap + pos0 + mid*RecordSize, sizeof(DateTime));
+        if ( datetime_addSeconds(date, interval) > aDate ) hi = mid;
+        else lo = mid;
+    }
+
+    // --- back up to the last record with non-zero rainfall
+    for ( ; lo >= 0; lo--)
+    {
+        memcpy(&v, RainMap + pos0 + lo*RecordSize + sizeof(DateTime),
+               sizeof(float));
+        if ( v != 0.0f ) return pos0 + lo*RecordSize;
+    }
+    return -1;
+}
+
+//=============================================================================
+
+void mapRainFile(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: maps the rain interface file into memory and checks which
+//           gages have records in date order.
+//
+{
+    int   i;
+    long  pos;
+    DateTime date, lastDate;
+
+    // --- make sure interface file is open and no error condition
+    if ( ErrorCode || !Frain.file ) return;
+
+    // --- find size of interface file
+    fflush(Frain.file);
+    fseek(Frain.file, 0, SEEK_END);
+    RainMapSize = ftell(Frain.file);
+    if ( RainMapSize <= 0 ) return;
+
+    // --- map it into memory (or read it in if it can't be mapped)
+    RainMapped = FALSE;
+#ifndef WINDOWS
+    RainMap = (char *) mmap(NULL, RainMapSize, PROT_READ, MAP_SHARED,
+                            fileno(Frain.file), 0);
+    if ( RainMap == (char *) MAP_FAILED ) RainMap = NULL;
+    else RainMapped = TRUE;
+#endif
+    if ( RainMap == NULL )
+    {
+        RainMap = (char *) malloc(RainMapSize);
+        if ( RainMap == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY, "");
+            return;
+        }
+        rewind(Frain.file);
+        if ( fread(RainMap, 1, RainMapSize, Frain.file) < (size_t)RainMapSize )
+        {
+            unmapRainFile();
+            report_writeErrorMsg(ERR_RAIN_IFACE_FORMAT, "");
+            return;
+        }
+    }
+
+    // --- check each gage's block of records
+    RainSorted = (char *) calloc(Nobjects[GAGE], sizeof(char));
+    if ( RainSorted == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return;
+    }
+    for ( i = 0; i < Nobjects[GAGE]; i++ )
+    {
+        if ( Gage[i].dataSource != RAIN_FILE ) continue;
+        if ( Gage[i].startFilePos < 0 ||
+             Gage[i].endFilePos > RainMapSize ||
+             (Gage[i].endFilePos - Gage[i].startFilePos) % RecordSize != 0 )
+        {
+            report_writeErrorMsg(ERR_RAIN_IFACE_FORMAT, "");
+            return;
+        }
+        RainSorted[i] = TRUE;
+        lastDate = 0.0;
+        for ( pos = Gage[i].startFilePos; pos < Gage[i].endFilePos;
+              pos += RecordSize )
+        {
+            memcpy(&date, RainMap + pos, sizeof(DateTime));
+            if ( pos > Gage[i].startFilePos && date < lastDate )
+            {
+                RainSorted[i] = FALSE;
+                break;
+            }
+            lastDate = date;
+        }
+    }
+}
+
+//=============================================================================
+
+void unmapRainFile(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: releases the memory holding the rain interface file.
+//
+{
+    if ( RainMap )
+    {
+#ifndef WINDOWS
+        if ( RainMapped ) munmap(RainMap, RainMapSize);
+        else
+#endif
+        free(RainMap);
+    }
+    RainMap = NULL;
+    RainMapSize = 0;
+    RainMapped = FALSE;
+    FREE(RainSorted);
+}
+
+//=============================================================================
+
 void createRainFile(int count)
 //
 //  Input:   count = number of files to include in rain interface file
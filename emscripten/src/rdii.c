@@ -29,6 +29,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include "headers.h"
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Definition of 4-byte integer, 4-byte real and 8-byte real types
@@ -42,6 +45,7 @@
 // Constants
 //-----------------------------------------------------------------------------
 const double ZERO_RDII = 0.0001;       // Minimum non-zero RDII inflow (cfs)
+const int    RDII_BUFSIZE = 1048576;   // Size of RDII file I/O buffer (bytes)
 const char   FileStamp[] = FILE_STAMP;
 
 //-----------------------------------------------------------------------------
@@ -53,6 +57,8 @@ typedef struct                         // Data for a single unit hydrograph
 {                                      // -------------------------------------
    double*   pastRain;                 // array of past rainfall values
    char*     pastMonth;                // month in which past rainfall occurred
+   double*   ordinate;                 // UH ordinate x r-value for each
+                                       // month & time period
    int       period;                   // current UH time period
    int       hasPastRain;              // true if > 0 past periods with rain
    int       maxPeriods;               // max. past rainfall periods
@@ -132,7 +138,7 @@ static double applyIA(int j, int k, DateTime aDate, double dt,
               double rainDepth);
 static void   updateDryPeriod(int j, int k, double rain, int gageInterval);
 static void   getUnitHydRdii(DateTime currentDate);
-static double getUnitHydConvol(int j, int k, int gageInterval);
+static double getUnitHydConvol(int j, int k);
 static double getUnitHydOrd(int j, int m, int k, double t);
 
 static int    getNodeRdii(void);
@@ -183,7 +189,7 @@ int rdii_readRdiiInflow(char* tok[], int ntoks)
     inflow = Node[j].rdiiInflow;
     if ( inflow == NULL )
     {
-        inflow = (TRdiiInflow *) malloc(sizeof(TRdiiInflow));
+        inflow = (TRdiiInflow *) project_alloc(1, sizeof(TRdiiInflow));
         if ( !inflow ) return error_setInpError(ERR_MEMORY, "");
     }
 
@@ -396,11 +402,8 @@ void rdii_deleteRdiiInflow(int j)
 //  Purpose: deletes the RDII inflow object for a node.
 //
 {
-    if ( Node[j].rdiiInflow )
-    {
-        free(Node[j].rdiiInflow);
-        Node[j].rdiiInflow = NULL;
-    }
+    // --- the inflow object itself belongs to the project's memory pool
+    Node[j].rdiiInflow = NULL;
 }
 
 
@@ -441,6 +444,7 @@ void rdii_openRdii()
         }
         return;
     }
+    setvbuf(Frdii.file, NULL, _IOFBF, RDII_BUFSIZE);
 
     // --- check for valid file stamp
     fread(fStamp, sizeof(char), strlen(FileStamp), Frdii.file);
@@ -940,6 +944,7 @@ int  allocRdiiMemory()
         {
             UHGroup[i].uh[k].pastRain = NULL;
             UHGroup[i].uh[k].pastMonth = NULL;
+            UHGroup[i].uh[k].ordinate = NULL;
             UHGroup[i].uh[k].maxPeriods = getMaxPeriods(i, k);
             n = UHGroup[i].uh[k].maxPeriods;
             if ( n > 0 )
@@ -950,6 +955,9 @@ int  allocRdiiMemory()
                 UHGroup[i].uh[k].pastMonth =
                     (char *) calloc(n, sizeof(char));
                 if ( !UHGroup[i].uh[k].pastMonth ) return FALSE;
+                UHGroup[i].uh[k].ordinate =
+                    (double *) calloc(12*n, sizeof(double));
+                if ( !UHGroup[i].uh[k].ordinate ) return FALSE;
             }
         }
     }
@@ -1079,6 +1087,10 @@ void initUnitHydData()
         n;                             // RDII node index
 //  int g,                             // rain gage index
     int month;                         // month index
+    int m,                             // month index
+        p;                             // UH time period index
+    double t;                          // UH time value (sec)
+    TUHData* uh;                       // UH data
 
     // --- initialize UHGroup entries for each Unit Hydrograph
     month = datetime_monthOfYear(StartDateTime) - 1;
@@ -1095,6 +1107,19 @@ void initUnitHydData()
 
             // --- assign initial abstraction used
             UHGroup[i].uh[k].iaUsed = UnitHyd[i].iaInit[month][k];
+
+            // --- tabulate the UH's ordinates (scaled by its r-value) at
+            //     the mid-point time of each time period for each month
+            uh = &UHGroup[i].uh[k];
+            for (m=0; m<12; m++)
+            {
+                for (p=1; p<uh->maxPeriods; p++)
+                {
+                    t = ((double)(p) - 0.5) * (double)UHGroup[i].rainInterval;
+                    uh->ordinate[m*uh->maxPeriods + p] =
+                        getUnitHydOrd(i, m, k, t) * UnitHyd[i].r[m][k];
+                }
+            }
         }
 
         // --- initialize gage date to simulation start date
@@ -1141,6 +1166,9 @@ int openNewRdiiFile()
         return FALSE;
     }
 
+    // --- write RDII flows in large blocks rather than one time step at a time
+    setvbuf(Frdii.file, NULL, _IOFBF, RDII_BUFSIZE);
+
     // --- write file stamp to RDII file
     fwrite(FileStamp, sizeof(char), strlen(FileStamp), Frdii.file);
 
@@ -1321,12 +1349,16 @@ void getUnitHydRdii(DateTime currentDate)
 //  Output:  none
 //  Purpose: computes RDII generated by past rainfall for each UH group.
 //
+//  Note:    each UH group only updates its own processing data, so groups
+//           are examined in parallel.
+//
 {
     int   j;                           // UH group index
     int   k;                           // UH index
-    int   rainInterval;                // rainfall time interval (sec)
 
     // --- examine each UH group
+#pragma omp parallel for private(k) num_threads(NumThreads) \
+    if(Nobjects[UNITHYD] > 1)
     for (j=0; j<Nobjects[UNITHYD]; j++)
     {
         // --- skip calculation if group not used by any RDII node or if
@@ -1338,13 +1370,12 @@ void getUnitHydRdii(DateTime currentDate)
         UHGroup[j].lastDate = UHGroup[j].gageDate;
 
         // --- perform convolution for each UH in the group
-        rainInterval = UHGroup[j].rainInterval;
         UHGroup[j].rdii = 0.0;
         for (k=0; k<3; k++)
         {
             if ( UHGroup[j].uh[k].hasPastRain )
             {
-                UHGroup[j].rdii += getUnitHydConvol(j, k, rainInterval);
+                UHGroup[j].rdii += getUnitHydConvol(j, k);
             }
         }
     }
@@ -1352,53 +1383,51 @@ void getUnitHydRdii(DateTime currentDate)
 
 //=============================================================================
 
-double getUnitHydConvol(int j, int k, int rainInterval)
+double getUnitHydConvol(int j, int k)
 //
 //  Input:   j = UH group index
 //           k = UH index
-//           rainInterval = rainfall time interval (sec)
 //  Output:  returns a RDII flow value
 //  Purpose: computes convolution of Unit Hydrographs with past rainfall.
 //
+//  Note:    the UH ordinates are tabulated by initUnitHydData, so the
+//           convolution is a dot product of the ordinates with the past
+//           rainfall values, which are stored in a ring buffer that is
+//           traversed backwards in two contiguous pieces.
+//
 {
     int    i;                          // previous rainfall period index
-    int    m;                          // month of year index
     int    p;                          // UH time period index
     int    pMax;                       // max. number of periods
-    double t;                          // UH time value (sec)
-    double u;                          // UH ordinate
-    double v;                          // rainfall volume
     double rdii;                       // RDII flow
+    double* rain;                      // past rainfall values
+    char*  month;                      // month of each past rainfall value
+    double* ord;                       // UH ordinates for each month
     TUHData* uh;                       // UH data
 
     // --- initialize RDII, rain period index and UH period index
     rdii = 0.0;
     uh = &UHGroup[j].uh[k];
-    i = uh->period - 1;
-    if ( i < 0 ) i = uh->maxPeriods - 1;
+    rain = uh->pastRain;
+    month = uh->pastMonth;
+    ord = uh->ordinate;
     pMax = uh->maxPeriods;
+    i = uh->period - 1;
+    if ( i < 0 ) i = pMax - 1;
     p = 1;
 
-    // --- evaluate each time period of UH's
-    while ( p < pMax )
+    // --- convolute UH ordinates with rainfall from the most recent
+    //     rain period back to the start of the ring buffer
+    //     (periods without rainfall add nothing to the sum)
+    for ( ; p < pMax && i >= 0; p++, i-- )
     {
-        // --- if rain period has rainfall
-        v = uh->pastRain[i];
-        m = uh->pastMonth[i];
-        if ( v > 0.0 )
-        {
-            // --- find mid-point time of UH period in seconds
-            t = ((double)(p) - 0.5) * (double)rainInterval;
-
-            // --- convolute rain volume with UH ordinate
-            u = getUnitHydOrd(j, m, k, t) * UnitHyd[j].r[m][k];
-            rdii += u * v;
-        }
+        rdii += ord[month[i]*pMax + p] * rain[i];
+    }
 
-        // --- move to next UH period & previous rainfall period
-        p = p + 1;
-        i = i - 1;
-        if ( i < 0 ) i = uh->maxPeriods - 1;
+    // --- then continue from the end of the ring buffer
+    for ( i = pMax - 1; p < pMax; p++, i-- )
+    {
+        rdii += ord[month[i]*pMax + p] * rain[i];
     }
     return rdii;
 }
@@ -1527,6 +1556,7 @@ void freeRdiiMemory()
             {
                 FREE(UHGroup[i].uh[k].pastRain);
                 FREE(UHGroup[i].uh[k].pastMonth);
+                FREE(UHGroup[i].uh[k].ordinate);
             }
         }
         FREE(UHGroup);
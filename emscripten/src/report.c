@@ -79,6 +79,7 @@ extern REAL4* SubcatchResults;         // Results vectors defined in OUTPUT.C
 extern REAL4* NodeResults;             //  "
 extern REAL4* LinkResults;             //  "
 extern char   ErrString[81];           // defined in ERROR.C
+#pragma omp threadprivate(ErrString)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -355,16 +356,22 @@ void report_writeOptions()
         fprintf(Frpt.file, "\n  Wet Time Step ............ %s", str);
         datetime_timeToStr(datetime_encodeTime(0, 0, DryStep), str);
         fprintf(Frpt.file, "\n  Dry Time Step ............ %s", str);
+        if ( SkipDryPeriods )
+            fprintf(Frpt.file, "\n  Skip Dry Periods ......... YES");
     }
     if ( Nobjects[LINK] > 0 )
     {
         fprintf(Frpt.file, "\n  Routing Time Step ........ %.2f sec", RouteStep);
+        if ( SkipSteadyRegions )
+            fprintf(Frpt.file, "\n  Skip Steady Regions ...... YES");
 		if ( RouteModel == DW )
 		{
 		fprintf(Frpt.file, "\n  Variable Time Step ....... ");
 		if ( CourantFactor > 0.0 ) fprintf(Frpt.file, "YES");
 		else                       fprintf(Frpt.file, "NO");
 		fprintf(Frpt.file, "\n  Maximum Trials ........... %d", MaxTrials);
+		if ( ActiveSet )
+		fprintf(Frpt.file, "\n  Active Set Iterations .... YES");
         fprintf(Frpt.file, "\n  Number of Threads ........ %d", NumThreads);
 		fprintf(Frpt.file, "\n  Head Tolerance ........... %.6f ",
             HeadTol*UCF(LENGTH));
@@ -57,10 +57,21 @@
 // Shared variables
 //-----------------------------------------------------------------------------
 static int* SortedLinks;
+static int* TreeStart;                 // start of each subtree in SortedLinks
+static int  NumTrees;                  // number of independent link subtrees
 static int  NextEvent;
 static int  BetweenEvents;
 static double NewRuleTime;                                                     //(5.1.013)
 
+// --- steady state regions (connected parts of the conveyance network)
+static int    NumRegions;              // number of regions
+static int*   NodeRegion;              // region index of each node
+static int*   LinkRegion;              // region index of each link
+static char*  RegionChanged;           // TRUE if region's state has changed
+static double* RegionInflow;           // region inflow at last step (cfs)
+static double* RegionOutflow;          // region outflow at last step (cfs)
+static double* RoutedLatFlow;          // node lateral inflow when last routed
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -84,6 +95,10 @@ static void removeConduitLosses(void);
 static void removeOutflows(double tStep);
 static int  inflowHasChanged(void);
 static void sortEvents(void);
+static int  createRegions(void);
+static int  findSteadyRegions(void);
+static int  freezeRegions(int steadyCount);
+static int  flowHasChanged(double qOld, double qNew);
 
 //=============================================================================
 
@@ -98,19 +113,34 @@ int routing_open()
     if ( !treatmnt_open() ) return ErrorCode;
 
     // --- topologically sort the links
+    //     (grouping them into independent subtrees for Kin. Wave routing)
     SortedLinks = NULL;
+    TreeStart = NULL;
+    NumTrees = 0;
     if ( Nobjects[LINK] > 0 )
     {
         SortedLinks = (int *) calloc(Nobjects[LINK], sizeof(int));
-        if ( !SortedLinks )
+        TreeStart = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+        if ( !SortedLinks || !TreeStart )
         {
             report_writeErrorMsg(ERR_MEMORY, "");
             return ErrorCode;
         }
-        toposort_sortLinks(SortedLinks);
+        NumTrees = toposort_sortLinks(SortedLinks, TreeStart);
         if ( ErrorCode ) return ErrorCode;
     }
 
+    // --- identify independent regions of the network
+    NumRegions = 0;
+    if ( SkipSteadyRegions && Nobjects[LINK] > 0 && !createRegions() )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
+    // --- allocate water quality routing arrays
+    if ( qualrout_open() ) return ErrorCode;
+
     // --- open any routing interface files
     iface_openRoutingFiles();
 
@@ -140,8 +170,16 @@ void routing_close(int routingModel)
 
     // --- free allocated memory
     flowrout_close(routingModel);
+    qualrout_close();
     treatmnt_close();
     FREE(SortedLinks);
+    FREE(TreeStart);
+    FREE(NodeRegion);
+    FREE(LinkRegion);
+    FREE(RegionChanged);
+    FREE(RegionInflow);
+    FREE(RegionOutflow);
+    FREE(RoutedLatFlow);
 }
 
 //=============================================================================
@@ -211,6 +249,7 @@ void routing_execute(int routingModel, double routingStep)
     int      stepCount = 1;
     int      actionCount = 0;
     int      inSteadyState = FALSE;
+    int      steadyCount = 0;
     DateTime currentDate;
     double   stepFlowError;
 
@@ -234,6 +273,7 @@ void routing_execute(int routingModel, double routingStep)
     }                                                                          //
 
     // --- change each link's actual setting if it differs from its target
+    for (j=0; j<NumRegions; j++) RegionChanged[j] = FALSE;
     for (j=0; j<Nobjects[LINK]; j++)
     {
         if ( Link[j].targetSetting != Link[j].setting )
@@ -245,6 +285,7 @@ void routing_execute(int routingModel, double routingStep)
             // --- implement the change in the link's setting
             link_setSetting(j, routingStep);
             actionCount++;
+            if ( NumRegions > 0 ) RegionChanged[LinkRegion[j]] = TRUE;
         } 
     }
 
@@ -320,13 +361,25 @@ void routing_execute(int routingModel, double routingStep)
             else inSteadyState = TRUE;
         }
 
+        // --- check which regions of the network can be skipped
+        if ( NumRegions > 0 && inSteadyState == FALSE )
+        {
+            steadyCount = freezeRegions(findSteadyRegions());
+            if ( steadyCount == NumRegions ) inSteadyState = TRUE;
+        }
+
         // --- find new hydraulic state if system has changed
         if ( inSteadyState == FALSE )
         {
             // --- replace old hydraulic state values with current ones
-            for (j = 0; j < Nobjects[LINK]; j++) link_setOldHydState(j);
+            //     (objects in frozen regions keep their current state)
+            for (j = 0; j < Nobjects[LINK]; j++)
+            {
+                if ( !Link[j].frozen ) link_setOldHydState(j);
+            }
             for (j = 0; j < Nobjects[NODE]; j++)
             {
+                if ( Node[j].frozen ) continue;
                 node_setOldHydState(j);
                 node_initInflow(j, routingStep);
             }
@@ -334,7 +387,8 @@ void routing_execute(int routingModel, double routingStep)
             // --- route flow through the drainage network
             if ( Nobjects[LINK] > 0 )
             {
-                stepCount = flowrout_execute(SortedLinks, routingModel, routingStep);
+                stepCount = flowrout_execute(SortedLinks, TreeStart, NumTrees,
+                                             routingModel, routingStep);
             }
         }
 
@@ -714,25 +768,16 @@ int  inflowHasChanged()
 //
 {
     int    j;
-    double diff, qOld, qNew;
 
     // --- check if external inflows or outfall flows have changed 
     for (j = 0; j < Nobjects[NODE]; j++)
     {
-        qOld = Node[j].oldLatFlow;
-        qNew = Node[j].newLatFlow;
-        if      ( fabs(qOld) > TINY ) diff = (qNew / qOld) - 1.0;
-        else if ( fabs(qNew) > TINY ) diff = 1.0;
-        else                    diff = 0.0;
-        if ( fabs(diff) > LatFlowTol ) return TRUE;
+        if ( flowHasChanged(Node[j].oldLatFlow, Node[j].newLatFlow) )
+            return TRUE;
         if ( Node[j].type == OUTFALL || Node[j].degree == 0 )
         {
-            qOld = Node[j].oldFlowInflow;
-            qNew = Node[j].inflow;
-            if      ( fabs(qOld) > TINY ) diff = (qNew / qOld) - 1.0;
-            else if ( fabs(qNew) > TINY ) diff = 1.0;
-            else                          diff = 0.0;
-            if ( fabs(diff) > LatFlowTol ) return TRUE;
+            if ( flowHasChanged(Node[j].oldFlowInflow, Node[j].inflow) )
+                return TRUE;
         }
     }
     return FALSE;
@@ -858,6 +903,228 @@ void removeOutflows(double tStep)
 
 //=============================================================================
 
+int  createRegions()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: partitions the conveyance network into regions of nodes that
+//           are connected to one another by links.
+//
+//  A region shares no node or link with any other region, so its flows
+//  can be left unrouted while it remains in steady state without
+//  affecting the rest of the network.
+//
+{
+    int i, j, r1, r2;
+    int nNodes = Nobjects[NODE];
+    int nLinks = Nobjects[LINK];
+
+    NodeRegion = (int *) calloc(nNodes, sizeof(int));
+    LinkRegion = (int *) calloc(nLinks, sizeof(int));
+    if ( !NodeRegion || !LinkRegion ) return FALSE;
+
+    // --- join the end nodes of each link into a common tree
+    //     (NodeRegion temporarily holds each node's parent in its tree)
+    for (i = 0; i < nNodes; i++) NodeRegion[i] = i;
+    for (j = 0; j < nLinks; j++)
+    {
+        r1 = toposort_findTreeRoot(NodeRegion, Link[j].node1);
+        r2 = toposort_findTreeRoot(NodeRegion, Link[j].node2);
+        if ( r1 < r2 )      NodeRegion[r2] = r1;
+        else if ( r2 < r1 ) NodeRegion[r1] = r2;
+    }
+
+    // --- point each node directly at the root of its tree and then
+    //     number the regions in order of their lowest node index
+    //     (a root node always precedes the other nodes of its tree)
+    for (i = 0; i < nNodes; i++)
+        NodeRegion[i] = toposort_findTreeRoot(NodeRegion, i);
+    NumRegions = 0;
+    for (i = 0; i < nNodes; i++)
+    {
+        if ( NodeRegion[i] == i ) NodeRegion[i] = NumRegions++;
+        else NodeRegion[i] = NodeRegion[NodeRegion[i]];
+    }
+    for (j = 0; j < nLinks; j++) LinkRegion[j] = NodeRegion[Link[j].node1];
+
+    // --- a single region is handled by the SKIP_STEADY_STATE option
+    if ( NumRegions < 2 )
+    {
+        NumRegions = 0;
+        return TRUE;
+    }
+    RegionChanged = (char *) calloc(NumRegions, sizeof(char));
+    RegionInflow = (double *) calloc(NumRegions, sizeof(double));
+    RegionOutflow = (double *) calloc(NumRegions, sizeof(double));
+    RoutedLatFlow = (double *) calloc(nNodes, sizeof(double));
+    if ( !RegionChanged || !RegionInflow || !RegionOutflow ||
+         !RoutedLatFlow ) return FALSE;
+    return TRUE;
+}
+
+//=============================================================================
+
+int  findSteadyRegions()
+//
+//  Input:   none
+//  Output:  returns number of regions in steady state
+//  Purpose: determines which regions of the network have not changed
+//           since the previous time step.
+//
+//  The tests applied to each region mirror those made for the entire
+//  system by the SKIP_STEADY_STATE option, except that lateral inflows
+//  are compared with those of the last time step the region was routed
+//  so that a slow drift in inflow cannot keep a region frozen.
+//
+{
+    int    i, r;
+    int    count = 0;
+    double q;
+
+    for (r = 0; r < NumRegions; r++)
+    {
+        if ( OldRoutingTime == 0.0 ) RegionChanged[r] = TRUE;
+        RegionInflow[r] = 0.0;
+        RegionOutflow[r] = 0.0;
+    }
+
+    // --- check for changes in lateral inflows and outfall flows
+    //     while accumulating the flow balance of each region
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        r = NodeRegion[i];
+        if ( flowHasChanged(RoutedLatFlow[i], Node[i].newLatFlow) )
+            RegionChanged[r] = TRUE;
+        if ( Node[i].type == OUTFALL || Node[i].degree == 0 )
+        {
+            if ( flowHasChanged(Node[i].oldFlowInflow, Node[i].inflow) )
+                RegionChanged[r] = TRUE;
+        }
+        q = Node[i].oldLatFlow;
+        if ( q >= 0.0 ) RegionInflow[r] += q;
+        else            RegionOutflow[r] -= q;
+        if ( Node[i].type == OUTFALL ) RegionOutflow[r] += Node[i].inflow;
+        RegionOutflow[r] += Node[i].overflow + Node[i].losses;
+    }
+
+    // --- a region whose inflow and outflow are out of balance
+    //     is still filling or draining
+    for (r = 0; r < NumRegions; r++)
+    {
+        if ( RegionChanged[r] ) continue;
+        if ( RegionInflow[r] > TINY &&
+             fabs(1.0 - RegionOutflow[r] / RegionInflow[r]) > SysFlowTol )
+            RegionChanged[r] = TRUE;
+        else if ( RegionInflow[r] <= TINY && RegionOutflow[r] > TINY )
+            RegionChanged[r] = TRUE;
+        else count++;
+    }
+    return count;
+}
+
+//=============================================================================
+
+int  freezeRegions(int steadyCount)
+//
+//  Input:   steadyCount = number of regions in steady state
+//  Output:  returns number of regions left frozen
+//  Purpose: flags the nodes and links of steady state regions so that the
+//           flow routing step leaves them unchanged.
+//
+//  A frozen region keeps its hydraulic state, so to conserve mass its
+//  outfalls are made to discharge whatever net lateral inflow the region
+//  receives over the time step. A region that cannot pass on its inflow
+//  this way (e.g., one without a discharging outfall) is routed instead.
+//
+{
+    int i, j, r;
+
+    if ( steadyCount == 0 )
+    {
+        for (i = 0; i < Nobjects[NODE]; i++)
+        {
+            Node[i].frozen = FALSE;
+            RoutedLatFlow[i] = Node[i].newLatFlow;
+        }
+        for (i = 0; i < Nobjects[LINK]; i++) Link[i].frozen = FALSE;
+        return 0;
+    }
+
+    // --- find the net inflow each steady region must pass on to its
+    //     outfalls and the flow those outfalls currently discharge
+    for (r = 0; r < NumRegions; r++)
+    {
+        RegionInflow[r] = 0.0;
+        RegionOutflow[r] = 0.0;
+    }
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        r = NodeRegion[i];
+        if ( RegionChanged[r] ) continue;
+        RegionInflow[r] += Node[i].newLatFlow - Node[i].losses;
+        if ( Node[i].type == OUTFALL )
+        {
+            if ( Node[i].outflow == 0.0 ) RegionOutflow[r] += Node[i].inflow;
+        }
+        else if ( Node[i].newVolume <= Node[i].fullVolume )
+            RegionInflow[r] -= Node[i].overflow;
+    }
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        r = LinkRegion[i];
+        if ( RegionChanged[r] || Link[i].type != CONDUIT ) continue;
+        j = Link[i].subIndex;
+        RegionInflow[r] -= (Conduit[j].evapLossRate +
+                            Conduit[j].seepLossRate) * Conduit[j].barrels;
+    }
+
+    // --- route any steady region whose outfalls cannot carry its inflow
+    for (r = 0; r < NumRegions; r++)
+    {
+        if ( RegionChanged[r] ) continue;
+        if ( RegionOutflow[r] > TINY && RegionInflow[r] >= 0.0 ) continue;
+        if ( fabs(RegionInflow[r]) <= TINY && RegionOutflow[r] <= TINY )
+            continue;
+        RegionChanged[r] = TRUE;
+        steadyCount--;
+    }
+
+    // --- flag the objects of frozen regions and rescale their outfall flows
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        r = NodeRegion[i];
+        Node[i].frozen = !RegionChanged[r];
+        if ( !Node[i].frozen ) RoutedLatFlow[i] = Node[i].newLatFlow;
+        else if ( Node[i].type == OUTFALL && Node[i].outflow == 0.0 &&
+                  RegionOutflow[r] > TINY )
+            Node[i].inflow *= RegionInflow[r] / RegionOutflow[r];
+    }
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        Link[i].frozen = !RegionChanged[LinkRegion[i]];
+    }
+    return steadyCount;
+}
+
+//=============================================================================
+
+int  flowHasChanged(double qOld, double qNew)
+//
+//  Input:   qOld = flow at previous time step (cfs)
+//           qNew = flow at current time step (cfs)
+//  Output:  returns TRUE if relative change in flow exceeds LatFlowTol
+//  Purpose: checks if a flow has changed between time steps.
+//
+{
+    double diff;
+    if      ( fabs(qOld) > TINY ) diff = (qNew / qOld) - 1.0;
+    else if ( fabs(qNew) > TINY ) diff = 1.0;
+    else                          diff = 0.0;
+    return ( fabs(diff) > LatFlowTol );
+}
+
+//=============================================================================
+
 void sortEvents()
 //
 //  Input:   none
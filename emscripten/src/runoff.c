@@ -39,8 +39,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include "headers.h"
 #include "odesolve.h"
+#include "infil.h"
+#include "lid.h"
 
 //-----------------------------------------------------------------------------
 // Shared variables
@@ -48,11 +51,25 @@
 static char  IsRaining;                // TRUE if precip. falls on study area
 static char  HasRunoff;                // TRUE if study area generates runoff
 static char  HasSnow;                  // TRUE if any snow cover on study area
+static char  CanSkipDry;               // TRUE if dry periods take one step
+static char  DailyDryStep;             // TRUE if dry steps end at midnight
 static int   Nsteps;                   // number of runoff time steps taken
 static int   MaxSteps;                 // final number of runoff time steps
 static long  MaxStepsPos;              // position in Runoff interface file
                                        //    where MaxSteps is saved
 
+// Batch of pervious sub-areas whose infiltration is computed together
+static int*    InfilSubcatch;          // subcatchment index
+static double* InfilRain;              // net precip. rate (ft/sec)
+static double* InfilRunon;             // runon rate (ft/sec)
+static double* InfilDepth;             // ponded depth (ft)
+static double* InfilRate;              // infiltration rate (ft/sec)
+
+// Precipitation evaluated once per rain gage
+static double* GageRain;               // rainfall at each gage (ft/sec)
+static double* GageSnow;               // snowfall at each gage (ft/sec)
+static double* GageMelt;               // melt from rain at each gage (ft/sec)
+
 //-----------------------------------------------------------------------------
 //  Exportable variables 
 //-----------------------------------------------------------------------------
@@ -75,10 +92,14 @@ extern float* SubcatchResults;         // Results vector defined in OUTPUT.C
 // Local functions
 //-----------------------------------------------------------------------------
 static double runoff_getTimeStep(DateTime currentDate);
+static void   runoff_initDryPeriods(void);
+static long   runoff_getDryPeriodStep(DateTime currentDate);
 static void   runoff_initFile(void);
 static void   runoff_readFromFile(void);
 static void   runoff_saveToFile(float tStep);
 static void   runoff_getOutfallRunon(double tStep);
+static void   runoff_getInfil(double tStep);
+static void   runoff_getNetPrecip(double tStep);
 
 //=============================================================================
 
@@ -97,6 +118,35 @@ int runoff_open()
     // --- open the Ordinary Differential Equation solver
     if ( !odesolve_open(MAXODES) ) report_writeErrorMsg(ERR_ODE_SOLVER, "");
 
+    // --- allocate memory for updating groundwater
+    gwater_open();
+
+    // --- index the runon received by each subcatchment
+    subcatch_openRunon();
+
+    // --- list the LID units that are evaluated together
+    lid_openBatch();
+
+    // --- see if dry periods can be crossed in a single time step
+    runoff_initDryPeriods();
+
+    // --- allocate memory for batch infiltration computations
+    InfilSubcatch = (int *) calloc(Nobjects[SUBCATCH]+1, sizeof(int));
+    InfilRain = (double *) calloc(Nobjects[SUBCATCH]+1, sizeof(double));
+    InfilRunon = (double *) calloc(Nobjects[SUBCATCH]+1, sizeof(double));
+    InfilDepth = (double *) calloc(Nobjects[SUBCATCH]+1, sizeof(double));
+    InfilRate = (double *) calloc(Nobjects[SUBCATCH]+1, sizeof(double));
+    if ( !InfilSubcatch || !InfilRain || !InfilRunon || !InfilDepth ||
+         !InfilRate ) report_writeErrorMsg(ERR_MEMORY, "");
+
+    // --- allocate memory for precipitation at each rain gage
+    //     (the extra slot serves subcatchments without a gage)
+    GageRain = (double *) calloc(Nobjects[GAGE]+1, sizeof(double));
+    GageSnow = (double *) calloc(Nobjects[GAGE]+1, sizeof(double));
+    GageMelt = (double *) calloc(Nobjects[GAGE]+1, sizeof(double));
+    if ( !GageRain || !GageSnow || !GageMelt )
+        report_writeErrorMsg(ERR_MEMORY, "");
+
     // --- allocate memory for pollutant runoff loads
     OutflowLoad = NULL;
     if ( Nobjects[POLLUT] > 0 )
@@ -133,8 +183,19 @@ void runoff_close()
 {
     // --- close the ODE solver
     odesolve_close();
-
-    // --- free memory for pollutant runoff loads
+    gwater_close();
+    subcatch_closeRunon();
+    lid_closeBatch();
+
+    // --- free memory for batch infiltration & pollutant runoff loads
+    FREE(InfilSubcatch);
+    FREE(InfilRain);
+    FREE(InfilRunon);
+    FREE(InfilDepth);
+    FREE(InfilRate);
+    FREE(GageRain);
+    FREE(GageSnow);
+    FREE(GageMelt);
     FREE(OutflowLoad);
 
     // --- close runoff interface file if in use
@@ -241,14 +302,36 @@ void runoff_execute()
     // --- determine any runon from drainage system outfall nodes
     if ( oldRunoffStep > 0.0 ) runoff_getOutfallRunon(oldRunoffStep);
 
-    // --- determine runon from upstream subcatchments, and implement snow removal
+    // --- determine runon from upstream subcatchments
+    //     (each subcatchment gathers its own runon so they are independent)
+#pragma omp parallel for num_threads(NumThreads) schedule(static) \
+    if(NumThreads > 1)
     for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        if ( Subcatch[j].area == 0.0 ) continue;
         subcatch_getRunon(j);
-        if ( !IgnoreSnowmelt ) snow_plowSnow(j, runoffStep);
     }
-    
+
+    // --- implement snow removal
+    if ( !IgnoreSnowmelt ) for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        snow_plowSnow(j, runoffStep);
+    }
+
+    // --- find net precipitation on each subcatchment and then the
+    //     infiltration into all pervious sub-areas in a single batch
+    runoff_getNetPrecip(runoffStep);
+    runoff_getInfil(runoffStep);
+
+    // --- find runoff from the non-LID portion of each subcatchment and
+    //     then evaluate the LID units of all subcatchments in a single batch
+    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        subcatch_getNonLidRunoff(j, runoffStep);
+    }
+    lid_evalUnits(runoffStep);
+
     // --- determine runoff and pollutant buildup/washoff in each subcatchment
     HasSnow = FALSE;
     HasRunoff = FALSE;
@@ -279,6 +362,9 @@ void runoff_execute()
         surfqual_getWashoff(j, runoff, runoffStep);
     }
 
+    // --- update groundwater levels & flows
+    if ( !IgnoreGwater ) gwater_getGroundwater(runoffStep);
+
     // --- update tracking of system-wide max. runoff rate
     stats_updateMaxRunoff();
 
@@ -305,6 +391,10 @@ double runoff_getTimeStep(DateTime currentDate)
     int  j;
     long timeStep;
     long maxStep = DryStep;
+    char isWet = IsRaining || HasSnow || HasRunoff || HasWetLids;
+
+    // --- a dry period can be crossed in a single time step
+    if ( CanSkipDry && !isWet ) maxStep = runoff_getDryPeriodStep(currentDate);
 
     // --- find shortest time until next evaporation or rainfall value
     //     (this represents the maximum possible time step)
@@ -318,10 +408,8 @@ double runoff_getTimeStep(DateTime currentDate)
     }
 
     // --- determine whether wet or dry time step applies
-    if ( IsRaining || HasSnow || HasRunoff || HasWetLids )
-    {
-        timeStep = WetStep;
-    }
+    if ( isWet ) timeStep = WetStep;
+    else if ( CanSkipDry ) timeStep = maxStep;
     else timeStep = DryStep;
 
     // --- limit time step if necessary
@@ -331,6 +419,115 @@ double runoff_getTimeStep(DateTime currentDate)
 
 //=============================================================================
 
+void runoff_getNetPrecip(double tStep)
+//
+//  Input:   tStep = time step (sec)
+//  Output:  none
+//  Purpose: finds the net precipitation on each subcatchment.
+//
+//  Rainfall, snowfall and rain-on-snow melt are evaluated once per rain gage
+//  and then applied to each subcatchment served by that gage.
+//
+{
+    int    j, k;
+    int    nGages = Nobjects[GAGE];
+
+    // --- evaluate precip. at each rain gage
+    for (k = 0; k < nGages; k++)
+    {
+        gage_getPrecip(k, &GageRain[k], &GageSnow[k]);
+        if ( IgnoreSnowmelt ) GageMelt[k] = 0.0;
+        else GageMelt[k] = snow_getRainmelt(GageRain[k]);
+    }
+
+    // --- apply it to each subcatchment
+    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        k = Subcatch[j].gage;
+        if ( k < 0 ) k = nGages;
+        subcatch_getNetPrecip(j, GageRain[k], GageSnow[k], GageMelt[k],
+                              tStep);
+    }
+}
+
+//=============================================================================
+
+void runoff_initDryPeriods()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: determines if the SKIP_DRY_PERIODS option can be applied.
+//
+//  During a dry period infiltration capacity recovers and pollutants build
+//  up according to expressions that are exact for any length of time step,
+//  so the period can be crossed in one time step that ends when rainfall
+//  resumes. Groundwater recession is not exact over a long step, so the
+//  aquifer of each subcatchment that has one is still integrated in
+//  sub-steps no longer than the dry time step (see gwater_getGroundwater).
+//  The option is not applied when outfall flows are routed back onto
+//  subcatchments (they are only applied at the end of a runoff step) or
+//  when buildup is supplied externally, and with street sweeping or
+//  temperature-based evaporation (which change from day to day) each dry
+//  step ends at midnight.
+//
+{
+    int i, p;
+
+    CanSkipDry = SkipDryPeriods;
+    DailyDryStep = Evap.type == TEMPERATURE_EVAP;
+    if ( !CanSkipDry ) return;
+
+    // --- outfall flows re-routed onto subcatchments
+    for (i = 0; i < Nnodes[OUTFALL]; i++)
+    {
+        if ( Outfall[i].routeTo >= 0 ) CanSkipDry = FALSE;
+    }
+
+    // --- external buildup & street sweeping
+    if ( IgnoreQuality ) return;
+    for (i = 0; i < Nobjects[LANDUSE]; i++)
+    {
+        if ( Landuse[i].sweepInterval > 0.0 ) DailyDryStep = TRUE;
+        for (p = 0; p < Nobjects[POLLUT]; p++)
+        {
+            if ( Landuse[i].buildupFunc[p].funcType == EXTERNAL_BUILDUP )
+                CanSkipDry = FALSE;
+        }
+    }
+}
+
+//=============================================================================
+
+long runoff_getDryPeriodStep(DateTime currentDate)
+//
+//  Input:   currentDate = current simulation date/time
+//  Output:  returns the longest time step (sec) allowed in a dry period
+//  Purpose: finds the time until the next midnight or start of a new month
+//           (after which climate conditions and monthly adjustments can
+//           change).
+//
+{
+    int      yr, mon, day;
+    DateTime nextDate;
+
+    if ( DailyDryStep ) nextDate = floor(currentDate) + 1.0;
+    else
+    {
+        datetime_decodeDate(currentDate, &yr, &mon, &day);
+        if ( mon == 12 )
+        {
+            mon = 1;
+            yr++;
+        }
+        else mon++;
+        nextDate = datetime_encodeDate(yr, mon, 1);
+    }
+    return MAX(datetime_timeDiff(nextDate, currentDate), DryStep);
+}
+
+//=============================================================================
+
 void runoff_initFile(void)
 //
 //  Input:   none
@@ -524,3 +721,45 @@ void runoff_getOutfallRunon(double tStep)
         }
     }
 }
+
+//=============================================================================
+
+void runoff_getInfil(double tStep)
+//
+//  Input:   tStep = runoff time step (sec)
+//  Output:  none
+//  Purpose: computes infiltration into the pervious sub-area of every
+//           subcatchment in a single batch.
+//
+//  Net precipitation and sub-area inflows must already be known. The
+//  resulting rates are used by subcatch_getRunoff.
+//
+{
+    int       j, k;
+    int       n = 0;
+    double    nonLidArea;
+    TSubarea* subarea;
+
+    // --- gather the pervious sub-areas that will produce runoff
+    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        nonLidArea = Subcatch[j].area - Subcatch[j].lidArea;
+        if ( nonLidArea <= 0.0 ) continue;
+        subarea = &Subcatch[j].subArea[PERV];
+        if ( nonLidArea * subarea->fArea == 0.0 ) continue;
+        InfilSubcatch[n] = j;
+        InfilRain[n] = Subcatch[j].netPrecip[PERV];
+        InfilRunon[n] = subarea->inflow;
+        InfilDepth[n] = subarea->depth;
+        n++;
+    }
+
+    // --- compute their infiltration rates & save them with each sub-area
+    infil_getInfilBatch(n, InfilSubcatch, tStep, InfilRain, InfilRunon,
+                        InfilDepth, InfilRate);
+    for (k = 0; k < n; k++)
+    {
+        Subcatch[InfilSubcatch[k]].subArea[PERV].infil = InfilRate[k];
+    }
+}
@@ -39,7 +39,8 @@ enum SnowKeywords {SNOW_PLOWABLE, SNOW_IMPERV, SNOW_PERV, SNOW_REMOVAL};
 //  snow_readMeltParams  (called from parseLine in input.c)
 //  snow_setMeltCoeffs   (called from setTemp in climate.c)
 //  snow_plowSnow        (called from runoff_execute)
-//  snow_getSnowMelt     (called from subcatch_getRunoff)
+//  snow_getRainmelt     (called from runoff_execute)
+//  snow_getSnowMelt     (called from subcatch_getNetPrecip)
 //  snow_getSnowCover    (called from massbal_open)
 //  snow_getState        (called from saveRunoff in hotstart.c)
 
@@ -47,7 +48,6 @@ enum SnowKeywords {SNOW_PLOWABLE, SNOW_IMPERV, SNOW_PERV, SNOW_REMOVAL};
 //  Local functions
 //-----------------------------------------------------------------------------
 static void   setMeltParams(int i, int k, double x[]);
-static double getRainmelt(double rainfall);
 static double getArealDepletion(TSnowpack* snowpack, int i, double snowfall,
               double tStep);
 static double getArealSnowCover(int i, double awesi);
@@ -130,7 +130,7 @@ int snow_createSnowpack(int j, int k)
 //
 {
     TSnowpack* snowpack;
-    snowpack = (TSnowpack *) malloc(sizeof(TSnowpack));
+    snowpack = (TSnowpack *) project_alloc(1, sizeof(TSnowpack));
     if ( !snowpack ) return FALSE;
     Subcatch[j].snowpack = snowpack;
     snowpack->snowmeltIndex = k;
@@ -452,12 +452,42 @@ void snow_plowSnow(int j, double tStep)
 
 //=============================================================================
 
-double snow_getSnowMelt(int j, double rainfall, double snowfall, double tStep,
-                        double netPrecip[])
+double snow_getRainmelt(double rainfall)
+//
+//  Input:   rainfall = rainfall rate (ft/sec)
+//  Output:  returns snow melt rate (ft/sec)
+//  Purpose: computes rate of snow melt when rainfall occurs.
+//
+//  Depends only on the rainfall rate and current climate conditions, so it
+//  is evaluated once per rain gage each time step (see runoff_execute).
+//
+{
+    double uadj;                       // adjusted wind speed
+    double t1, t2, t3;
+    double smelt;                      // snow melt in in/hr
+
+    rainfall = rainfall * 43200.0;     // convert rain to in/hr
+    if ( rainfall > 0.02 )
+    {
+        uadj = 0.006 * Wind.ws;
+        t1 = Temp.ta - 32.0;
+        t2 = 7.5 * Temp.gamma * uadj;
+        t3 = 8.5 * uadj * (Temp.ea - 0.18);
+        smelt =  t1 * (0.001167 + t2 +  0.007 * rainfall) + t3;
+        return smelt / 43200.0;
+    }
+    else return 0.0;
+}
+
+//=============================================================================
+
+double snow_getSnowMelt(int j, double rainfall, double snowfall, double rmelt,
+                        double tStep, double netPrecip[])
 //
 //  Input:   j = subcatchment index
 //           rainfall = rainfall (ft/sec)
 //           snowfall = snowfall (ft/sec)
+//           rmelt = melt rate when rain falling (ft/sec)
 //           tStep = time step (sec)
 //  Output:  netPrecip = rainfall + snowmelt on each runoff sub-area (ft/sec),
 //           returns new snow depth over subcatchment
@@ -466,7 +496,6 @@ double snow_getSnowMelt(int j, double rainfall, double snowfall, double tStep,
 //
 {
     int     i;                         // snow sub-area index
-    double  rmelt;                     // melt rate when rain falling (ft/sec)
     double  smelt;                     // snow melt from sub-area (ft/sec)
     double  asc;                       // frac. of sub-area snow covered
     double  snowDepth = 0.0;           // snow depth on entire subcatchment (ft)
@@ -476,9 +505,6 @@ double snow_getSnowMelt(int j, double rainfall, double snowfall, double tStep,
     // --- get ptr. to subcatchment's snowpack
     snowpack = Subcatch[j].snowpack;
 
-    // --- compute snowmelt over entire subcatchment when rain falling
-    rmelt = getRainmelt(rainfall);
-
     // --- compute snow melt from each type of subarea
     for (i=SNOW_PLOWABLE; i<=SNOW_PERV; i++)
     {
@@ -714,32 +740,6 @@ double meltSnowpack(TSnowpack* snowpack, int i, double rmelt, double asc,
 
 //=============================================================================
 
-double getRainmelt(double rainfall)
-//
-//  Input:   rainfall = rainfall rate (ft/sec)
-//  Output:  returns snow melt rate (ft/sec)
-//  Purpose: computes rate of snow melt when rainfall occurs.
-//
-{
-    double uadj;                       // adjusted wind speed
-    double t1, t2, t3;
-    double smelt;                      // snow melt in in/hr
-
-    rainfall = rainfall * 43200.0;     // convert rain to in/hr
-    if ( rainfall > 0.02 )
-    {
-        uadj = 0.006 * Wind.ws;
-        t1 = Temp.ta - 32.0;
-        t2 = 7.5 * Temp.gamma * uadj;
-        t3 = 8.5 * uadj * (Temp.ea - 0.18);
-        smelt =  t1 * (0.001167 + t2 +  0.007 * rainfall) + t3;
-        return smelt / 43200.0;
-    }
-    else return 0.0;
-}
-
-//=============================================================================
-
 void updateColdContent(TSnowpack* snowpack, int i, double asc, double snowfall,
                        double tStep)
 //
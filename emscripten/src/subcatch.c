@@ -88,6 +88,17 @@ static  double    Dstore;         // monthly adjusted depression storage (ft)  /
 static  double    Alpha;          // monthly adjusted runoff coeff.            //
 static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 
+// Index of the sources of runon received by each subcatchment
+typedef struct
+{
+    int       subcatch;   // subcatchment sending the runon
+    TLidUnit* lidUnit;    // its LID unit whose drain sends the runon
+                          // (NULL if runon is the subcatchment's runoff)
+}  TRunonSource;
+
+static  int*          RunonStart;     // start of each subcatchment's sources
+static  TRunonSource* RunonSource;    // runon sources listed by receiver
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
@@ -99,10 +110,14 @@ static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 //  subcatch_validate          (called from project_validate)
 //  subcatch_initState         (called from project_init)
 
+//  subcatch_openRunon         (called from runoff_open)
+//  subcatch_closeRunon        (called from runoff_close)
 //  subcatch_setOldState       (called from runoff_execute)
 //  subcatch_getRunon          (called from runoff_execute)
 //  subcatch_addRunon          (called from subcatch_getRunon,
 //                              lid_addDrainRunon, & runoff_getOutfallRunon)
+//  subcatch_getNetPrecip      (called from runoff_execute)
+//  subcatch_getNonLidRunoff   (called from runoff_execute)
 //  subcatch_getRunoff         (called from runoff_execute)
 //  subcatch_hadRunoff         (called from runoff_execute)
 
@@ -116,15 +131,15 @@ static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 //-----------------------------------------------------------------------------
 // Function declarations
 //-----------------------------------------------------------------------------
-static void   getNetPrecip(int j, double* netPrecip, double tStep);
 static double getSubareaRunoff(int subcatch, int subarea, double area,
               double rainfall, double evap, double tStep);
-static double getSubareaInfil(int j, TSubarea* subarea, double precip,
-              double tStep);
+static double getSubareaInfil(int j, TSubarea* subarea, double tStep);
 static double findSubareaRunoff(TSubarea* subarea, double tRunoff);
 static void   updatePondedDepth(TSubarea* subarea, double* tx);
 static void   getDdDt(double t, double* d, double* dddt);
 static void   adjustSubareaParams(int subareaType, int subcatch);              //(5.1.013)
+static void   addRunonSource(int k, int m);
+static void   getSubareaRunon(int j);
 
 //=============================================================================
 
@@ -534,36 +549,180 @@ double subcatch_getStorage(int j)
 
 //=============================================================================
 
+int subcatch_openRunon()
+//
+//  Input:   none
+//  Output:  returns an error code
+//  Purpose: builds an index of the subcatchments (and LID drains) that send
+//           runon to each subcatchment.
+//
+//  Sources are listed by increasing index of the sending subcatchment, with
+//  its own runoff ahead of any LID drain flows, which is the order in which
+//  the sending subcatchments would have added them to the receiver.
+//
+{
+    int j, k, m, u, nUnits;
+    int maxUnits = 0;
+    int n = Nobjects[SUBCATCH];
+    TLidUnit** units;
+
+    RunonStart = NULL;
+    RunonSource = NULL;
+    if ( n == 0 ) return 0;
+
+    // --- allocate room to list the LID units of any one subcatchment
+    for (j = 0; j < n; j++) maxUnits = MAX(maxUnits, lid_getUnitCount(j));
+    RunonStart = (int *) calloc(n+2, sizeof(int));
+    units = (TLidUnit **) calloc(maxUnits+1, sizeof(TLidUnit *));
+    if ( !RunonStart || !units )
+    {
+        FREE(units);
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
+    // --- count the runon sources of each subcatchment
+    //     (RunonStart[k+2] holds the count for subcatchment k)
+    for (j = 0; j < n; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        k = Subcatch[j].outSubcatch;
+        if ( k >= 0 && k != j ) RunonStart[k+2]++;
+        if ( Subcatch[j].lidArea == 0.0 ) continue;
+        nUnits = lid_getUnits(j, units);
+        for (u = 0; u < nUnits; u++)
+        {
+            k = lid_getDrainSubcatch(j, units[u]);
+            if ( k >= 0 ) RunonStart[k+2]++;
+        }
+    }
+    for (k = 2; k <= n+1; k++) RunonStart[k] += RunonStart[k-1];
+
+    // --- list the sources of each subcatchment
+    //     (RunonStart[k+1] serves as the next free slot for subcatchment k
+    //     and ends up as the start of subcatchment k+1's sources)
+    RunonSource = (TRunonSource *) calloc(RunonStart[n+1]+1,
+                                          sizeof(TRunonSource));
+    if ( !RunonSource )
+    {
+        FREE(units);
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+    for (j = 0; j < n; j++)
+    {
+        if ( Subcatch[j].area == 0.0 ) continue;
+        k = Subcatch[j].outSubcatch;
+        if ( k >= 0 && k != j )
+        {
+            m = RunonStart[k+1]++;
+            RunonSource[m].subcatch = j;
+            RunonSource[m].lidUnit = NULL;
+        }
+        if ( Subcatch[j].lidArea == 0.0 ) continue;
+        nUnits = lid_getUnits(j, units);
+        for (u = 0; u < nUnits; u++)
+        {
+            k = lid_getDrainSubcatch(j, units[u]);
+            if ( k < 0 ) continue;
+            m = RunonStart[k+1]++;
+            RunonSource[m].subcatch = j;
+            RunonSource[m].lidUnit = units[u];
+        }
+    }
+    FREE(units);
+    return ErrorCode;
+}
+
+//=============================================================================
+
+void subcatch_closeRunon()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the index of runon sources.
+//
+{
+    FREE(RunonStart);
+    FREE(RunonSource);
+}
+
+//=============================================================================
+
 void subcatch_getRunon(int j)
 //
 //  Input:   j = subcatchment index
 //  Output:  none
-//  Purpose: Routes runoff from a subcatchment to its outlet subcatchment
-//           or between its subareas.
+//  Purpose: Gathers runoff sent to a subcatchment by other subcatchments
+//           and routes runoff between its subareas.
+//
+//  Only subcatchment j is modified, so different subcatchments can be
+//  processed concurrently. Inflows are accumulated in the same order as
+//  when each subcatchment sent its runoff on to its outlet in turn.
 //
 {
-    int    k;                          // outlet subcatchment index
-    int    p;                          // pollutant index
-    double q;                          // runon to outlet subcatchment (ft/sec)
-    double q1, q2;                     // runoff from imperv. areas (ft/sec)
-    double pervArea;                   // subcatchment pervious area (ft2)
+    int    m;                          // runon source index
+    int    last;                       // end of the runon source list
+
+    // --- add previous period's runoff from upstream subcatchments with
+    //     lower index than this one
+    last = RunonStart[j+1];
+    for (m = RunonStart[j]; m < last && RunonSource[m].subcatch < j; m++)
+    {
+        addRunonSource(j, m);
+    }
+
+    // --- route runoff between the subcatchment's subareas
+    if ( Subcatch[j].area != 0.0 ) getSubareaRunon(j);
+
+    // --- add runoff from the remaining upstream subcatchments
+    for ( ; m < last; m++) addRunonSource(j, m);
+}
+
+//=============================================================================
 
-    // --- add previous period's runoff from this subcatchment to the
-    //     runon of the outflow subcatchment, if it exists
-    k = Subcatch[j].outSubcatch;
+void addRunonSource(int k, int m)
+//
+//  Input:   k = index of subcatchment receiving runon
+//           m = index of a runon source of the subcatchment
+//  Output:  none
+//  Purpose: adds previous period's runoff and pollutant load from a runon
+//           source to a subcatchment.
+//
+{
+    int    j = RunonSource[m].subcatch;
+    int    p;
+    double q;
+
+    // --- drain flow from an LID unit in the sending subcatchment
+    if ( RunonSource[m].lidUnit )
+    {
+        lid_addDrainRunon(j, RunonSource[m].lidUnit);
+        return;
+    }
+
+    // --- runoff from the sending subcatchment
     q = Subcatch[j].oldRunoff;
-    if ( k >= 0 && k != j )
+    subcatch_addRunonFlow(k, q);
+    for (p = 0; p < Nobjects[POLLUT]; p++)
     {
-        subcatch_addRunonFlow(k, q);
-        for (p = 0; p < Nobjects[POLLUT]; p++)
-        {
-            Subcatch[k].newQual[p] += q * Subcatch[j].oldQual[p] * LperFT3;
-        }
+        Subcatch[k].newQual[p] += q * Subcatch[j].oldQual[p] * LperFT3;
     }
+}
 
-    // --- add any LID underdrain flow sent from this subcatchment to
-    //     other subcatchments
-    if ( Subcatch[j].lidArea > 0.0 ) lid_addDrainRunon(j);
+//=============================================================================
+
+void getSubareaRunon(int j)
+//
+//  Input:   j = subcatchment index
+//  Output:  none
+//  Purpose: adds previous period's runoff between a subcatchment's subareas
+//           (and from its LID units) to the inflow of each subarea.
+//
+{
+    double q;                          // flow between subareas (ft/sec)
+    double q1, q2;                     // runoff from imperv. areas (ft/sec)
+    double pervArea;                   // subcatchment pervious area (ft2)
 
     // --- add to sub-area inflow any outflow from other subarea in previous period
     //     (NOTE: no transfer of runoff pollutant load, since runoff loads are
@@ -640,45 +799,36 @@ void  subcatch_addRunonFlow(int k, double q)
 
 //=============================================================================
 
-double subcatch_getRunoff(int j, double tStep)
+void subcatch_getNonLidRunoff(int j, double tStep)
 //
 //  Input:   j = subcatchment index
 //           tStep = time step (sec)
-//  Output:  returns total runoff produced by subcatchment (ft/sec)
-//  Purpose: Computes runoff & new storage depth for subcatchment.
-//
-//  The 'runoff' value returned by this function is the total runoff
-//  generated (in ft/sec) by the subcatchment before any internal
-//  re-routing is applied. It is used to compute pollutant washoff.
+//  Output:  none
+//  Purpose: Computes runoff & new storage depth for the non-LID portion
+//           of a subcatchment.
 //
-//  The 'outflow' value computed here (in cfs) is the surface runoff
-//  that actually leaves the subcatchment after any LID controls are
-//  applied and is saved to Subcatch[j].newRunoff. 
+//  The resulting water balance volumes are saved to Subcatch[j].surfBalance
+//  so that the LID units of all subcatchments can then be evaluated in a
+//  single batch (see lid_evalUnits) before subcatch_getRunoff completes the
+//  subcatchment's runoff computations.
 //
 {
     int    i;                          // subarea index
     double nonLidArea;                 // non-LID portion of subcatch area (ft2)
     double area;                       // sub-area or subcatchment area (ft2)
-    double netPrecip[3];               // subarea net precipitation (ft/sec)
-    double vRain;                      // rainfall (+ snowfall) volume (ft3)
     double vRunon    = 0.0;            // runon volume from other areas (ft3)
-    double vOutflow  = 0.0;            // runoff volume leaving subcatch (ft3)
     double runoff    = 0.0;            // total runoff flow on subcatch (cfs)
     double evapRate  = 0.0;            // potential evaporation rate (ft/sec)
     double subAreaRunoff;              // sub-area runoff rate (cfs)           //(5.1.013)
     double vImpervRunoff = 0.0;        // impervious area runoff volume (ft3)  //
     double vPervRunoff = 0.0;          // pervious area runoff volume (ft3)    //
+    TSurfBalance* balance = &Subcatch[j].surfBalance;
 
     // --- initialize shared water balance variables
     Vevap     = 0.0;
     Vpevap    = 0.0;
     Vinfil    = 0.0;
     Voutflow  = 0.0;
-    VlidIn    = 0.0;
-    VlidInfil = 0.0;
-    VlidOut   = 0.0;
-    VlidDrain = 0.0;
-    VlidReturn = 0.0;
 
     // --- find volume of inflow to non-LID portion of subcatchment as existing
     //     ponded water + any runon volume from upstream areas;
@@ -691,17 +841,10 @@ double subcatch_getRunoff(int j, double tStep)
     if ( nonLidArea == 0.0 )
         vRunon = Subcatch[j].runon * tStep * Subcatch[j].area;
 
-    // --- get net precip. (rainfall + snowfall + snowmelt) on the 3 types
-    //     of subcatchment sub-areas and update Vinflow with it
-    getNetPrecip(j, netPrecip, tStep);
-
     // --- find potential evaporation rate
     if ( Evap.dryOnly && Subcatch[j].rainfall > 0.0 ) evapRate = 0.0;
     else evapRate = Evap.rate;
 
-    // --- set monthly infiltration adjustment factor                          //(5.1.013)
-    infil_setInfilFactor(j);                                                   //(5.1.013)
-
     // --- examine each type of sub-area (impervious w/o depression storage,
     //     impervious w/ depression storage, and pervious)
     if ( nonLidArea > 0.0 ) for (i = IMPERV0; i <= PERV; i++)
@@ -710,13 +853,72 @@ double subcatch_getRunoff(int j, double tStep)
         //     Vinfil & Voutflow)
         area = nonLidArea * Subcatch[j].subArea[i].fArea;
         Subcatch[j].subArea[i].runoff =
-            getSubareaRunoff(j, i, area, netPrecip[i], evapRate, tStep);
+            getSubareaRunoff(j, i, area, Subcatch[j].netPrecip[i], evapRate,
+                             tStep);
         subAreaRunoff = Subcatch[j].subArea[i].runoff * area;                  //(5.1.013)
         if (i == PERV) vPervRunoff = subAreaRunoff * tStep;                    //
         else           vImpervRunoff += subAreaRunoff * tStep;                 //
         runoff += subAreaRunoff;                                               //
     }
 
+    // --- save the non-LID water balance
+    balance->inflow = Vinflow;
+    balance->evap = Vevap;
+    balance->pevap = Vpevap;
+    balance->infil = Vinfil;
+    balance->outflow = Voutflow;
+    balance->runon = vRunon;
+    balance->impervRunoff = vImpervRunoff;
+    balance->pervRunoff = vPervRunoff;
+    balance->runoff = runoff;
+}
+
+//=============================================================================
+
+double subcatch_getRunoff(int j, double tStep)
+//
+//  Input:   j = subcatchment index
+//           tStep = time step (sec)
+//  Output:  returns total runoff produced by subcatchment (ft/sec)
+//  Purpose: Computes runoff & new storage depth for subcatchment.
+//
+//  The 'runoff' value returned by this function is the total runoff
+//  generated (in ft/sec) by the subcatchment before any internal
+//  re-routing is applied. It is used to compute pollutant washoff.
+//
+//  The 'outflow' value computed here (in cfs) is the surface runoff
+//  that actually leaves the subcatchment after any LID controls are
+//  applied and is saved to Subcatch[j].newRunoff. 
+//
+//  Must be preceded by subcatch_getNonLidRunoff for this subcatchment and
+//  by lid_evalUnits.
+//
+{
+    double area;                       // subcatchment area (ft2)
+    double vRain;                      // rainfall (+ snowfall) volume (ft3)
+    double vRunon;                     // runon volume from other areas (ft3)
+    double vOutflow  = 0.0;            // runoff volume leaving subcatch (ft3)
+    double runoff;                     // total runoff flow on subcatch (cfs)
+    double vImpervRunoff;              // impervious area runoff volume (ft3)  //(5.1.013)
+    double vPervRunoff;                // pervious area runoff volume (ft3)    //
+    TSurfBalance* balance = &Subcatch[j].surfBalance;
+
+    // --- restore shared water balance variables of non-LID area
+    Vevap     = balance->evap;
+    Vpevap    = balance->pevap;
+    Vinfil    = balance->infil;
+    Vinflow   = balance->inflow;
+    Voutflow  = balance->outflow;
+    VlidIn    = 0.0;
+    VlidInfil = 0.0;
+    VlidOut   = 0.0;
+    VlidDrain = 0.0;
+    VlidReturn = 0.0;
+    vRunon = balance->runon;
+    vImpervRunoff = balance->impervRunoff;
+    vPervRunoff = balance->pervRunoff;
+    runoff = balance->runoff;
+
     // --- evaluate any LID treatment provided (updating Vevap,
     //     Vpevap, VlidInfil, VlidIn, VlidOut, & VlidDrain)
     if ( Subcatch[j].lidArea > 0.0 )
@@ -724,10 +926,11 @@ double subcatch_getRunoff(int j, double tStep)
         lid_getRunoff(j, tStep);
     }
 
-    // --- update groundwater levels & flows if applicable
+    // --- save inflow to groundwater if applicable (GW levels & flows
+    //     are updated for all subcatchments together by runoff_execute)
     if ( !IgnoreGwater && Subcatch[j].groundwater )
     {
-        gwater_getGroundwater(j, Vpevap, Vinfil+VlidInfil, tStep);
+        gwater_setInflow(j, Vpevap, Vinfil+VlidInfil, tStep);
     }
 
     // --- save subcatchment's total loss rates (ft/s)
@@ -769,24 +972,25 @@ double subcatch_getRunoff(int j, double tStep)
 
 //=============================================================================
 
-void getNetPrecip(int j, double* netPrecip, double tStep)
+void subcatch_getNetPrecip(int j, double rainfall, double snowfall,
+                           double rmelt, double tStep)
 {
 //
 //  Purpose: Finds combined rainfall + snowmelt on a subcatchment.
 //  Input:   j = subcatchment index
+//           rainfall = rainfall on subcatchment's rain gage (ft/sec)
+//           snowfall = snowfall on subcatchment's rain gage (ft/sec)
+//           rmelt = snow melt rate when rain falling (ft/sec)
 //           tStep = time step (sec)
-//  Output:  netPrecip = rainfall + snowmelt over each type of subarea (ft/s)
+//  Output:  none
 //
-    int    i, k;
-    double rainfall = 0.0;             // rainfall (ft/sec)
-    double snowfall = 0.0;             // snowfall (ft/sec)
-
-    // --- get current rainfall or snowfall from rain gage (in ft/sec)
-    k = Subcatch[j].gage;
-    if ( k >= 0 )
-    {
-        gage_getPrecip(k, &rainfall, &snowfall);
-    }
+//  Net precip. is found for all subcatchments before any runoff is computed
+//  so that infiltration into their pervious sub-areas can be evaluated in a
+//  single batch, while the gage quantities are evaluated just once for all
+//  subcatchments that share a rain gage (see runoff_execute).
+//
+    int    i;
+    double* netPrecip = Subcatch[j].netPrecip;
 
     // --- assign total precip. rate to subcatch's rainfall property
     Subcatch[j].rainfall = rainfall + snowfall;
@@ -796,8 +1000,8 @@ void getNetPrecip(int j, double* netPrecip, double tStep)
     // --- if subcatch has a snowpack, then base netPrecip on possible snow melt
     if ( Subcatch[j].snowpack && !IgnoreSnowmelt )
     {
-        Subcatch[j].newSnowDepth = 
-            snow_getSnowMelt(j, rainfall, snowfall, tStep, netPrecip);
+        Subcatch[j].newSnowDepth = snow_getSnowMelt(j, rainfall, snowfall,
+                                                    rmelt, tStep, netPrecip);
     }
 
     // --- otherwise netPrecip is just sum of rainfall & snowfall
@@ -953,7 +1157,7 @@ double getSubareaRunoff(int j, int i, double area, double precip, double evap,
     surfEvap = MIN(surfMoisture, evap);
 
     // --- compute infiltration loss rate
-    if ( i == PERV ) infil = getSubareaInfil(j, subarea, precip, tStep);
+    if ( i == PERV ) infil = getSubareaInfil(j, subarea, tStep);
 
     // --- add precip to other subarea inflows
     subarea->inflow += precip;
@@ -996,21 +1200,20 @@ double getSubareaRunoff(int j, int i, double area, double precip, double evap,
 
 //=============================================================================
 
-double getSubareaInfil(int j, TSubarea* subarea, double precip, double tStep)
+double getSubareaInfil(int j, TSubarea* subarea, double tStep)
 //
 //  Purpose: computes infiltration rate at current time step.
 //  Input:   j = subcatchment index
 //           subarea = ptr. to a subarea
-//           precip = rainfall + snowmelt over subarea (ft/sec)
 //           tStep = time step (sec)
 //  Output:  returns infiltration rate (ft/s)
 //
 {
     double infil = 0.0;                     // actual infiltration rate (ft/sec)
 
-    // --- compute infiltration rate 
-    infil = infil_getInfil(j, tStep, precip,                                   //(5.1.015)
-                           subarea->inflow, subarea->depth);
+    // --- retrieve infiltration rate computed for all subcatchments
+    //     at once by infil_getInfilBatch
+    infil = subarea->infil;
 
     // --- limit infiltration rate by available void space in unsaturated
     //     zone of any groundwater aquifer
@@ -91,12 +91,13 @@ void surfqual_getBuildup(int j, double tStep)
 //
 {
     int     i;                         // land use index
-    int     p;                         // pollutant index
+    int     hasSnow;                   // TRUE if subcatch has snow cover
     double  f;                         // land use fraction
     double  area;                      // land use area (acres or hectares)
     double  curb;                      // land use curb length (user units)
-    double  oldBuildup;                // buildup at start of time step
-    double  newBuildup;                // buildup at end of time step
+
+    // --- see if snow-only buildup can occur
+    hasSnow = ( Subcatch[j].newSnowDepth >= 0.001/12.0 );
 
     // --- consider each landuse
     for (i = 0; i < Nobjects[LANDUSE]; i++)
@@ -109,22 +110,9 @@ void surfqual_getBuildup(int j, double tStep)
         area = f * Subcatch[j].area * UCF(LANDAREA);
         curb = f * Subcatch[j].curbLength;
 
-        // --- examine each pollutant
-        for (p = 0; p < Nobjects[POLLUT]; p++)
-        {
-            // --- see if snow-only buildup is in effect
-            if (Pollut[p].snowOnly 
-            && Subcatch[j].newSnowDepth < 0.001/12.0) continue;
-
-            // --- use land use's buildup function to update buildup amount
-            oldBuildup = Subcatch[j].landFactor[i].buildup[p];        
-            newBuildup = landuse_getBuildup(i, p, area, curb, oldBuildup,
-                         tStep);
-            newBuildup = MAX(newBuildup, oldBuildup);
-            Subcatch[j].landFactor[i].buildup[p] = newBuildup;
-            massbal_updateLoadingTotals(BUILDUP_LOAD, p, 
-                                       (newBuildup - oldBuildup));
-       }
+        // --- use land use's buildup functions to update buildup amounts
+        landuse_addBuildup(i, area, curb, hasSnow,
+                           Subcatch[j].landFactor[i].buildup, tStep);
     }
 }
 
@@ -406,12 +394,9 @@ void  findWashoffLoads(int j, double runoff)
     {
         if ( Subcatch[j].landFactor[i].fraction > 0.0 )
         {
-            // --- compute load generated by washoff function
-            for (p = 0; p < Nobjects[POLLUT]; p++)
-            {
-                OutflowLoad[p] += landuse_getWashoffLoad(
-                    i, p, area, Subcatch[j].landFactor, runoff, Voutflow);
-            }
+            // --- compute load generated by washoff functions
+            landuse_getWashoffLoads(i, area, Subcatch[j].landFactor,
+                                    runoff, Voutflow, OutflowLoad);
         }
     }
 
@@ -302,6 +302,9 @@ char* EMSCRIPTEN_KEEPALIVE DLLEXPORT swmm_transcribe(char* f1, char* f2, char* f
         sprintf(&JX[strlen(JX)], "\"ALLOW_PONDING\":\"%s\",\n", NoYesWords[AllowPonding]);
         sprintf(&JX[strlen(JX)], "\"SLOPE_WEIGHTING\":\"%s\",\n", NoYesWords[SlopeWeighting]);
         sprintf(&JX[strlen(JX)], "\"SKIP_STEADY_STATE\":\"%s\",\n", NoYesWords[SkipSteadyState]);
+        sprintf(&JX[strlen(JX)], "\"ACTIVE_SET\":\"%s\",\n", NoYesWords[ActiveSet]);
+        sprintf(&JX[strlen(JX)], "\"SKIP_STEADY_REGIONS\":\"%s\",\n", NoYesWords[SkipSteadyRegions]);
+        sprintf(&JX[strlen(JX)], "\"SKIP_DRY_PERIODS\":\"%s\",\n", NoYesWords[SkipDryPeriods]);
         sprintf(&JX[strlen(JX)], "\"IGNORE_RAINFALL\":\"%s\",\n", NoYesWords[IgnoreRainfall]);
         sprintf(&JX[strlen(JX)], "\"IGNORE_SNOWMELT\":\"%s\",\n", NoYesWords[IgnoreSnowmelt]);
         sprintf(&JX[strlen(JX)], "\"IGNORE_GROUNDWATER\":\"%s\",\n", NoYesWords[IgnoreGwater]);
@@ -1778,6 +1781,9 @@ int DLLEXPORT swmm_open(char* f1, char* f2, char* f3)
         report_writeTitle();
         project_validate();
 
+        // --- save a snapshot of the validated input data if requested
+        input_saveSnapshot();
+
         // --- write input summary to report file if requested
         if ( RptFlags.input ) inputrpt_writeInput();
     }
@@ -2102,6 +2108,8 @@ int DLLEXPORT swmm_close()
 {
     if ( Fout.file ) output_close();
     if ( IsOpenFlag ) project_close();
+    toposort_close();
+    climate_close();
     report_writeSysTime();
     if ( Finp.file != NULL ) fclose(Finp.file);
     if ( Frpt.file != NULL ) fclose(Frpt.file);
@@ -2192,6 +2200,52 @@ int  DLLEXPORT swmm_getError(char* errMsg, int msgLen)
     return error_getCode(ErrorCode);
 }
 
+//=============================================================================
+
+EMSCRIPTEN_KEEPALIVE
+int  DLLEXPORT swmm_setSnapshotFile(char* f)
+//
+//  Input:   f = name of a snapshot file (NULL or empty to not use one)
+//  Output:  returns error code
+//  Purpose: names a binary snapshot file of a project's compiled input data
+//           that swmm_open uses in place of parsing the input file when the
+//           snapshot was made from the same input, and saves otherwise.
+{
+    if ( f == NULL || strlen(f) == 0 )
+    {
+        Fsnapshot.mode = NO_FILE;
+        strcpy(Fsnapshot.name, "");
+    }
+    else
+    {
+        Fsnapshot.mode = USE_FILE;
+        sstrncpy(Fsnapshot.name, f, MAXFNAME);
+    }
+    Fsnapshot.file = NULL;
+    return 0;
+}
+
+//=============================================================================
+
+EMSCRIPTEN_KEEPALIVE
+int  DLLEXPORT swmm_writeTimeseriesFile(char* f1, char* f2)
+//
+//  Input:   f1 = name of a time series data file
+//           f2 = name of binary time series file to create
+//  Output:  returns error code
+//  Purpose: converts a time series data file into a binary file that can
+//           be named in place of it in an input file's [TIMESERIES] section.
+//
+{
+    int errcode;
+    if ( f1 == NULL || f2 == NULL ) return error_getCode(ERR_FILE_NAME);
+
+    // --- dates are read in the same format used by swmm_open
+    datetime_setDateFormat(M_D_Y);
+    errcode = table_writeStore(f1, f2);
+    return error_getCode(errcode);
+}
+
 //=============================================================================
 //   General purpose functions
 //=============================================================================
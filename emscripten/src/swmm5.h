@@ -52,6 +52,16 @@ int  DLLEXPORT   swmm_getVersion(void);
 int  DLLEXPORT   swmm_getError(char* errMsg, int msgLen);
 int  DLLEXPORT   swmm_getWarnings(void);
 
+// --- a snapshot holds the tokenized lines of a project's input file and
+//     its time series and curve data. swmm_open still reads the input file
+//     to check that the snapshot matches it, and still creates every object
+//     and builds its ID tables from the snapshot's lines. A snapshot does
+//     not capture object arrays, ID tables or simulation results, so it
+//     cannot restore a project's full model state.
+int  DLLEXPORT   swmm_setSnapshotFile(char* f);
+
+int  DLLEXPORT   swmm_writeTimeseriesFile(char* f1, char* f2);
+
 #ifdef __cplusplus
 }   // matches the linkage specification from above */
 #endif
@@ -16,6 +16,17 @@
 //   The table_getFirstEntry and table_getNextEntry functions, as well as the
 //   Time Series functions that use them, are not thread safe.
 //
+//   A time series FILE can also be a binary store written by
+//   table_writeStore. It holds the series' dates (as doubles) and values
+//   (as floats) in fixed size chunks followed by an index of each chunk's
+//   first date, and is read through a one chunk window so that series of
+//   any length use a constant amount of memory. Its layout is:
+//     header: stamp[16], version, chunkSize, chunkCount (ints),
+//             entryCount, dxMin, indexOffset (doubles)
+//     chunks: chunkSize dates followed by chunkSize values
+//             (the last chunk holds only the remaining entries)
+//     index:  chunkCount dates
+//
 //   Build 5.1.008:
 //   - The lookup functions used for Curve tables (table_lookup, table_lookupEx,
 //     table_intervalLookup, table_inverseLookup, table_getSlope, table_getMaxY,
@@ -30,11 +41,27 @@
 #include <string.h>
 #include "headers.h"
 
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const int TABLE_BLOCK_MIN = 8;     // Entries in a table's first block
+static const int TABLE_BLOCK_MAX = 1024;  // Max. entries in a table block
+static const int STORE_CHUNK = 4096;      // Entries per binary store chunk
+static const int STORE_VERSION = 1;       // Version of binary store format
+static const char STORE_STAMP[16] = "SWMM5-TSERIES"; // Binary store stamp
+static const long STORE_HEADER = 16 + 3*sizeof(int) + 3*sizeof(double);
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 int    table_getNextFileEntry(TTable* table, double* x, double* y);
 int    table_parseFileLine(char* line, TTable* table, double* x, double* y);
+static int  table_openStore(TTable* table);
+static int  table_loadChunk(TTable* table, int k);
+static void table_seekStore(TTable* table, double x);
+static void table_freeStore(TTable* table);
+static void table_writeStoreHeader(FILE* f, int chunkCount, double count,
+            double dxMin, double indexOffset);
 double table_interpolate(double x, double x1, double y1, double x2, double y2);
 
 
@@ -204,8 +231,22 @@ int table_addEntry(TTable* table, double x, double y)
 //
 {
     TTableEntry *entry;
-    entry = (TTableEntry *) malloc(sizeof(TTableEntry));
-    if ( !entry ) return FALSE;
+    int n;
+
+    // --- entries are taken from blocks allocated from the project's
+    //     memory pool, each block doubling in size up to TABLE_BLOCK_MAX
+    //     entries (a table's entries are only ever added by one thread)
+    if ( table->freeCount == 0 )
+    {
+        n = MAX(TABLE_BLOCK_MIN, table->entryCount);
+        n = MIN(n, TABLE_BLOCK_MAX);
+        table->freeEntry = (TTableEntry *) project_alloc(n, sizeof(TTableEntry));
+        if ( !table->freeEntry ) return FALSE;
+        table->freeCount = n;
+    }
+    entry = table->freeEntry++;
+    table->freeCount--;
+    table->entryCount++;
     entry->x = x;
     entry->y = y;
     entry->next = NULL;
@@ -223,20 +264,18 @@ void   table_deleteEntries(TTable *table)
 //  Output:  none
 //  Purpose: deletes all x/y entries in a table.
 //
+//  NOTE: entries are allocated from the project's memory pool and are
+//        released all at once when the project is closed.
+//
 {
-    TTableEntry *entry;
-    TTableEntry *nextEntry;
-    entry = table->firstEntry;
-    while (entry)
-    {
-        nextEntry = entry->next;
-        free(entry);
-        entry = nextEntry;
-    }
+    table->freeEntry  = NULL;
+    table->freeCount  = 0;
+    table->entryCount = 0;
     table->firstEntry = NULL;
     table->lastEntry  = NULL;
     table->thisEntry  = NULL;
 
+    table_freeStore(table);
     if (table->file.file)
     { 
         fclose(table->file.file);
@@ -258,6 +297,9 @@ void   table_init(TTable *table)
     table->firstEntry = NULL;
     table->lastEntry = NULL;
     table->thisEntry = table->firstEntry;
+    table->freeEntry = NULL;
+    table->freeCount = 0;
+    table->entryCount = 0;
     table->lastDate = 0.0;
     table->x1 = 0.0;
     table->x2 = 0.0;
@@ -266,6 +308,7 @@ void   table_init(TTable *table)
     table->dxMin = 0.0;
     table->file.mode = NO_FILE;
     table->file.file = NULL;
+    table->store = NULL;
     table->curveType = -1;
 }
 
@@ -285,6 +328,10 @@ int   table_validate(TTable *table)
     // --- open external file if used as the table's data source
     if ( table->file.mode == USE_FILE )
     {
+        // --- a binary store was checked when written so only its
+        //     header and index need to be read
+        result = table_openStore(table);
+        if ( result >= 0 ) return result;
         table->file.file = fopen(table->file.name, "rt");
         if ( table->file.file == NULL ) return ERR_TABLE_FILE_OPEN;
     }
@@ -335,6 +382,13 @@ int table_getFirstEntry(TTable *table, double *x, double *y)
     if ( table->file.mode == USE_FILE )
     {
         if ( table->file.file == NULL ) return FALSE;
+        if ( table->store )
+        {
+            if ( !table_loadChunk(table, 0) ) return FALSE;
+            *x = table->store->x[0];
+            *y = table->store->y[0];
+            return TRUE;
+        }
         rewind(table->file.file);
         return table_getNextFileEntry(table, x, y);
     }
@@ -364,7 +418,16 @@ int table_getNextEntry(TTable *table, double *x, double *y)
 //
 {
     TTableEntry *entry;
+    TTableStore *store = table->store;
 
+    if ( store )
+    {
+        if ( store->pos + 1 < store->size ) store->pos++;
+        else if ( !table_loadChunk(table, store->chunk + 1) ) return FALSE;
+        *x = store->x[store->pos];
+        *y = store->y[store->pos];
+        return TRUE;
+    }
     if ( table->file.mode == USE_FILE )
         return table_getNextFileEntry(table, x, y);
     
@@ -767,6 +830,9 @@ double table_tseriesLookup(TTable *table, double x, char extend)
     table->x1 = table->x2;
     table->y1 = table->y2;
 
+    // --- skip over chunks of a binary store that lie before x
+    if ( table->store ) table_seekStore(table, x);
+
     // --- get end of next time bracket
     while ( table_getNextEntry(table, &(table->x2), &(table->y2)) )
     {
@@ -874,3 +940,308 @@ int  table_parseFileLine(char* line, TTable* table, double* x, double* y)
     *y = yy;
     return TRUE;
 }
+
+//=============================================================================
+
+int  table_openStore(TTable* table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  returns an error code or -1 if file is not a binary store
+//  Purpose: opens a table's external file if it is a binary time series
+//           store and reads its header and chunk index.
+//
+{
+    char   stamp[16];
+    int    header[3];
+    double values[3];
+    int    k;
+    FILE*  f;
+    TTableStore* store;
+
+    // --- check that file begins with the binary store stamp
+    f = fopen(table->file.name, "rb");
+    if ( f == NULL ) return ERR_TABLE_FILE_OPEN;
+    if ( fread(stamp, 1, 16, f) < 16 || memcmp(stamp, STORE_STAMP, 16) != 0 )
+    {
+        fclose(f);
+        return -1;
+    }
+    table->file.file = f;
+
+    // --- read rest of header
+    if ( fread(header, sizeof(int), 3, f) < 3 ||
+         fread(values, sizeof(double), 3, f) < 3 ||
+         header[0] != STORE_VERSION || header[1] <= 0 || header[2] <= 0 ||
+         values[0] <= (double)header[1] * (header[2] - 1) ||
+         values[0] > (double)header[1] * header[2] )
+        return ERR_TABLE_FILE_READ;
+
+    // --- create a reader whose window holds one chunk
+    store = (TTableStore *) calloc(1, sizeof(TTableStore));
+    if ( store == NULL ) return ERR_MEMORY;
+    table->store = store;
+    store->chunkSize = header[1];
+    store->chunkCount = header[2];
+    store->entryCount = values[0];
+    store->chunk = -1;
+    store->chunkStart = (double *) calloc(store->chunkCount, sizeof(double));
+    store->x = (double *) calloc(store->chunkSize, sizeof(double));
+    store->y = (float *) calloc(store->chunkSize, sizeof(float));
+    if ( !store->chunkStart || !store->x || !store->y ) return ERR_MEMORY;
+
+    // --- read the chunk index and check that it is in ascending order
+    if ( fseek(f, (long)values[2], SEEK_SET) != 0 ||
+         fread(store->chunkStart, sizeof(double), store->chunkCount, f) <
+         (size_t)store->chunkCount ) return ERR_TABLE_FILE_READ;
+    for (k = 1; k < store->chunkCount; k++)
+    {
+        if ( store->chunkStart[k] <= store->chunkStart[k-1] )
+            return ERR_TABLE_FILE_READ;
+    }
+    table->dxMin = values[1];
+    if ( !table_loadChunk(table, 0) ) return ERR_TABLE_FILE_READ;
+    return 0;
+}
+
+//=============================================================================
+
+int  table_loadChunk(TTable* table, int k)
+//
+//  Input:   table = pointer to a TTable structure
+//           k = index of a chunk of a binary store
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: reads a chunk of a table's binary store into its window and
+//           makes the chunk's first entry the current one.
+//
+{
+    TTableStore* store = table->store;
+    FILE* f = table->file.file;
+    long  offset;
+    int   n;
+
+    if ( k < 0 || k >= store->chunkCount ) return FALSE;
+    if ( k != store->chunk )
+    {
+        n = store->chunkSize;
+        if ( k == store->chunkCount - 1 )
+            n = (int)(store->entryCount - (double)store->chunkSize * k);
+        offset = STORE_HEADER +
+                 (long)k * store->chunkSize * (sizeof(double) + sizeof(float));
+        store->chunk = -1;
+        if ( fseek(f, offset, SEEK_SET) != 0 ||
+             fread(store->x, sizeof(double), n, f) < (size_t)n ||
+             fread(store->y, sizeof(float), n, f) < (size_t)n ) return FALSE;
+        store->chunk = k;
+        store->size = n;
+    }
+    store->pos = 0;
+    return TRUE;
+}
+
+//=============================================================================
+
+void  table_seekStore(TTable* table, double x)
+//
+//  Input:   table = pointer to a TTable structure
+//           x = a date/time value
+//  Output:  none
+//  Purpose: moves the start of a binary store's time bracket ahead to the
+//           latest chunk whose first date is still before x.
+//
+//  NOTE: the bracket found from that point on is the same one that reading
+//        every entry in between would find.
+//
+{
+    TTableStore* store = table->store;
+    int lo, hi, mid;
+
+    // --- binary search the index for the last chunk starting before x
+    lo = store->chunk;
+    hi = store->chunkCount - 1;
+    if ( lo < 0 || lo >= hi || store->chunkStart[lo+1] >= x ) return;
+    while ( lo < hi )
+    {
+        mid = (lo + hi + 1) / 2;
+        if ( store->chunkStart[mid] < x ) lo = mid;
+        else hi = mid - 1;
+    }
+
+    // --- make the chunk's first entry the start of the bracket
+    if ( !table_loadChunk(table, lo) ) return;
+    table->x1 = store->x[0];
+    table->y1 = store->y[0];
+}
+
+//=============================================================================
+
+void  table_freeStore(TTable* table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  none
+//  Purpose: frees the reader of a table's binary store.
+//
+{
+    if ( table->store == NULL ) return;
+    FREE(table->store->chunkStart);
+    FREE(table->store->x);
+    FREE(table->store->y);
+    FREE(table->store);
+}
+
+//=============================================================================
+
+int  table_writeStore(char* textFile, char* storeFile)
+//
+//  Input:   textFile = name of a time series data file
+//           storeFile = name of binary store file to create
+//  Output:  returns an error code
+//  Purpose: converts a time series data file into a binary store.
+//
+//  NOTE: the data file is read one line at a time with the same rules used
+//        for time series files named in an input file and only one chunk
+//        of entries is held in memory.
+//
+{
+    TTable  table;                     // table used to parse data lines
+    FILE*   fin;                       // data file
+    FILE*   fout;                      // binary store file
+    char    line[MAXLINE+1];           // line from data file
+    double* x;                         // dates of current chunk
+    float*  y;                         // values of current chunk
+    double* start = NULL;              // date of first entry in each chunk
+    double* p;
+    double  xx, yy;                    // date & value read from data file
+    double  lastX = 0.0;               // date of previous entry
+    double  count = 0.0;               // number of entries read
+    double  dxMin = BIG;               // smallest date interval
+    long    indexOffset;               // position of chunk index in file
+    int     n = 0;                     // number of entries in current chunk
+    int     chunkCount = 0;            // number of chunks written
+    int     maxChunks = 0;             // size of start array
+    int     code;
+    int     errcode = 0;
+
+    // --- open files
+    table_init(&table);
+    fin = fopen(textFile, "rt");
+    if ( fin == NULL ) return ERR_TABLE_FILE_OPEN;
+    fout = fopen(storeFile, "wb");
+    if ( fout == NULL )
+    {
+        fclose(fin);
+        return ERR_TABLE_FILE_OPEN;
+    }
+    x = (double *) calloc(STORE_CHUNK, sizeof(double));
+    y = (float *) calloc(STORE_CHUNK, sizeof(float));
+    if ( !x || !y ) errcode = ERR_MEMORY;
+
+    // --- reserve space for the header
+    table_writeStoreHeader(fout, 0, 0.0, 0.0, 0.0);
+
+    // --- read each entry from the data file
+    while ( !errcode && !feof(fin) && fgets(line, MAXLINE, fin) != NULL )
+    {
+        code = table_parseFileLine(line, &table, &xx, &yy);
+        if ( code < 0 ) continue;
+        if ( code == FALSE )
+        {
+            errcode = ERR_TABLE_FILE_READ;
+            break;
+        }
+
+        // --- check that dates are in ascending order
+        if ( count > 0.0 )
+        {
+            if ( xx <= lastX )
+            {
+                errcode = ERR_CURVE_SEQUENCE;
+                break;
+            }
+            dxMin = MIN(dxMin, xx - lastX);
+        }
+        lastX = xx;
+        count += 1.0;
+
+        // --- add entry to current chunk
+        if ( n == 0 )
+        {
+            if ( chunkCount == maxChunks )
+            {
+                maxChunks = MAX(16, 2 * maxChunks);
+                p = (double *) realloc(start, maxChunks * sizeof(double));
+                if ( p == NULL )
+                {
+                    errcode = ERR_MEMORY;
+                    break;
+                }
+                start = p;
+            }
+            start[chunkCount++] = xx;
+        }
+        x[n] = xx;
+        y[n] = (float)yy;
+        n++;
+
+        // --- write chunk once it's full
+        if ( n == STORE_CHUNK )
+        {
+            fwrite(x, sizeof(double), n, fout);
+            fwrite(y, sizeof(float), n, fout);
+            n = 0;
+        }
+    }
+    if ( !errcode && count == 0.0 ) errcode = ERR_TABLE_FILE_READ;
+
+    // --- write last partial chunk, chunk index & final header
+    if ( !errcode )
+    {
+        if ( n > 0 )
+        {
+            fwrite(x, sizeof(double), n, fout);
+            fwrite(y, sizeof(float), n, fout);
+        }
+        indexOffset = ftell(fout);
+        fwrite(start, sizeof(double), chunkCount, fout);
+        rewind(fout);
+        table_writeStoreHeader(fout, chunkCount, count, dxMin,
+                               (double)indexOffset);
+        if ( ferror(fout) ) errcode = ERR_TABLE_FILE_OPEN;
+    }
+
+    // --- close files (removing an incomplete store)
+    FREE(x);
+    FREE(y);
+    FREE(start);
+    fclose(fin);
+    fclose(fout);
+    if ( errcode ) remove(storeFile);
+    return errcode;
+}
+
+//=============================================================================
+
+void  table_writeStoreHeader(FILE* f, int chunkCount, double count,
+                             double dxMin, double indexOffset)
+//
+//  Input:   f = binary store file
+//           chunkCount = number of chunks in file
+//           count = number of entries in file
+//           dxMin = smallest interval between dates
+//           indexOffset = position of chunk index in file
+//  Output:  none
+//  Purpose: writes the header of a binary time series store.
+//
+{
+    int    header[3];
+    double values[3];
+
+    header[0] = STORE_VERSION;
+    header[1] = STORE_CHUNK;
+    header[2] = chunkCount;
+    values[0] = count;
+    values[1] = dxMin;
+    values[2] = indexOffset;
+    fwrite(STORE_STAMP, 1, 16, f);
+    fwrite(header, sizeof(int), 3, f);
+    fwrite(values, sizeof(double), 3, f);
+}
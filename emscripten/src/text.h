@@ -113,6 +113,9 @@
 #define  w_MIN_ROUTE_STEP    "MINIMUM_STEP"
 #define  w_NUM_THREADS       "THREADS"
 #define  w_SURCHARGE_METHOD  "SURCHARGE_METHOD"                                //(5.1.013)
+#define  w_ACTIVE_SET        "ACTIVE_SET"
+#define  w_SKIP_STEADY_REGIONS "SKIP_STEADY_REGIONS"
+#define  w_SKIP_DRY_PERIODS  "SKIP_DRY_PERIODS"
 
 // Flow Units
 #define  w_CFS               "CFS"
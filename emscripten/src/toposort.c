@@ -11,6 +11,7 @@
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
+#include <string.h>
 #include "headers.h"
 
 //-----------------------------------------------------------------------------
@@ -36,10 +37,24 @@ static char* InTree;                   // state of each link in spanning tree:
 static int*  LoopLinks;                // list of links which forms a loop
 static int   LoopLinksLast;            // number of links in a loop
 
+// --- results of the last successful sort, kept until the project is closed
+//     so that repeated runs of the same network layout do not have to
+//     re-sort and re-partition it
+static int   CacheNodes = -1;          // number of nodes in cached layout
+static int   CacheLinks;               // number of links in cached layout
+static int   CacheModel;               // routing model of cached layout
+static int   CacheTrees;               // number of subtrees in cached layout
+static int*  CacheLayout;              // end nodes of each link followed by
+                                       // diversion link of each node
+static int*  CacheSorted;              // cached sorted link indexes
+static int*  CacheTreeStart;           // cached start of each subtree
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
-//  toposort_sortLinks (called by routing_open)
+//  toposort_sortLinks    (called by routing_open)
+//  toposort_findTreeRoot (called by createRegions in routing.c)
+//  toposort_close        (called by swmm_close)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -52,26 +67,36 @@ static void findSpanningTree(int startNode);
 static void evalLoop(int startLink);
 static int  traceLoop(int i1, int i2, int k);
 static void checkDummyLinks(void);
+static int  findSubtrees(int sortedLinks[], int treeStart[]);
+static int  getDiversionLink(int i);
+static int  isCachedLayout(void);
+static void saveCachedLayout(int sortedLinks[], int treeStart[], int nTrees);
 //=============================================================================
 
-void toposort_sortLinks(int sortedLinks[])
+int toposort_sortLinks(int sortedLinks[], int treeStart[])
 //
 //  Input:   none
 //  Output:  sortedLinks = array of link indexes in sorted order
-//  Purpose: sorts links from upstream to downstream.
+//           treeStart = position in sortedLinks where each independent
+//                       subtree of links begins
+//           returns number of independent subtrees
+//  Purpose: sorts links from upstream to downstream, grouping together
+//           the links of subtrees that share no nodes with one another.
 //
 {
     int i, n = 0;
+    int nTrees;
 
     // --- no need to sort links for Dyn. Wave routing
     for ( i=0; i<Nobjects[LINK]; i++) sortedLinks[i] = i;
+    treeStart[0] = 0;
     if ( RouteModel == DW )
     {
 
         // --- check for nodes with both incoming and outgoing
         //     dummy links (creates ambiguous ordering)
         checkDummyLinks();
-        if ( ErrorCode ) return;
+        if ( ErrorCode ) return 0;
 
         // --- find number of outflow links for each node
         for ( i=0; i<Nobjects[NODE]; i++ ) Node[i].degree = 0;
@@ -90,11 +115,22 @@ void toposort_sortLinks(int sortedLinks[])
             }
             else Node[n].degree++;
         }
-        return;
+        return 0;
+    }
+
+    // --- re-use the sort of a previous run of the same network layout
+    //     (number of outflow links for each node must still be found)
+    if ( ErrorCode ) return 0;
+    if ( isCachedLayout() )
+    {
+        memcpy(sortedLinks, CacheSorted, CacheLinks * sizeof(int));
+        memcpy(treeStart, CacheTreeStart, (CacheTrees + 1) * sizeof(int));
+        for ( i=0; i<Nobjects[NODE]; i++ ) Node[i].degree = 0;
+        for ( i=0; i<Nobjects[LINK]; i++ ) Node[Link[i].node1].degree++;
+        return CacheTrees;
     }
 
     // --- allocate arrays used for topo sorting
-    if ( ErrorCode ) return;
     InDegree = (int *) calloc(Nobjects[NODE], sizeof(int));
     StartPos = (int *) calloc(Nobjects[NODE], sizeof(int));
     AdjList  = (int *) calloc(Nobjects[LINK], sizeof(int));
@@ -132,6 +168,12 @@ void toposort_sortLinks(int sortedLinks[])
         report_writeErrorMsg(ERR_LOOP, "");
         findCycles();
     }
+    if ( ErrorCode ) return 0;
+
+    // --- group the sorted links by independent subtree
+    nTrees = findSubtrees(sortedLinks, treeStart);
+    if ( !ErrorCode ) saveCachedLayout(sortedLinks, treeStart, nTrees);
+    return nTrees;
 }
 
 //=============================================================================
@@ -529,3 +571,211 @@ void checkDummyLinks()
 }
 
 //=============================================================================
+
+int findSubtrees(int sortedLinks[], int treeStart[])
+//
+//  Input:   sortedLinks = array of link indexes in sorted order
+//  Output:  sortedLinks = sorted link indexes grouped by subtree
+//           treeStart = position in sortedLinks where each subtree begins
+//           returns number of independent subtrees
+//  Purpose: partitions the sorted links into subtrees that share no nodes.
+//
+//  Note:    the links of each subtree keep their relative sorted order, so
+//           the grouped array remains a valid upstream to downstream
+//           ordering of the full network.
+//
+{
+    int  i, j, k, r1, r2;
+    int  nTrees = 0;
+    int* parent;                       // union-find parent of each node
+    int* nodeTree;                     // subtree index of each root node
+    int* linkTree;                     // subtree index of each sorted link
+    int* pos;                          // next free position in each subtree
+    int* grouped;                      // sorted links grouped by subtree
+
+    parent   = (int *) calloc(Nobjects[NODE]+1, sizeof(int));
+    nodeTree = (int *) calloc(Nobjects[NODE]+1, sizeof(int));
+    linkTree = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    pos      = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    grouped  = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    if ( parent == NULL || nodeTree == NULL || linkTree == NULL ||
+         pos == NULL || grouped == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+    }
+    else
+    {
+        // --- join the end nodes of each link into the same tree
+        for ( i = 0; i < Nobjects[NODE]; i++ )
+        {
+            parent[i] = i;
+            nodeTree[i] = -1;
+        }
+        for ( j = 0; j < Nobjects[LINK]; j++ )
+        {
+            r1 = toposort_findTreeRoot(parent, Link[j].node1);
+            r2 = toposort_findTreeRoot(parent, Link[j].node2);
+            if ( r1 != r2 ) parent[r2] = r1;
+        }
+
+        // --- number the subtrees in order of their first sorted link
+        //     and count the links in each one
+        for ( k = 0; k < Nobjects[LINK]; k++ )
+        {
+            r1 = toposort_findTreeRoot(parent, Link[sortedLinks[k]].node1);
+            if ( nodeTree[r1] < 0 )
+            {
+                nodeTree[r1] = nTrees;
+                nTrees++;
+            }
+            linkTree[k] = nodeTree[r1];
+            pos[nodeTree[r1]+1]++;
+        }
+
+        // --- find where each subtree starts in the grouped array
+        for ( i = 0; i < nTrees; i++ ) pos[i+1] += pos[i];
+        for ( i = 0; i <= nTrees; i++ ) treeStart[i] = pos[i];
+
+        // --- place each sorted link into its subtree's group
+        for ( k = 0; k < Nobjects[LINK]; k++ )
+        {
+            grouped[pos[linkTree[k]]] = sortedLinks[k];
+            pos[linkTree[k]]++;
+        }
+        for ( k = 0; k < Nobjects[LINK]; k++ ) sortedLinks[k] = grouped[k];
+    }
+    FREE(parent);
+    FREE(nodeTree);
+    FREE(linkTree);
+    FREE(pos);
+    FREE(grouped);
+    return nTrees;
+}
+
+//=============================================================================
+
+int toposort_findTreeRoot(int parent[], int i)
+//
+//  Input:   parent = union-find parent of each node
+//           i = node index
+//  Output:  returns index of the root node of the tree containing node i
+//  Purpose: finds the root of a node's tree, compressing the path to it.
+//
+{
+    int r = i;
+    int next;
+    while ( parent[r] != r ) r = parent[r];
+    while ( parent[i] != r )
+    {
+        next = parent[i];
+        parent[i] = r;
+        i = next;
+    }
+    return r;
+}
+
+//=============================================================================
+
+int getDiversionLink(int i)
+//
+//  Input:   i = node index
+//  Output:  returns index of node's diversion link or -1 if node is not
+//           a Divider
+//  Purpose: retrieves the diversion link that affects the sorted order of
+//           a Divider node's outlet links.
+//
+{
+    if ( Node[i].type != DIVIDER ) return -1;
+    return Divider[Node[i].subIndex].link;
+}
+
+//=============================================================================
+
+int isCachedLayout()
+//
+//  Input:   none
+//  Output:  returns TRUE if the current network layout matches the one
+//           whose sorted links are cached
+//  Purpose: checks if a previous sort of the network can be re-used.
+//
+{
+    int i, j;
+
+    if ( CacheNodes != Nobjects[NODE] ||
+         CacheLinks != Nobjects[LINK] ||
+         CacheModel != RouteModel ) return FALSE;
+    for ( j = 0; j < Nobjects[LINK]; j++ )
+    {
+        if ( CacheLayout[2*j]   != Link[j].node1 ||
+             CacheLayout[2*j+1] != Link[j].node2 ) return FALSE;
+    }
+    j = 2 * Nobjects[LINK];
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
+        if ( CacheLayout[j+i] != getDiversionLink(i) ) return FALSE;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void toposort_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the cached sort of the last network layout.
+//
+{
+    CacheNodes = -1;
+    FREE(CacheLayout);
+    FREE(CacheSorted);
+    FREE(CacheTreeStart);
+}
+
+//=============================================================================
+
+void saveCachedLayout(int sortedLinks[], int treeStart[], int nTrees)
+//
+//  Input:   sortedLinks = sorted link indexes grouped by subtree
+//           treeStart = position in sortedLinks where each subtree begins
+//           nTrees = number of independent subtrees
+//  Output:  none
+//  Purpose: saves the sorted links of the current network layout for
+//           re-use by later runs of the same network.
+//
+{
+    int i, j;
+
+    // --- replace any previously cached layout
+    toposort_close();
+    CacheLayout = (int *) calloc(2*Nobjects[LINK] + Nobjects[NODE] + 1,
+                                 sizeof(int));
+    CacheSorted = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    CacheTreeStart = (int *) calloc(nTrees+1, sizeof(int));
+
+    // --- a failure to cache the layout is not an error
+    //     (the network will simply be sorted again on the next run)
+    if ( CacheLayout == NULL || CacheSorted == NULL || CacheTreeStart == NULL )
+    {
+        FREE(CacheLayout);
+        FREE(CacheSorted);
+        FREE(CacheTreeStart);
+        return;
+    }
+    for ( j = 0; j < Nobjects[LINK]; j++ )
+    {
+        CacheLayout[2*j]   = Link[j].node1;
+        CacheLayout[2*j+1] = Link[j].node2;
+    }
+    j = 2 * Nobjects[LINK];
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
+        CacheLayout[j+i] = getDiversionLink(i);
+    }
+    memcpy(CacheSorted, sortedLinks, Nobjects[LINK] * sizeof(int));
+    memcpy(CacheTreeStart, treeStart, (nTrees+1) * sizeof(int));
+    CacheNodes = Nobjects[NODE];
+    CacheLinks = Nobjects[LINK];
+    CacheModel = RouteModel;
+    CacheTrees = nTrees;
+}
@@ -147,7 +147,11 @@ int  treatmnt_readExpression(char* tok[], int ntoks)
     //      variable's name into an index number) 
     equation = mathexpr_create(expr, getVariableIndex);
     if ( equation == NULL )
+    {
+        if ( mathexpr_getError() == MATHEXPR_MEMORY_ERR )
+            return error_setInpError(ERR_MEMORY, "");
         return error_setInpError(ERR_TREATMENT_EXPR, "");
+    }
 
     // --- save the treatment parameters in the node's treatment object
     Node[j].treatment[p].treatType = k;
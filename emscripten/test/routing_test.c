@@ -0,0 +1,254 @@
+//-----------------------------------------------------------------------------
+//   routing_test.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//   Date:     10/18/2026
+//
+//   Regression tests of flow routing continuity when parts of the dynamic
+//   wave computation are skipped:
+//   - it writes a project made of two independent networks (one of them
+//     slowly filling a storage unit while the other sees a storm
+//     hydrograph) and checks that freezing steady regions
+//     (SKIP_STEADY_REGIONS) keeps the flow routing continuity error as
+//     small as routing every region at every time step;
+//   - it runs an existing project with and without re-solving only the
+//     unconverged nodes of each Picard iteration (ACTIVE_SET) and checks
+//     that both give the same continuity error.
+//
+//   Build it against the engine sources (all of ../src except main.c):
+//     gcc -O1 -I../src routing_test.c $(ls ../src/*.c | grep -v /main.c) -lm
+//
+//   Usage: a.out [f1]
+//   where f1 = name of the project used for the ACTIVE_SET check (default
+//   ../../data/hague_model.inp). Returns 0 if all checks pass and 1
+//   otherwise.
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "swmm5.h"
+
+static const char* DEFAULT_PROJECT = "../../data/hague_model.inp";
+static const char* INPFILE = "routing_test.inp";
+static const char* RPTFILE = "routing_test.rpt";
+static const char* OUTFILE = "routing_test.out";
+
+static const float MAX_FLOW_ERR  = 0.5;   // max. continuity error (%)
+static const float MAX_ERR_SHIFT = 0.1;   // max. change in error (%)
+
+static int  checkSteadyRegions(void);
+static int  checkActiveSet(const char* project);
+static int  writeTwoRegionProject(const char* options);
+static int  writeProjectCopy(const char* project, const char* options);
+static int  runProject(float* flowErr);
+
+//=============================================================================
+
+int  main(int argc, char *argv[])
+//
+//  Input:   argc = number of command line arguments
+//           argv = array of command line arguments
+//  Output:  returns 0 if all checks pass, 1 if not
+//  Purpose: runs the routing regression checks.
+//
+{
+    int failures = 0;
+    const char* project = DEFAULT_PROJECT;
+
+    if ( argc > 1 ) project = argv[1];
+    failures += !checkSteadyRegions();
+    failures += !checkActiveSet(project);
+    remove(INPFILE);
+    remove(RPTFILE);
+    remove(OUTFILE);
+    printf("\n  %s\n", failures ? "FAILED" : "PASSED");
+    return failures > 0;
+}
+
+//=============================================================================
+
+int checkSteadyRegions()
+//
+//  Input:   none
+//  Output:  returns TRUE if check passes, FALSE if not
+//  Purpose: compares flow routing continuity of the two region project
+//           with and without freezing its steady regions.
+//
+{
+    float errRouted, errFrozen;
+
+    if ( !writeTwoRegionProject("SKIP_STEADY_REGIONS NO") ||
+         !runProject(&errRouted) ) return 0;
+    if ( !writeTwoRegionProject("SKIP_STEADY_REGIONS YES") ||
+         !runProject(&errFrozen) ) return 0;
+
+    printf("\n  Flow continuity error, all regions routed ... %8.3f %%",
+        errRouted);
+    printf("\n  Flow continuity error, steady regions frozen  %8.3f %%",
+        errFrozen);
+    if ( fabs(errFrozen) > MAX_FLOW_ERR ||
+         fabs(errFrozen - errRouted) > MAX_ERR_SHIFT )
+    {
+        printf("\n  ERROR: freezing steady regions loses mass");
+        return 0;
+    }
+    return 1;
+}
+
+//=============================================================================
+
+int checkActiveSet(const char* project)
+//
+//  Input:   project = name of a dynamic wave project
+//  Output:  returns TRUE if check passes, FALSE if not
+//  Purpose: compares flow routing continuity of a project with and without
+//           the ACTIVE_SET option.
+//
+{
+    float errAll, errActive;
+
+    if ( !writeProjectCopy(project, "ACTIVE_SET NO") ||
+         !runProject(&errAll) ) return 0;
+    if ( !writeProjectCopy(project, "ACTIVE_SET YES") ||
+         !runProject(&errActive) ) return 0;
+
+    printf("\n  Flow continuity error, all nodes solved ...... %8.3f %%",
+        errAll);
+    printf("\n  Flow continuity error, active set solved .... %8.3f %%",
+        errActive);
+    if ( fabs(errActive) > MAX_FLOW_ERR ||
+         fabs(errActive - errAll) > MAX_ERR_SHIFT )
+    {
+        printf("\n  ERROR: solving only the active set changes continuity");
+        return 0;
+    }
+    return 1;
+}
+
+//=============================================================================
+
+int writeTwoRegionProject(const char* options)
+//
+//  Input:   options = extra lines for the project's [OPTIONS] section
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: writes a dynamic wave project made of two independent networks.
+//
+{
+    FILE* f = fopen(INPFILE, "wt");
+
+    if ( f == NULL ) return 0;
+    fprintf(f,
+        "[OPTIONS]\n"
+        "FLOW_ROUTING  DYNWAVE\n"
+        "START_DATE    01/01/2020\n"
+        "END_DATE      01/03/2020\n"
+        "REPORT_STEP   00:15:00\n"
+        "ROUTING_STEP  0:00:10\n"
+        "%s\n"
+        "\n[JUNCTIONS]\n"
+        "A1  100  10\n"
+        "B1  100  10\n"
+        "B2   98  10\n"
+        "\n[STORAGE]\n"
+        "SA   90  20  0  FUNCTIONAL  20000  0  0\n"
+        "\n[OUTFALLS]\n"
+        "AO   80  FREE\n"
+        "BO   94  FREE\n"
+        "\n[CONDUITS]\n"
+        "CA1  A1  SA  400  0.015  0  0  0\n"
+        "CB1  B1  B2  400  0.015  0  0  0\n"
+        "CB2  B2  BO  400  0.015  0  0  0\n"
+        "\n[WEIRS]\n"
+        "WA   SA  AO  TRANSVERSE  2  3.33  NO  0  0\n"
+        "\n[XSECTIONS]\n"
+        "CA1  CIRCULAR   2  0  0  0  1\n"
+        "CB1  CIRCULAR   2  0  0  0  1\n"
+        "CB2  CIRCULAR   2  0  0  0  1\n"
+        "WA   RECT_OPEN  5  4  0  0\n"
+        "\n[INFLOWS]\n"
+        "A1  FLOW  TSA\n"
+        "B1  FLOW  TSB\n"
+        "\n[TIMESERIES]\n"
+        "TSA   0  3.0\n"
+        "TSA  48  3.0\n"
+        "TSB   0  0.5\n"
+        "TSB  12  0.5\n"
+        "TSB  13  4.0\n"
+        "TSB  16  1.5\n"
+        "TSB  20  0.5\n"
+        "TSB  48  0.5\n",
+        options);
+    fclose(f);
+    return 1;
+}
+
+//=============================================================================
+
+int writeProjectCopy(const char* project, const char* options)
+//
+//  Input:   project = name of an existing project file
+//           options = extra lines for the project's [OPTIONS] section
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: writes a copy of a project with extra analysis options.
+//
+{
+    char  line[1024];
+    FILE* f1 = fopen(project, "rt");
+    FILE* f2;
+
+    if ( f1 == NULL )
+    {
+        printf("\n  ERROR: cannot open %s", project);
+        return 0;
+    }
+    f2 = fopen(INPFILE, "wt");
+    if ( f2 == NULL )
+    {
+        fclose(f1);
+        return 0;
+    }
+    while ( fgets(line, sizeof(line), f1) )
+    {
+        fputs(line, f2);
+        if ( strncmp(line, "[OPTIONS]", 9) == 0 ) fprintf(f2, "%s\n", options);
+    }
+    fclose(f1);
+    fclose(f2);
+    return 1;
+}
+
+//=============================================================================
+
+int runProject(float* flowErr)
+//
+//  Input:   none
+//  Output:  flowErr = flow routing continuity error (%);
+//           returns TRUE if successful, FALSE if not
+//  Purpose: runs the test project and retrieves its continuity error.
+//
+{
+    int    err;
+    float  runoffErr, qualErr;
+    double elapsedTime = 0.0;
+
+    err = swmm_open((char *)INPFILE, (char *)RPTFILE, (char *)OUTFILE);
+    if ( !err ) err = swmm_start(0);
+    while ( !err )
+    {
+        err = swmm_step(&elapsedTime);
+        if ( elapsedTime == 0.0 ) break;
+    }
+    if ( !err ) err = swmm_end();
+    if ( !err ) err = swmm_getMassBalErr(&runoffErr, flowErr, &qualErr);
+    swmm_close();
+    if ( err )
+    {
+        printf("\n  ERROR %d running %s (see %s)", err, INPFILE, RPTFILE);
+        return 0;
+    }
+    return 1;
+}